@@ -22,7 +22,8 @@ public class GrimoirePlugin : ModuleRules
             "GameplayAbilities",
             "EnhancedInput",
             "Niagara",
-            "StructUtils"
+            "StructUtils",
+            "DeveloperSettings"
         });
 
         PrivateDependencyModuleNames.AddRange(new string[]
@@ -2,15 +2,23 @@
 #include "Model/HeartGraph.h"
 #include "Spells/SpellNode.h"
 #include "Spells/MagicNode.h"
+#include "Spells/SpellInterpreter.h"
+#include "Spells/SpellMetrics.h"
+#include "Spells/SpellOptimizer.h"
+#include "Spells/SpellCostAnalyzer.h"
+#include "GrimoireSettings.h"
+#include "Spells/SpellExecutionContext.h"
+#include "Subsystems/GrimoireContextSubsystem.h"
 #include "Net/UnrealNetwork.h"
 #include "AbilitySystemComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "GameFramework/PlayerController.h"
-#include "TimerManager.h"
+#include "GameFramework/GameStateBase.h"
 
 UGrimoireComponent::UGrimoireComponent()
 {
-    PrimaryComponentTick.bCanEverTick = true;
+    // Mana and cooldowns are evaluated from timestamps on read, so nothing needs a tick
+    PrimaryComponentTick.bCanEverTick = false;
     CurrentMana = 100.0f;
     MaxMana = 100.0f;
 	ManaRegenRate = 5.0f;  
@@ -29,11 +37,19 @@ void UGrimoireComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& O
     DOREPLIFETIME(UGrimoireComponent, AvailableNodeClasses);
     DOREPLIFETIME(UGrimoireComponent, ActiveSpells);
     DOREPLIFETIME(UGrimoireComponent, CurrentMana);
+    DOREPLIFETIME(UGrimoireComponent, ManaTimestamp);
 }
 
 void UGrimoireComponent::BeginPlay()
 {
     Super::BeginPlay();
+
+    // Clients take the anchor from the server
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        ManaTimestamp = GetManaTime();
+    }
+
     AActor* Owner = GetOwner();
     if (!Owner)
     {
@@ -74,37 +90,92 @@ void UGrimoireComponent::BeginPlay()
     UE_LOG(LogTemp, Log, TEXT("GrimoireComponent initialized for %s"), *Owner->GetName());
 }
 
-void UGrimoireComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+double UGrimoireComponent::GetWorldTime() const
+{
+    const UWorld* World = GetWorld();
+    return World ? World->GetTimeSeconds() : 0.0;
+}
+
+double UGrimoireComponent::GetManaTime() const
+{
+    const UWorld* World = GetWorld();
+    const AGameStateBase* GameState = World ? World->GetGameState() : nullptr;
+    return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorldTime();
+}
+
+float UGrimoireComponent::GetCurrentMana() const
 {
-    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-    // Regenerate mana
-    if (CurrentMana < MaxMana)
+    if (CurrentMana >= MaxMana)
     {
-        CurrentMana = FMath::Min(MaxMana, CurrentMana + ManaRegenRate * DeltaTime);
+        return CurrentMana;
     }
 
-    // Update spell cooldowns
-    TArray<FName> CooledDownSpells;
-    for (auto& CooldownPair : SpellCooldowns)
+    const double Elapsed = FMath::Max(0.0, GetManaTime() - ManaTimestamp);
+    return FMath::Min(MaxMana, CurrentMana + ManaRegenRate * static_cast<float>(Elapsed));
+}
+
+void UGrimoireComponent::SetCurrentMana(float NewMana)
+{
+    CurrentMana = NewMana;
+    ManaTimestamp = GetManaTime();
+}
+
+bool UGrimoireComponent::IsSpellOnCooldown(FName SpellName) const
+{
+    const FSpellCooldown* Cooldown = SpellCooldowns.Find(SpellName);
+    return Cooldown && Cooldown->ExpiresAt > GetWorldTime();
+}
+
+float UGrimoireComponent::GetSpellCooldownRemaining(FName SpellName) const
+{
+    const FSpellCooldown* Cooldown = SpellCooldowns.Find(SpellName);
+    return Cooldown ? static_cast<float>(FMath::Max(0.0, Cooldown->ExpiresAt - GetWorldTime())) : 0.0f;
+}
+
+void UGrimoireComponent::StartCooldown(FName SpellName, float Duration)
+{
+    ClearCooldown(SpellName);
+
+    // Local world time, unlike mana: cooldowns are not replicated, and the scheduler that expires them runs on this clock
+    FSpellCooldown& Cooldown = SpellCooldowns.Add(SpellName);
+    Cooldown.ExpiresAt = GetWorldTime() + Duration;
+
+    // The entry is only cleanup and notification; IsSpellOnCooldown reads the timestamp
+    UWorld* World = GetWorld();
+    if (UGrimoireSchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UGrimoireSchedulerSubsystem>() : nullptr)
     {
-        CooldownPair.Value -= DeltaTime;
-        if (CooldownPair.Value <= 0.0f)
-        {
-            CooledDownSpells.Add(CooldownPair.Key);
-        }
+        Cooldown.ExpiryHandle = Scheduler->Schedule(Duration, FSimpleDelegate::CreateUObject(this, &UGrimoireComponent::HandleCooldownExpired, SpellName));
+    }
+}
+
+void UGrimoireComponent::ClearCooldown(FName SpellName)
+{
+    FSpellCooldown Cooldown;
+    if (!SpellCooldowns.RemoveAndCopyValue(SpellName, Cooldown))
+    {
+        return;
     }
 
-    // Remove expired cooldowns
-    for (const FName& SpellName : CooledDownSpells)
+    UWorld* World = GetWorld();
+    if (UGrimoireSchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UGrimoireSchedulerSubsystem>() : nullptr)
     {
-        SpellCooldowns.Remove(SpellName);
+        Scheduler->Cancel(Cooldown.ExpiryHandle);
     }
 }
 
+void UGrimoireComponent::HandleCooldownExpired(FName SpellName)
+{
+    SpellCooldowns.Remove(SpellName);
+    OnSpellCooldownExpired.Broadcast(SpellName);
+}
+
 void UGrimoireComponent::OnRep_CurrentMana()
 {
-    OnManaChanged.Broadcast(CurrentMana);
-    UE_LOG(LogTemp, Log, TEXT("Mana replicated: %f"), CurrentMana);
+    // CurrentMana and ManaTimestamp arrive together; regen continues locally from the server's anchor,
+    // so listeners get the regenerated value rather than the stored one
+    const float Mana = GetCurrentMana();
+    OnManaChanged.Broadcast(Mana);
+    UE_LOG(LogTemp, Log, TEXT("Mana replicated: %f"), Mana);
 }
 
 void UGrimoireComponent::AddSpellNode(TSubclassOf<USpellNode> SpellNodeClass)
@@ -174,11 +245,16 @@ void UGrimoireComponent::AddSpellGraph(FName GraphName)
     USpellNode* Magic = NewObject<UMagicNode>(NewGraph);
     NewGraph->AddNode(Magic);
     NewGraph->SetRootNode(Magic); 
+    FSpellGraphIndex::Invalidate(NewGraph);
 }
 
 void UGrimoireComponent::RemoveSpellGraph(FName GraphName)
 {
-    ActiveSpellGraphs.Remove(GraphName);
+    UHeartGraph* Graph = nullptr;
+    if (ActiveSpellGraphs.RemoveAndCopyValue(GraphName, Graph))
+    {
+        FSpellMetrics::Invalidate(Graph);
+    }
 }
 
 void UGrimoireComponent::CreateSpell(FName SpellName)
@@ -223,7 +299,7 @@ void UGrimoireComponent::RemoveSpell(FName SpellName)
     if (ActiveSpells.Contains(SpellName))
     {
         ActiveSpells.Remove(SpellName);
-        SpellCooldowns.Remove(SpellName);
+        ClearCooldown(SpellName);
         UE_LOG(LogTemp, Log, TEXT("Removed spell: %s"), *SpellName.ToString());
     }
 }
@@ -244,7 +320,7 @@ void UGrimoireComponent::ExecuteSpell(FName SpellName, AActor* Target, FVector T
         {
             // Predict mana consumption
             float ManaCost = CalculateSpellManaCost(SpellName);
-            CurrentMana = FMath::Max(0.0f, CurrentMana - ManaCost);
+            ConsumeMana(ManaCost);
         }
         
         Server_ExecuteSpell(SpellName, Target, TargetLocation);
@@ -262,18 +338,26 @@ bool UGrimoireComponent::ExecuteSpellInternal(FName SpellName, AActor* Target, c
     }
 
     // Check cooldown
-    if (SpellCooldowns.Contains(SpellName))
+    if (IsSpellOnCooldown(SpellName))
     {
         UE_LOG(LogTemp, Warning, TEXT("Spell %s is on cooldown"), *SpellName.ToString());
         return false;
     }
 
+    // Spells rejected by the cost analyzer compile to nothing and cost nothing
+    const TSharedPtr<const FCompiledSpell> CompiledSpell = GetCompiledSpell(ActiveSpells[SpellName]);
+    if (!CompiledSpell || CompiledSpell->IsEmpty())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Spell %s has nothing to run"), *SpellName.ToString());
+        return false;
+    }
+
     // Calculate mana cost and check if we can cast
     float ManaCost = CalculateSpellManaCost(SpellName);
     if (!CanCastSpell(SpellName))
     {
         UE_LOG(LogTemp, Warning, TEXT("Cannot cast spell %s - insufficient mana (%.2f/%.2f)"), 
-            *SpellName.ToString(), CurrentMana, ManaCost);
+            *SpellName.ToString(), GetCurrentMana(), ManaCost);
         return false;
     }
 
@@ -285,24 +369,30 @@ bool UGrimoireComponent::ExecuteSpellInternal(FName SpellName, AActor* Target, c
         return false;
     }
 
+    // Mana is taken up front so a cast that is still running cannot be paid for twice; SettleCast refunds it if the cast runs dry
+    Context->SpellName = SpellName;
+    Context->ManaCost = ManaCost;
+    BeginMetering(Context, *CompiledSpell, ManaCost);
+    ConsumeMana(ManaCost);
+
     // Execute the spell
     ExecuteSpellInternal(SpellName, Context);
 
-    // Consume mana
-    ConsumeMana(Context->ManaCost);
-
     // Set cooldown
     const FSpellDefinition& SpellDef = ActiveSpells[SpellName];
     if (SpellDef.Cooldown > 0.0f)
     {
-        SpellCooldowns.Add(SpellName, SpellDef.Cooldown);
+        StartCooldown(SpellName, SpellDef.Cooldown);
     }
 
     // Broadcast success
     OnSpellCast.Broadcast(SpellName, true);
 
     UE_LOG(LogTemp, Log, TEXT("Successfully executed spell %s (Cost: %.2f, Remaining Mana: %.2f)"), 
-        *SpellName.ToString(), Context->ManaCost, CurrentMana);
+        *SpellName.ToString(), Context->ManaCost, GetCurrentMana());
+
+    // Pending delays hold their own reference, so this returns the context to the pool unless the spell is still running
+    Context->ReleaseCast();
 
     return true;
 }
@@ -321,21 +411,122 @@ void UGrimoireComponent::ExecuteSpellInternal(FName SpellName, USpellExecutionCo
         return;
     }
 
-    // Find the root node (entry point) for execution
-    USpellNode* RootNode = FindRootNode(SpellDef->SpellGraph);
-    if (!RootNode)
+    const TSharedPtr<const FCompiledSpell> CompiledSpell = GetCompiledSpell(*SpellDef);
+    if (!CompiledSpell || CompiledSpell->IsEmpty())
     {
         UE_LOG(LogTemp, Warning, TEXT("No root node found for spell %s"), *SpellName.ToString());
         return;
     }
 
-    // Execute the spell starting from root node
-    RootNode->Execute(Context);
+    // Casting starts every OnCast root, and timer triggers begin counting on a new chain that replaces the last cast's
+    ++TimerChains.FindOrAdd(SpellName);
+    FSpellInterpreter::ExecuteEntryPoints(CompiledSpell.ToSharedRef(), Context, ETriggerEventType::OnCast);
+    FSpellInterpreter::ExecuteEntryPoints(CompiledSpell.ToSharedRef(), Context, ETriggerEventType::OnTimer);
+}
+
+void UGrimoireComponent::TriggerSpellEvent(FName SpellName, ETriggerEventType Event, AActor* Target)
+{
+    FSpellDefinition* SpellDef = ActiveSpells.Find(SpellName);
+    if (!SpellDef || !SpellDef->SpellGraph)
+    {
+        return;
+    }
+
+    const TSharedPtr<const FCompiledSpell> CompiledSpell = GetCompiledSpell(*SpellDef);
+    if (!CompiledSpell || CompiledSpell->GetEntryPoints(Event).Num() == 0)
+    {
+        return;
+    }
+
+    USpellExecutionContext* Context = CreateExecutionContext(Target, FVector::ZeroVector);
+    if (!Context)
+    {
+        return;
+    }
+
+    Context->SpellName = SpellName;
+    BeginMetering(Context, *CompiledSpell, 0.0f);
+    FSpellInterpreter::ExecuteEntryPoints(CompiledSpell.ToSharedRef(), Context, Event);
+    Context->ReleaseCast();
+}
+
+TSharedPtr<const FCompiledSpell> UGrimoireComponent::GetCompiledSpell(FSpellDefinition& SpellDef) const
+{
+    // Recompile after the graph has been edited
+    if (!SpellDef.CompiledSpell || SpellDef.CompiledSpell->IsStale())
+    {
+        // Entry points come from the graph index, which is rebuilt only when the graph changes
+        const TSharedPtr<FCompiledSpell> Program = FSpellCompiler::Compile(SpellDef.SpellGraph);
+
+        // Casts start on a fresh context, which is what the optimizer assumes
+        if (Program.IsValid())
+        {
+            FSpellOptimizer::Optimize(*Program);
+
+            // Spells that could blow a frame are replaced by an empty program, which stays cached until the graph is edited
+            FString Reason;
+            if (!FSpellCostAnalyzer::IsWithinBudget(FSpellCostAnalyzer::Analyze(*Program), Reason))
+            {
+                UE_LOG(LogTemp, Error, TEXT("Spell %s exceeds its cost budget: %s"), *SpellDef.SpellName.ToString(), *Reason);
+
+                const TSharedPtr<const FSpellGraphIndex> SourceIndex = Program->SourceIndex;
+                *Program = FCompiledSpell();
+                Program->SourceIndex = SourceIndex;
+            }
+        }
+        SpellDef.CompiledSpell = Program;
+    }
+
+    return SpellDef.CompiledSpell;
+}
+
+void UGrimoireComponent::BeginMetering(USpellExecutionContext* Context, const FCompiledSpell& Spell, float ManaCost)
+{
+    Context->SetFuelBudget(GetDefault<UGrimoireSettings>()->GetFuelBudget(Spell.Rarity, GetOwner()));
+
+    // Yielded and suspended runs keep burning the same budget, so the cast is only settled once all of them are done
+    const FName SpellName = Context->SpellName;
+    Context->SetOnCastFinished([WeakThis = TWeakObjectPtr<UGrimoireComponent>(this), SpellName, ManaCost](const FSpellCast& Cast)
+    {
+        if (UGrimoireComponent* Grimoire = WeakThis.Get())
+        {
+            Grimoire->SettleCast(SpellName, ManaCost, Cast);
+        }
+    });
+}
+
+void UGrimoireComponent::SettleCast(FName SpellName, float ManaCost, const FSpellCast& Cast)
+{
+    FSpellFuelStats& Stats = FuelStats.FindOrAdd(SpellName);
+    ++Stats.Casts;
+    Stats.TotalFuel += Cast.FuelUsed;
+    Stats.PeakFuel = FMath::Max(Stats.PeakFuel, Cast.FuelUsed);
+    Stats.OutOfFuelCasts += Cast.IsOutOfFuel() ? 1 : 0;
+
+    if (ManaCost > 0.0f && Cast.IsOutOfFuel() && GetDefault<UGrimoireSettings>()->OutOfFuelPolicy == EGrimoireFuelPolicy::RefundMana)
+    {
+        SetCurrentMana(FMath::Min(MaxMana, GetCurrentMana() + ManaCost));
+        UE_LOG(LogTemp, Log, TEXT("Spell %s ran out of fuel, refunded %.2f mana"), *SpellName.ToString(), ManaCost);
+    }
+}
+
+FSpellFuelStats UGrimoireComponent::GetSpellFuelStats(FName SpellName) const
+{
+    const FSpellFuelStats* Stats = FuelStats.Find(SpellName);
+    return Stats ? *Stats : FSpellFuelStats();
+}
+
+int32 UGrimoireComponent::GetTimerChain(FName SpellName) const
+{
+    const int32* Chain = TimerChains.Find(SpellName);
+    return Chain ? *Chain : 0;
 }
 
 USpellExecutionContext* UGrimoireComponent::CreateExecutionContext(AActor* Target, const FVector& TargetLocation)
 {
-    USpellExecutionContext* Context = NewObject<USpellExecutionContext>(this);
+    UWorld* World = GetWorld();
+    UGrimoireContextSubsystem* ContextPool = World ? World->GetSubsystem<UGrimoireContextSubsystem>() : nullptr;
+    USpellExecutionContext* Context = ContextPool ? ContextPool->BeginCast() : NewObject<USpellExecutionContext>(this);
     if (!Context)
     {
         return nullptr;
@@ -378,7 +569,7 @@ void UGrimoireComponent::Client_NotifySpellResult_Implementation(FName SpellName
     else
     {
         // Prediction was wrong, restore mana
-        CurrentMana = FMath::Min(MaxMana, CurrentMana + ManaCost);
+        SetCurrentMana(FMath::Min(MaxMana, GetCurrentMana() + ManaCost));
         UE_LOG(LogTemp, Log, TEXT("Spell %s cast failed, mana restored"), *SpellName.ToString());
     }
     
@@ -398,7 +589,7 @@ void UGrimoireComponent::Client_PredictExecute(FName SpellName)
             {
                 Root->Execute(this, GetOwner());
             }
-            CurrentMana -= SpellCost;  // Predict
+            ConsumeMana(SpellCost);  // Predict
         }
     }
 }
@@ -416,21 +607,19 @@ float UGrimoireComponent::CalculateSpellManaCost(UHeartGraph* Graph) const
         return 0.0f;
     }
 
-    float TotalCost = 0.0f;
-    
-    // Get all nodes in the spell graph
-    TArray<UHeartGraphNode*> AllNodes;
-    SpellDef->SpellGraph->GetAllNodes(AllNodes);
-    
-    for (UHeartGraphNode* Node : AllNodes)
+    // Kept current as nodes are edited, no graph walk
+    return FSpellMetrics::Get(SpellDef->SpellGraph).GetManaCost();
+}
+
+float UGrimoireComponent::CalculateSpellPower(FName SpellName) const
+{
+    const FSpellDefinition* SpellDef = ActiveSpells.Find(SpellName);
+    if (!SpellDef || !SpellDef->SpellGraph)
     {
-        if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-        {
-            TotalCost += SpellNode->NodeManaCost * SpellNode->GetRarityScaleFactor();
-        }
+        return 0.0f;
     }
 
-    return TotalCost;
+    return FSpellMetrics::Get(SpellDef->SpellGraph).GetSpellPower();
 }
 
 bool UGrimoireComponent::CanCastSpell(float SpellManaCost) const
@@ -442,19 +631,19 @@ bool UGrimoireComponent::CanCastSpell(float SpellManaCost) const
     }
 
     // Check cooldown
-    if (SpellCooldowns.Contains(SpellName))
+    if (IsSpellOnCooldown(SpellName))
     {
         return false;
     }
 
     // Check mana
     float ManaCost = CalculateSpellManaCost(SpellName);
-    return CurrentMana >= ManaCost;
+    return GetCurrentMana() >= ManaCost;
 }
 
 void UGrimoireComponent::ConsumeMana(float Amount)
 {
-    CurrentMana = FMath::Max(0.0f, CurrentMana - Amount);
+    SetCurrentMana(FMath::Max(0.0f, GetCurrentMana() - Amount));
     UE_LOG(LogTemp, Log, TEXT("Consumed %.2f mana, remaining: %.2f"), Amount, CurrentMana);
 }
 
@@ -486,41 +675,6 @@ void UGrimoireComponent::CompileAndGrantSpellAbility(FName SpellName, int32 Inpu
         }
     }
 }
-USpellNode* UGrimoireComponent::FindRootNode(UHeartGraph* Graph) const
-{
-    if (!Graph)
-    {
-        return nullptr;
-    }
-
-    TArray<UHeartGraphNode*> AllNodes;
-    Graph->GetAllNodes(AllNodes);
-
-    // Look for a node with no incoming execution connections
-    for (UHeartGraphNode* Node : AllNodes)
-    {
-        if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-        {
-            // Check if this node has incoming execution connections
-            TArray<FHeartGraphPinReference> IncomingConnections = Graph->GetConnectedPins(SpellNode->GetNodeGuid(), TEXT("Execute"));
-            
-            if (IncomingConnections.Num() == 0)
-            {
-                // This node has no incoming execution, so it's a root
-                return SpellNode;
-            }
-        }
-    }
-
-    // If no clear root found, return the first node
-    if (AllNodes.Num() > 0)
-    {
-        return Cast<USpellNode>(AllNodes[0]);
-    }
-
-    return nullptr;
-}
-
 void UGrimoireComponent::DebugPrintSpellInfo(FName SpellName) const
 {
     const FSpellDefinition* SpellDef = ActiveSpells.Find(SpellName);
@@ -532,13 +686,13 @@ void UGrimoireComponent::DebugPrintSpellInfo(FName SpellName) const
 
     float ManaCost = CalculateSpellManaCost(SpellName);
     bool bCanCast = CanCastSpell(SpellName);
-    bool bOnCooldown = SpellCooldowns.Contains(SpellName);
+    bool bOnCooldown = IsSpellOnCooldown(SpellName);
 
     UE_LOG(LogTemp, Log, TEXT("=== Spell Info: %s ==="), *SpellName.ToString());
     UE_LOG(LogTemp, Log, TEXT("Mana Cost: %.2f"), ManaCost);
     UE_LOG(LogTemp, Log, TEXT("Can Cast: %s"), bCanCast ? TEXT("Yes") : TEXT("No"));
     UE_LOG(LogTemp, Log, TEXT("On Cooldown: %s"), bOnCooldown ? TEXT("Yes") : TEXT("No"));
-    UE_LOG(LogTemp, Log, TEXT("Current Mana: %.2f/%.2f"), CurrentMana, MaxMana);
+    UE_LOG(LogTemp, Log, TEXT("Current Mana: %.2f/%.2f"), GetCurrentMana(), MaxMana);
 
     if (SpellDef->SpellGraph)
     {
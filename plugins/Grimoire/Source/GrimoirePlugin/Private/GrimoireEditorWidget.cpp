@@ -1,6 +1,8 @@
 #include "GrimoireEditorWidget.h"
 #include "Model/HeartGraph.h"
 #include "SpellNode.h"
+#include "Spells/SpellGraphIndex.h"
+#include "Spells/SpellMetrics.h"
 #include "Components/PanelWidget.h"
 
 void UGrimoireEditorWidget::NativeConstruct()
@@ -19,12 +21,24 @@ void UGrimoireEditorWidget::AddNode(TSubclassOf<USpellNode> NodeClass)
     {
         USpellNode* NewNode = NewObject<USpellNode>(SpellGraph, NodeClass);
         SpellGraph->AddNode(NewNode);
+        FSpellGraphIndex::Invalidate(SpellGraph);
+        FSpellMetrics::AddNode(SpellGraph, NewNode);
         
         // Set default position
         NewNode->Position = FVector2D(100, 100);
     }
 }
 
+void UGrimoireEditorWidget::RemoveNode(USpellNode* Node)
+{
+    if (SpellGraph && Node && Node->GetTypedOuter<UHeartGraph>() == SpellGraph)
+    {
+        FSpellMetrics::RemoveNode(SpellGraph, Node);
+        SpellGraph->RemoveNode(Node->GetGuid());
+        FSpellGraphIndex::Invalidate(SpellGraph);
+    }
+}
+
 void UGrimoireEditorWidget::ConnectNodes(USpellNode* Source, USpellNode* Target)
 {
     if (SpellGraph && Source && Target)
@@ -33,5 +47,6 @@ void UGrimoireEditorWidget::ConnectNodes(USpellNode* Source, USpellNode* Target)
         // This is a placeholder for the actual HeartGraph connection logic
         UE_LOG(LogTemp, Warning, TEXT("Connecting nodes: %s to %s"), 
             *Source->GetName(), *Target->GetName());
+        FSpellGraphIndex::Invalidate(SpellGraph);
     }
 }
\ No newline at end of file
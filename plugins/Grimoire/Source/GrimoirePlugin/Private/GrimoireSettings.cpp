@@ -0,0 +1,71 @@
+#include "GrimoireSettings.h"
+#include "Spells/SpellNode.h"
+
+UGrimoireSettings::UGrimoireSettings()
+{
+    CategoryName = TEXT("Plugins");
+
+    // Each tier roughly doubles, tracking the rarity iteration caps of Flow loops
+    CostBudgets.Add(EItemRarity::Common, FSpellCostBudget(256, 8, 32));
+    CostBudgets.Add(EItemRarity::Uncommon, FSpellCostBudget(512, 16, 64));
+    CostBudgets.Add(EItemRarity::Rare, FSpellCostBudget(1024, 32, 128));
+    CostBudgets.Add(EItemRarity::Epic, FSpellCostBudget(2048, 64, 256));
+    CostBudgets.Add(EItemRarity::Legendary, FSpellCostBudget(4096, 128, 512));
+
+    FuelBudgets.Add(EItemRarity::Common, 1024);
+    FuelBudgets.Add(EItemRarity::Uncommon, 2048);
+    FuelBudgets.Add(EItemRarity::Rare, 4096);
+    FuelBudgets.Add(EItemRarity::Epic, 8192);
+    FuelBudgets.Add(EItemRarity::Legendary, 16384);
+
+    // Nodes that reach into the world cost more than bookkeeping nodes
+    for (int32& Cost : NodeFuelCosts)
+    {
+        Cost = 1;
+    }
+    NodeFuelCosts[static_cast<uint8>(ESpellNodeType::Magic)] = 4;
+    NodeFuelCosts[static_cast<uint8>(ESpellNodeType::Effect)] = 4;
+
+    StatusDamagePerSecond.Add(EStatusEffectType::Burning, 5.0f);
+    StatusDamagePerSecond.Add(EStatusEffectType::Poisoned, 3.0f);
+
+    // ElementalCollisionEffect and ElementInteractionTable are left for the project to set; unset means no effect and no interactions
+}
+
+const FSpellCostBudget& UGrimoireSettings::GetCostBudget(EItemRarity Rarity) const
+{
+    // Tiers removed from config fall back to the defaults
+    static const FSpellCostBudget DefaultBudget;
+    const FSpellCostBudget* Budget = CostBudgets.Find(Rarity);
+    return Budget ? *Budget : DefaultBudget;
+}
+
+int32 UGrimoireSettings::GetFuelBudget(EItemRarity Rarity, AActor* Caster) const
+{
+    const int32* Budget = FuelBudgets.Find(Rarity);
+    if (!Budget || *Budget <= 0)
+    {
+        return 0;
+    }
+
+    for (UClass* Class = Caster ? Caster->GetClass() : nullptr; Class; Class = Class->GetSuperClass())
+    {
+        if (const float* Multiplier = CasterFuelMultipliers.Find(TSoftClassPtr<AActor>(Class)))
+        {
+            return FMath::Max(FMath::RoundToInt(*Budget * *Multiplier), 1);
+        }
+    }
+    return *Budget;
+}
+
+int32 UGrimoireSettings::GetFuelCost(const USpellNode* Node) const
+{
+    // Classes from other packages, including Blueprint subclasses, are not trusted to be cheap
+    if (Node->GetClass()->GetOutermost() != USpellNode::StaticClass()->GetOutermost())
+    {
+        return ExternalNodeFuelCost;
+    }
+
+    const uint8 Type = static_cast<uint8>(Node->NodeType);
+    return Type < static_cast<uint8>(ESpellNodeType::MAX) ? NodeFuelCosts[Type] : ExternalNodeFuelCost;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Shared by the interpreter and the world subsystems that run spells
+DECLARE_STATS_GROUP(TEXT("Grimoire"), STATGROUP_Grimoire, STATCAT_Advanced);
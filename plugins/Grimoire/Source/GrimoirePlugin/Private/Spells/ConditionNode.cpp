@@ -1,9 +1,9 @@
 #include "Spells/ConditionNode.h"
 #include "SpellExecutionContext.h"
 #include "Components/GrimoireComponent.h"
+#include "Subsystems/GrimoireStatusSubsystem.h"
 #include "Engine/World.h"
 #include "GameFramework/Character.h"
-#include "Model/HeartGraph.h"
 #include "Math/UnrealMathUtility.h"
 
 UConditionNode::UConditionNode()
@@ -64,15 +64,35 @@ void UConditionNode::OnExecute(USpellExecutionContext* Context)
         *NodeName, 
         *UEnum::GetValueAsString(ConditionType));
     
-    // Cache connected nodes for efficiency
-    CacheConnectedNodes();
+    bool bConditionResult = EvaluateBranch(Context);
     
+    if (RunsBothBranches(bConditionResult))
+    {
+        // Create alternative context for false branch
+        USpellExecutionContext* AltContext = Context->CreateChildContext();
+        AltContext->ModifySpellPower(0.5f); // Reduced power for quantum branch
+        ExecuteFalseBranch(AltContext);
+    }
+    
+    // Execute appropriate branch
+    if (bConditionResult)
+    {
+        ExecuteTrueBranch(Context);
+    }
+    else if (ConditionType == EConditionType::IfThenElse)
+    {
+        ExecuteFalseBranch(Context);
+    }
+}
+
+bool UConditionNode::EvaluateBranch(USpellExecutionContext* Context)
+{
     // Evaluate the condition
     bool bConditionResult = EvaluateCondition(Context);
     
     // Store result in context
-    Context->SetVariable(TEXT("ConditionResult"), FGWTVariableValue::FromBool(bConditionResult));
-    Context->SetVariable(TEXT("LastConditionNode"), FGWTVariableValue::FromString(NodeName));
+    Context->SetRegister(ESpellRegister::ConditionResult, FSpellValue::FromBool(bConditionResult));
+    Context->SetRegister(ESpellRegister::LastConditionNode, FSpellValue::FromString(NodeName));
     
     UE_LOG(LogTemp, Log, TEXT("Condition %s evaluated to: %s"), 
         *NodeName, bConditionResult ? TEXT("TRUE") : TEXT("FALSE"));
@@ -80,15 +100,7 @@ void UConditionNode::OnExecute(USpellExecutionContext* Context)
     // Apply rarity effects before branching
     ApplyRarityEffects(Context, bConditionResult);
     
-    // Execute appropriate branch
-    if (bConditionResult)
-    {
-        ExecuteTrueBranch(Context);
-    }
-    else if (ConditionType == EConditionType::IfThenElse)
-    {
-        ExecuteFalseBranch(Context);
-    }
+    return bConditionResult;
 }
 
 bool UConditionNode::EvaluateCondition(USpellExecutionContext* Context)
@@ -125,27 +137,24 @@ bool UConditionNode::EvaluateCondition(USpellExecutionContext* Context)
 bool UConditionNode::EvaluateIfThen(USpellExecutionContext* Context)
 {
     // Check for boolean input from connected nodes
-    if (Context->HasVariable(TEXT("BoolCondition")))
+    const FSpellValue& BoolVar = Context->GetRegister(ESpellRegister::BoolCondition);
+    if (BoolVar.GetType() == EGWTVariableType::Bool)
     {
-        FGWTVariableValue BoolVar = Context->GetVariable(TEXT("BoolCondition"));
-        if (BoolVar.Type == EGWTVariableType::Bool)
-        {
-            return BoolVar.BoolValue;
-        }
+        return BoolVar.GetBool();
     }
     
     // Check for named variable
-    if (Context->HasVariable(VariableName))
+    const FSpellValue& Var = Context->GetRegister(VariableSlot);
+    if (Var.IsSet())
     {
-        FGWTVariableValue Var = Context->GetVariable(VariableName);
-        switch (Var.Type)
+        switch (Var.GetType())
         {
             case EGWTVariableType::Bool:
-                return Var.BoolValue;
+                return Var.GetBool();
             case EGWTVariableType::Float:
-                return Var.FloatValue > 0.0f;
+                return Var.GetFloat() > 0.0f;
             case EGWTVariableType::Int:
-                return Var.IntValue > 0;
+                return Var.GetInt() > 0;
             default:
                 return false;
         }
@@ -157,21 +166,18 @@ bool UConditionNode::EvaluateIfThen(USpellExecutionContext* Context)
 
 bool UConditionNode::EvaluateComparison(USpellExecutionContext* Context)
 {
-    float ValueA = GetVariableValue(Context, TEXT("ConditionValue"));
+    float ValueA = GetVariableValue(Context, static_cast<int32>(ESpellRegister::ConditionValue));
     float ValueB = ComparisonValue;
     
     // Check for comparison value override
-    if (Context->HasVariable(TEXT("CompareValue")))
+    const FSpellValue& CompareVar = Context->GetRegister(ESpellRegister::CompareValue);
+    if (CompareVar.GetType() == EGWTVariableType::Float)
     {
-        FGWTVariableValue CompareVar = Context->GetVariable(TEXT("CompareValue"));
-        if (CompareVar.Type == EGWTVariableType::Float)
-        {
-            ValueB = CompareVar.FloatValue;
-        }
-        else if (CompareVar.Type == EGWTVariableType::Int)
-        {
-            ValueB = static_cast<float>(CompareVar.IntValue);
-        }
+        ValueB = CompareVar.GetFloat();
+    }
+    else if (CompareVar.GetType() == EGWTVariableType::Int)
+    {
+        ValueB = static_cast<float>(CompareVar.GetInt());
     }
     
     return CompareValues(ValueA, ValueB, ComparisonOperator);
@@ -211,6 +217,16 @@ bool UConditionNode::EvaluateDistanceCheck(USpellExecutionContext* Context)
 bool UConditionNode::EvaluateRandomChance(USpellExecutionContext* Context)
 {
     float RandomValue = FMath::RandRange(0.0f, 1.0f);
+    const float AdjustedChance = GetAdjustedChance();
+    
+    Context->SetVariable(TEXT("RandomValue"), FGWTVariableValue::FromFloat(RandomValue));
+    Context->SetVariable(TEXT("ChanceThreshold"), FGWTVariableValue::FromFloat(AdjustedChance));
+    
+    return RandomValue <= AdjustedChance;
+}
+
+float UConditionNode::GetAdjustedChance() const
+{
     float AdjustedChance = RandomChance;
     
     // Rarity affects random chance
@@ -232,12 +248,7 @@ bool UConditionNode::EvaluateRandomChance(USpellExecutionContext* Context)
             break;
     }
     
-    AdjustedChance = FMath::Clamp(AdjustedChance, 0.0f, 1.0f);
-    
-    Context->SetVariable(TEXT("RandomValue"), FGWTVariableValue::FromFloat(RandomValue));
-    Context->SetVariable(TEXT("ChanceThreshold"), FGWTVariableValue::FromFloat(AdjustedChance));
-    
-    return RandomValue <= AdjustedChance;
+    return FMath::Clamp(AdjustedChance, 0.0f, 1.0f);
 }
 
 bool UConditionNode::EvaluateHasStatus(USpellExecutionContext* Context)
@@ -248,9 +259,8 @@ bool UConditionNode::EvaluateHasStatus(USpellExecutionContext* Context)
         return false;
     }
     
-    // In a real implementation, you'd check for actual status effects
-    // For now, simulate random status check
-    bool bHasStatus = FMath::RandBool();
+    const UGrimoireStatusSubsystem* StatusSubsystem = UWorld::GetSubsystem<UGrimoireStatusSubsystem>(Target->GetWorld());
+    const bool bHasStatus = StatusSubsystem && StatusSubsystem->HasStatus(Target, StatusType);
     
     Context->SetVariable(TEXT("HasStatus"), FGWTVariableValue::FromBool(bHasStatus));
     
@@ -274,22 +284,105 @@ bool UConditionNode::EvaluateTimeBased(USpellExecutionContext* Context)
     return CompareValues(TimeSinceStart, ComparisonValue, ComparisonOperator);
 }
 
-float UConditionNode::GetVariableValue(USpellExecutionContext* Context, FName VarName)
+void UConditionNode::ResolveRegisters(FSpellRegisterLayout& Layout)
+{
+    VariableSlot = Layout.AddSlot(VariableName);
+}
+
+bool UConditionNode::GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const
 {
-    if (!Context->HasVariable(VarName))
+    OutAccess.Read(ESpellRegister::BoolCondition);
+    OutAccess.Read(ESpellRegister::ConditionValue);
+    OutAccess.Read(ESpellRegister::CompareValue);
+    OutAccess.Read(VariableSlot);
+    OutAccess.Read(Layout, TEXT("LastConditionResult"));
+    OutAccess.Read(Layout, TEXT("SecondaryCondition"));
+
+    OutAccess.Write(ESpellRegister::ConditionResult);
+    OutAccess.Write(ESpellRegister::LastConditionNode);
+
+    // Diagnostics published by the evaluators and rarity effects
+    static const FName WrittenNames[] =
     {
-        return 0.0f;
+        TEXT("TargetHealth"), TEXT("Distance"), TEXT("RandomValue"), TEXT("ChanceThreshold"), TEXT("HasStatus"),
+        TEXT("TimeSinceStart"), TEXT("CurrentTime"), TEXT("ConditionConfidence"), TEXT("PreviousCondition"),
+        TEXT("LastConditionResult"), TEXT("ComplexCondition"),
+    };
+    for (const FName Name : WrittenNames)
+    {
+        OutAccess.Write(Layout, Name);
     }
-    
-    FGWTVariableValue Var = Context->GetVariable(VarName);
-    switch (Var.Type)
+    return true;
+}
+
+bool UConditionNode::IsTaskSafe() const
+{
+    // Quantum conditioning creates a context, which has to come from the game thread
+    if (NodeRarity == EItemRarity::Legendary)
+    {
+        return false;
+    }
+
+    switch (ConditionType)
+    {
+        case EConditionType::IfThen:
+        case EConditionType::IfThenElse:
+        case EConditionType::Compare:
+        case EConditionType::DistanceCheck:
+        case EConditionType::HasStatus:
+        case EConditionType::TimeBased:
+            return true;
+
+        // These roll the shared random stream, whose order must not depend on thread timing
+        default:
+            return false;
+    }
+}
+
+bool UConditionNode::GetConstantResult(const TBitArray<>& WrittenSlots, bool& bOutResult) const
+{
+    const auto IsWritten = [&WrittenSlots](ESpellRegister Register)
+    {
+        const int32 Slot = static_cast<int32>(Register);
+        return Slot < WrittenSlots.Num() && WrittenSlots[Slot];
+    };
+
+    switch (ConditionType)
+    {
+        case EConditionType::RandomChance:
+            // The roll is in [0, 1], so a certain chance always passes
+            if (GetAdjustedChance() >= 1.0f)
+            {
+                bOutResult = true;
+                return true;
+            }
+            return false;
+
+        case EConditionType::Compare:
+            // Unset inputs read as zero and the node's own ComparisonValue
+            if (!IsWritten(ESpellRegister::ConditionValue) && !IsWritten(ESpellRegister::CompareValue))
+            {
+                bOutResult = CompareValues(0.0f, ComparisonValue, ComparisonOperator);
+                return true;
+            }
+            return false;
+
+        default:
+            return false;
+    }
+}
+
+float UConditionNode::GetVariableValue(USpellExecutionContext* Context, int32 Slot)
+{
+    const FSpellValue& Var = Context->GetRegister(Slot);
+    switch (Var.GetType())
     {
         case EGWTVariableType::Float:
-            return Var.FloatValue;
+            return Var.GetFloat();
         case EGWTVariableType::Int:
-            return static_cast<float>(Var.IntValue);
+            return static_cast<float>(Var.GetInt());
         case EGWTVariableType::Bool:
-            return Var.BoolValue ? 1.0f : 0.0f;
+            return Var.GetBool() ? 1.0f : 0.0f;
         default:
             return 0.0f;
     }
@@ -318,34 +411,11 @@ bool UConditionNode::CompareValues(float A, float B, EComparisonOperator Operato
 
 void UConditionNode::ExecuteTrueBranch(USpellExecutionContext* Context)
 {
-    if (TrueBranchNodes.Num() == 0)
-    {
-        // Try to get connected nodes from graph
-        if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
-        {
-            TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("True"));
-            
-            for (const FHeartGraphPinReference& Connection : Connections)
-            {
-                if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-                {
-                    if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                    {
-                        SpellNode->Execute(Context);
-                    }
-                }
-            }
-        }
-    }
-    else
+    for (USpellNode* Node : GetConnectedSpellNodes(ESpellPin::True))
     {
-        // Use cached nodes
-        for (USpellNode* Node : TrueBranchNodes)
+        if (Node && IsValid(Node))
         {
-            if (Node && IsValid(Node))
-            {
-                Node->Execute(Context);
-            }
+            Node->Execute(Context);
         }
     }
     
@@ -354,34 +424,11 @@ void UConditionNode::ExecuteTrueBranch(USpellExecutionContext* Context)
 
 void UConditionNode::ExecuteFalseBranch(USpellExecutionContext* Context)
 {
-    if (FalseBranchNodes.Num() == 0)
-    {
-        // Try to get connected nodes from graph
-        if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
-        {
-            TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("False"));
-            
-            for (const FHeartGraphPinReference& Connection : Connections)
-            {
-                if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-                {
-                    if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                    {
-                        SpellNode->Execute(Context);
-                    }
-                }
-            }
-        }
-    }
-    else
+    for (USpellNode* Node : GetConnectedSpellNodes(ESpellPin::False))
     {
-        // Use cached nodes
-        for (USpellNode* Node : FalseBranchNodes)
+        if (Node && IsValid(Node))
         {
-            if (Node && IsValid(Node))
-            {
-                Node->Execute(Context);
-            }
+            Node->Execute(Context);
         }
     }
     
@@ -413,53 +460,11 @@ void UConditionNode::ApplyRarityEffects(USpellExecutionContext* Context, bool bC
             break;
             
         case EItemRarity::Legendary:
-            // Quantum conditioning - executes both branches with different contexts
-            if (bConditionResult)
-            {
-                // Create alternative context for false branch
-                USpellExecutionContext* AltContext = Context->CreateChildContext();
-                AltContext->ModifySpellPower(0.5f); // Reduced power for quantum branch
-                ExecuteFalseBranch(AltContext);
-            }
+            // Quantum conditioning runs both branches, see RunsBothBranches
             break;
     }
 }
 
-void UConditionNode::CacheConnectedNodes()
-{
-    TrueBranchNodes.Empty();
-    FalseBranchNodes.Empty();
-    
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
-    {
-        // Cache True branch connections
-        TArray<FHeartGraphPinReference> TrueConnections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("True"));
-        for (const FHeartGraphPinReference& Connection : TrueConnections)
-        {
-            if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    TrueBranchNodes.Add(SpellNode);
-                }
-            }
-        }
-        
-        // Cache False branch connections
-        TArray<FHeartGraphPinReference> FalseConnections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("False"));
-        for (const FHeartGraphPinReference& Connection : FalseConnections)
-        {
-            if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    FalseBranchNodes.Add(SpellNode);
-                }
-            }
-        }
-    }
-}
-
 float UConditionNode::GetBasePower() const
 {
     return 0.0f; // Conditions don't provide power directly
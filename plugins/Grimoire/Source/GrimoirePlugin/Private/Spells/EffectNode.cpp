@@ -1,30 +1,35 @@
 // Source/GrimoirePlugin/Private/EffectNode.cpp
-#include "EffectNode.h"
-#include "Kismet/GameplayStatics.h"
+#include "Spells/EffectNode.h"
+#include "Spells/SpellExecutionContext.h"
 #include "GameFramework/Character.h"
 
-void UEffectNode::Execute(UObject* Context)
+void UEffectNode::OnExecute(USpellExecutionContext* Context)
 {
-    Super::Execute(Context);
+    Super::OnExecute(Context);
 
     float Power = GetBasePower() * Intensity;
+    ACharacter* Target = Cast<ACharacter>(Context->Target);
+    if (!Target)
+    {
+        return;
+    }
 
     switch (EffectType)
     {
         case EEffectType::Damage:
-            ApplyDamage(Context, Power);
+            ApplyDamage(Context, Target, Power);
             break;
         case EEffectType::Teleport:
-            ApplyTeleport(Context);
+            ApplyTeleport(Context, Target);
             break;
         case EEffectType::Knockback:
-            ApplyKnockback(Context);
+            ApplyKnockback(Context, Target);
             break;
         case EEffectType::Heal:
-            ApplyHeal(Context, Power);
+            ApplyHeal(Context, Target, Power);
             break;
         case EEffectType::StatusEffect:
-            ApplyStatusEffect(Context);
+            ApplyStatusEffect(Context, Target);
             break;
         default:
             break;
@@ -36,55 +41,37 @@ float UEffectNode::GetBasePower() const
     return Intensity * GetRarityScaleFactor();
 }
 
-void UEffectNode::ApplyDamage(UObject* Context, float DamageAmount)
+bool UEffectNode::GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const
 {
-    ACharacter* Target = Cast<ACharacter>(Context);
-    if (Target)
-    {
-        UGameplayStatics::ApplyDamage(Target, DamageAmount, nullptr, nullptr, UDamageType::StaticClass());
-        UE_LOG(LogTemp, Log, TEXT("Effect: Applied %.2f Damage"), DamageAmount);
-    }
+    // Acts on the target, no registers
+    OutAccess.bHasSideEffects = true;
+    return true;
 }
 
-void UEffectNode::ApplyTeleport(UObject* Context)
+void UEffectNode::ApplyDamage(USpellExecutionContext* Context, ACharacter* Target, float DamageAmount)
 {
-    ACharacter* Target = Cast<ACharacter>(Context);
-    if (Target)
-    {
-        FVector NewLocation = Target->GetActorLocation() + FVector(0, 0, 100.0f); // Example teleport up
-        Target->SetActorLocation(NewLocation);
-        UE_LOG(LogTemp, Log, TEXT("Effect: Teleported to %s"), *NewLocation.ToString());
-    }
+    Context->GetCommandBuffer().Damage(Target, DamageAmount, Context->Caster);
 }
 
-void UEffectNode::ApplyKnockback(UObject* Context)
+void UEffectNode::ApplyTeleport(USpellExecutionContext* Context, ACharacter* Target)
 {
-    ACharacter* Target = Cast<ACharacter>(Context);
-    if (Target)
-    {
-        FVector KnockbackForce = FVector(0, 0, 300.0f); // Example upward knockback
-        Target->LaunchCharacter(KnockbackForce, false, false);
-        UE_LOG(LogTemp, Log, TEXT("Effect: Applied Knockback"));
-    }
+    // Relative, so the target's location is read when the teleport is applied
+    Context->GetCommandBuffer().Teleport(Target, FVector(0, 0, 100.0f), Context->Caster); // Example teleport up
 }
 
-void UEffectNode::ApplyHeal(UObject* Context, float HealAmount)
+void UEffectNode::ApplyKnockback(USpellExecutionContext* Context, ACharacter* Target)
 {
-    ACharacter* Target = Cast<ACharacter>(Context);
-    if (Target)
-    {
-        Target->ModifyHealth(HealAmount); // Assume custom health method
-        UE_LOG(LogTemp, Log, TEXT("Effect: Healed %.2f Health"), HealAmount);
-    }
+    FVector KnockbackForce = FVector(0, 0, 300.0f); // Example upward knockback
+    Context->GetCommandBuffer().Launch(Target, KnockbackForce, Context->Caster);
 }
 
-void UEffectNode::ApplyStatusEffect(UObject* Context)
+void UEffectNode::ApplyHeal(USpellExecutionContext* Context, ACharacter* Target, float HealAmount)
 {
-    ACharacter* Target = Cast<ACharacter>(Context);
-    if (Target)
-    {
-        // Apply debuff based on StatusType (e.g., Burning: DoT)
-        UE_LOG(LogTemp, Log, TEXT("Effect: Applied %s for %.2f seconds"), *UEnum::GetValueAsString(StatusType), StatusDuration);
-        // Timer for duration (similar to TriggerNode)
-    }
-}
\ No newline at end of file
+    Context->GetCommandBuffer().Heal(Target, HealAmount, Context->Caster);
+}
+
+void UEffectNode::ApplyStatusEffect(USpellExecutionContext* Context, ACharacter* Target)
+{
+    // Timer for duration (similar to TriggerNode)
+    Context->GetCommandBuffer().ApplyStatus(Target, StatusType, StatusDuration, Context->Caster);
+}
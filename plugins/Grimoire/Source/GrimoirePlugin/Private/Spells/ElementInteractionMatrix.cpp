@@ -0,0 +1,119 @@
+#include "Spells/ElementInteractionMatrix.h"
+#include "Engine/DataTable.h"
+
+TSharedRef<const FElementInteractionMatrix> FElementInteractionMatrix::Current = MakeShared<const FElementInteractionMatrix>();
+
+namespace ElementInteractionMatrix
+{
+    static bool IsValidElement(ESpellElement Element)
+    {
+        return static_cast<uint8>(Element) < FElementInteractionMatrix::NumElements;
+    }
+
+    static FString GetPairName(int32 Source, int32 Target)
+    {
+        return FString::Printf(TEXT("%s_%s"),
+            *UEnum::GetValueAsString(static_cast<ESpellElement>(Source)),
+            *UEnum::GetValueAsString(static_cast<ESpellElement>(Target)));
+    }
+}
+
+TSharedPtr<const FElementInteractionMatrix> FElementInteractionMatrix::Compile(const UDataTable* Table, TArray<FString>& OutErrors)
+{
+    using namespace ElementInteractionMatrix;
+
+    if (!Table)
+    {
+        OutErrors.Add(TEXT("No element interaction table"));
+        return nullptr;
+    }
+    if (Table->GetRowStruct() != FElementInteractionRow::StaticStruct())
+    {
+        OutErrors.Add(FString::Printf(TEXT("%s does not use FElementInteractionRow rows"), *Table->GetPathName()));
+        return nullptr;
+    }
+
+    const int32 NumErrors = OutErrors.Num();
+    const TSharedRef<FElementInteractionMatrix> Matrix = MakeShared<FElementInteractionMatrix>();
+    TBitArray<> Listed(false, NumElements * NumElements);
+
+    Table->ForeachRow<FElementInteractionRow>(TEXT("FElementInteractionMatrix::Compile"), [&Matrix, &Listed, &OutErrors](const FName& RowName, const FElementInteractionRow& Row)
+    {
+        for (const FElementInteraction& Interaction : Row.Interactions)
+        {
+            if (!IsValidElement(Interaction.SourceElement) || !IsValidElement(Interaction.TargetElement))
+            {
+                OutErrors.Add(FString::Printf(TEXT("Row %s names an invalid element"), *RowName.ToString()));
+                continue;
+            }
+
+            const int32 Index = static_cast<uint8>(Interaction.SourceElement) * NumElements + static_cast<uint8>(Interaction.TargetElement);
+            if (Listed[Index])
+            {
+                OutErrors.Add(FString::Printf(TEXT("Row %s repeats %s"), *RowName.ToString(),
+                    *GetPairName(static_cast<uint8>(Interaction.SourceElement), static_cast<uint8>(Interaction.TargetElement))));
+            }
+            Listed[Index] = true;
+
+            FEntry& Entry = Matrix->Entries[Index];
+            Entry.DamageMultiplier = Interaction.DamageMultiplier;
+            Entry.Duration = Interaction.Duration;
+            Entry.bCreatesSustainedEffect = Interaction.bCreatesSustainedEffect;
+            Entry.bCancelsProjectiles = Interaction.bCancelsProjectiles;
+
+            // Listing a pair with neutral values is how the table says it does nothing
+            Entry.bReacts = Entry.DamageMultiplier != 1.0f || Entry.Duration > 0.0f || Entry.bCreatesSustainedEffect || Entry.bCancelsProjectiles;
+            Matrix->Descriptions[Index] = Interaction.EffectDescription;
+        }
+    });
+
+    // Every pair must be listed, and colliding spells must react the same whichever one is the source
+    for (int32 Source = 0; Source < NumElements; ++Source)
+    {
+        for (int32 Target = 0; Target < NumElements; ++Target)
+        {
+            const int32 Index = Source * NumElements + Target;
+            if (!Listed[Index])
+            {
+                OutErrors.Add(FString::Printf(TEXT("Missing %s"), *GetPairName(Source, Target)));
+                continue;
+            }
+
+            const int32 MirrorIndex = Target * NumElements + Source;
+            const FEntry& Entry = Matrix->Entries[Index];
+            const FEntry& Mirror = Matrix->Entries[MirrorIndex];
+            if (Target > Source && Listed[MirrorIndex]
+                && (Entry.DamageMultiplier != Mirror.DamageMultiplier || Entry.Duration != Mirror.Duration
+                    || Entry.bCreatesSustainedEffect != Mirror.bCreatesSustainedEffect || Entry.bCancelsProjectiles != Mirror.bCancelsProjectiles))
+            {
+                OutErrors.Add(FString::Printf(TEXT("%s and %s differ"), *GetPairName(Source, Target), *GetPairName(Target, Source)));
+            }
+        }
+    }
+
+    if (OutErrors.Num() > NumErrors)
+    {
+        return nullptr;
+    }
+    return Matrix;
+}
+
+void FElementInteractionMatrix::Publish(const TSharedRef<const FElementInteractionMatrix>& Matrix)
+{
+    check(IsInGameThread());
+    Current = Matrix;
+}
+
+FElementInteraction FElementInteractionMatrix::GetInteraction(ESpellElement Source, ESpellElement Target) const
+{
+    using namespace ElementInteractionMatrix;
+
+    if (!IsValidElement(Source) || !IsValidElement(Target) || !Find(Source, Target).bReacts)
+    {
+        return FElementInteraction{ Source, Target, FText::FromString("No interaction"), 1.0f, 0.0f, false, false };
+    }
+
+    const int32 Index = static_cast<uint8>(Source) * NumElements + static_cast<uint8>(Target);
+    const FEntry& Entry = Entries[Index];
+    return FElementInteraction{ Source, Target, Descriptions[Index], Entry.DamageMultiplier, Entry.Duration, Entry.bCreatesSustainedEffect, Entry.bCancelsProjectiles };
+}
@@ -1,8 +1,8 @@
 #include "Spells/FlowNode.h"
 #include "SpellExecutionContext.h"
 #include "Components/GrimoireComponent.h"
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
 #include "Model/HeartGraph.h"
 
 UFlowNode::UFlowNode()
@@ -21,10 +21,6 @@ UFlowNode::UFlowNode()
     bBreakOnCondition = false;
     BreakConditionVariable = TEXT("ShouldBreak");
     NodeManaCost = 8.0f;
-    
-    CachedContext = nullptr;
-    RecursionDepth = 0;
-    CompletedParallelNodes = 0;
 }
 
 TArray<FHeartGraphPinDesc> UFlowNode::GetInputPinDescs() const
@@ -92,20 +88,10 @@ void UFlowNode::OnExecute(USpellExecutionContext* Context)
         return;
     }
     
-    // Check recursion limit
-    if (!CheckRecursionLimit(Context))
-    {
-        UE_LOG(LogTemp, Error, TEXT("FlowNode recursion limit exceeded for %s"), *NodeName);
-        return;
-    }
-    
     UE_LOG(LogTemp, Log, TEXT("FlowNode executing: %s, Type: %s"), 
         *NodeName, 
         *UEnum::GetValueAsString(FlowType));
     
-    // Cache context for timer callbacks
-    CachedContext = Context;
-    
     // Apply rarity effects before execution
     ApplyRarityEffects(Context);
     
@@ -149,7 +135,7 @@ void UFlowNode::OnExecute(USpellExecutionContext* Context)
 void UFlowNode::ExecuteSequenceInternal(USpellExecutionContext* Context)
 {
     // Sequential execution of connected nodes
-    TArray<USpellNode*> SequenceNodes = GetConnectedOutputNodes();
+    TConstArrayView<USpellNode*> SequenceNodes = GetConnectedOutputNodes();
     
     for (int32 i = 0; i < SequenceNodes.Num(); i++)
     {
@@ -157,8 +143,8 @@ void UFlowNode::ExecuteSequenceInternal(USpellExecutionContext* Context)
         if (Node && IsValid(Node))
         {
             // Set sequence info in context
-            Context->SetVariable(TEXT("SequenceIndex"), FGWTVariableValue::FromInt(i));
-            Context->SetVariable(TEXT("SequenceTotal"), FGWTVariableValue::FromInt(SequenceNodes.Num()));
+            Context->SetRegister(ESpellRegister::SequenceIndex, FSpellValue::FromInt(i));
+            Context->SetRegister(ESpellRegister::SequenceTotal, FSpellValue::FromInt(SequenceNodes.Num()));
             
             Node->Execute(Context);
             
@@ -178,13 +164,13 @@ void UFlowNode::ExecuteLoopInternal(USpellExecutionContext* Context)
 {
     InitializeLoopState(Context);
     
-    TArray<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
+    TConstArrayView<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
     
     while (ShouldContinueLoop(Context))
     {
         // Set loop variables in context
-        Context->SetVariable(TEXT("LoopIndex"), FGWTVariableValue::FromInt(CurrentLoopState.CurrentIteration));
-        Context->SetVariable(TEXT("LoopTotal"), FGWTVariableValue::FromInt(CurrentLoopState.MaxIterations));
+        Context->SetRegister(ESpellRegister::LoopIndex, FSpellValue::FromInt(CurrentLoopState.CurrentIteration));
+        Context->SetRegister(ESpellRegister::LoopTotal, FSpellValue::FromInt(CurrentLoopState.MaxIterations));
         
         // Execute loop body
         for (USpellNode* Node : LoopBodyNodes)
@@ -206,19 +192,9 @@ void UFlowNode::ExecuteLoopInternal(USpellExecutionContext* Context)
     }
     
     // Execute completion nodes
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
+    for (USpellNode* SpellNode : GetConnectedSpellNodes(ESpellPin::OnComplete))
     {
-        TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("OnComplete"));
-        for (const FHeartGraphPinReference& Connection : Connections)
-        {
-            if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    SpellNode->Execute(Context);
-                }
-            }
-        }
+        SpellNode->Execute(Context);
     }
     
     UE_LOG(LogTemp, Log, TEXT("Loop completed for %s (%d iterations)"), 
@@ -229,17 +205,14 @@ void UFlowNode::ExecuteWhileLoop(USpellExecutionContext* Context)
 {
     InitializeLoopState(Context);
     
-    TArray<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
+    TConstArrayView<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
     
     while (CurrentLoopState.bShouldContinue && 
            CurrentLoopState.CurrentIteration < CurrentLoopState.MaxIterations)
     {
         // Check while condition
-        bool bCondition = true;
-        if (Context->HasVariable(TEXT("Condition")))
-        {
-            bCondition = Context->GetVariable(TEXT("Condition")).BoolValue;
-        }
+        const FSpellValue& ConditionVar = Context->GetRegister(ESpellRegister::Condition);
+        const bool bCondition = ConditionVar.IsSet() ? ConditionVar.GetBool() : true;
         
         if (!bCondition)
         {
@@ -247,7 +220,7 @@ void UFlowNode::ExecuteWhileLoop(USpellExecutionContext* Context)
         }
         
         // Execute loop body
-        Context->SetVariable(TEXT("WhileIndex"), FGWTVariableValue::FromInt(CurrentLoopState.CurrentIteration));
+        Context->SetRegister(ESpellRegister::WhileIndex, FSpellValue::FromInt(CurrentLoopState.CurrentIteration));
         
         for (USpellNode* Node : LoopBodyNodes)
         {
@@ -270,27 +243,14 @@ void UFlowNode::ExecuteWhileLoop(USpellExecutionContext* Context)
 
 void UFlowNode::ExecuteForLoop(USpellExecutionContext* Context)
 {
-    int32 LoopCount = MaxIterations;
-    
-    // Override with input if available
-    if (Context->HasVariable(TEXT("IterationCount")))
-    {
-        FGWTVariableValue CountVar = Context->GetVariable(TEXT("IterationCount"));
-        if (CountVar.Type == EGWTVariableType::Int)
-        {
-            LoopCount = CountVar.IntValue;
-        }
-    }
+    const int32 LoopCount = ResolveIterationLimit(Context);
     
-    // Apply rarity scaling
-    LoopCount = FMath::Min(LoopCount * GetRarityScaleFactor(), GetMaxIterationsByRarity());
-    
-    TArray<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
+    TConstArrayView<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
     
     for (int32 i = 0; i < LoopCount; i++)
     {
-        Context->SetVariable(TEXT("ForIndex"), FGWTVariableValue::FromInt(i));
-        Context->SetVariable(TEXT("ForTotal"), FGWTVariableValue::FromInt(LoopCount));
+        Context->SetRegister(ESpellRegister::ForIndex, FSpellValue::FromInt(i));
+        Context->SetRegister(ESpellRegister::ForTotal, FSpellValue::FromInt(LoopCount));
         
         for (USpellNode* Node : LoopBodyNodes)
         {
@@ -309,33 +269,47 @@ void UFlowNode::ExecuteForLoop(USpellExecutionContext* Context)
     }
 }
 
-void UFlowNode::ExecuteDelayInternal(USpellExecutionContext* Context)
+float UFlowNode::ResolveDelayTime(USpellExecutionContext* Context) const
 {
     float Delay = DelayTime;
     
     // Override with input if available
-    if (Context->HasVariable(TEXT("DelayTime")))
+    const FSpellValue& DelayVar = Context->GetRegister(ESpellRegister::DelayTime);
+    if (DelayVar.GetType() == EGWTVariableType::Float)
     {
-        FGWTVariableValue DelayVar = Context->GetVariable(TEXT("DelayTime"));
-        if (DelayVar.Type == EGWTVariableType::Float)
-        {
-            Delay = DelayVar.FloatValue;
-        }
+        Delay = DelayVar.GetFloat();
     }
     
     // Apply rarity effects to delay
-    Delay /= GetRarityScaleFactor(); // Higher rarity = shorter delay
+    return Delay / GetRarityScaleFactor(); // Higher rarity = shorter delay
+}
+
+float UFlowNode::ResolveIterationDelay() const
+{
+    return IterationDelay / GetRarityScaleFactor();
+}
+
+void UFlowNode::ExecuteDelayInternal(USpellExecutionContext* Context)
+{
+    const float Delay = ResolveDelayTime(Context);
     
     UWorld* World = GetWorld();
-    if (World)
+    UGrimoireSchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UGrimoireSchedulerSubsystem>() : nullptr;
+    if (Scheduler)
     {
-        World->GetTimerManager().SetTimer(
-            DelayTimerHandle,
-            this,
-            &UFlowNode::HandleDelayComplete,
-            Delay,
-            false
-        );
+        // Every call gets its own continuation, so overlapping casts through this node do not replace each other
+        Context->RetainCast();
+        Scheduler->Schedule(Delay, FSimpleDelegate::CreateLambda([WeakThis = TWeakObjectPtr<UFlowNode>(this), WeakContext = TWeakObjectPtr<USpellExecutionContext>(Context)]()
+        {
+            if (UFlowNode* FlowNode = WeakThis.Get())
+            {
+                FlowNode->HandleDelayComplete(WeakContext);
+            }
+            else if (USpellExecutionContext* PendingContext = WeakContext.Get())
+            {
+                PendingContext->ReleaseCast();
+            }
+        }));
         
         UE_LOG(LogTemp, Log, TEXT("Started delay of %.2f seconds for %s"), Delay, *NodeName);
     }
@@ -343,16 +317,16 @@ void UFlowNode::ExecuteDelayInternal(USpellExecutionContext* Context)
 
 void UFlowNode::ExecuteParallelInternal(USpellExecutionContext* Context)
 {
-    ActiveParallelNodes = GetParallelNodes();
-    CompletedParallelNodes = 0;
+    TConstArrayView<USpellNode*> ParallelNodes = GetParallelNodes();
+    int32 CompletedParallelNodes = 0;
     
     // Execute all parallel branches simultaneously
-    for (USpellNode* Node : ActiveParallelNodes)
+    for (USpellNode* Node : ParallelNodes)
     {
         if (Node && IsValid(Node))
         {
-            // Create child context for each parallel branch
-            USpellExecutionContext* ChildContext = Context->CreateChildContext();
+            // Create child scope for each parallel branch
+            USpellExecutionContext* ChildContext = Context->ForkChildContext();
             Node->Execute(ChildContext);
             
             // In a real implementation, you'd track completion asynchronously
@@ -360,53 +334,30 @@ void UFlowNode::ExecuteParallelInternal(USpellExecutionContext* Context)
         }
     }
     
+    // Bring the branches' global writes back in creation order
+    Context->JoinChildContexts();
+    
     // For now, assume all complete immediately
     // In a real system, you'd wait for async completion
-    if (CompletedParallelNodes >= ActiveParallelNodes.Num())
+    if (CompletedParallelNodes >= ParallelNodes.Num())
     {
         // Execute completion branch
-        if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
+        for (USpellNode* SpellNode : GetConnectedSpellNodes(ESpellPin::OnAllComplete))
         {
-            TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("OnAllComplete"));
-            for (const FHeartGraphPinReference& Connection : Connections)
-            {
-                if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-                {
-                    if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                    {
-                        SpellNode->Execute(Context);
-                    }
-                }
-            }
+            SpellNode->Execute(Context);
         }
     }
 }
 
 void UFlowNode::ExecuteBranch(USpellExecutionContext* Context)
 {
-    bool bCondition = true;
-    
     // Get condition from input
-    if (Context->HasVariable(TEXT("Condition")))
-    {
-        bCondition = Context->GetVariable(TEXT("Condition")).BoolValue;
-    }
-    
-    FName PinName = bCondition ? TEXT("True") : TEXT("False");
+    const FSpellValue& ConditionVar = Context->GetRegister(ESpellRegister::Condition);
+    const bool bCondition = ConditionVar.IsSet() ? ConditionVar.GetBool() : true;
     
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
+    for (USpellNode* SpellNode : GetConnectedSpellNodes(bCondition ? ESpellPin::True : ESpellPin::False))
     {
-        TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), PinName);
-        for (const FHeartGraphPinReference& Connection : Connections)
-        {
-            if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    SpellNode->Execute(Context);
-                }
-            }
-        }
+        SpellNode->Execute(Context);
     }
     
     UE_LOG(LogTemp, Log, TEXT("Branch executed %s path for %s"), 
@@ -415,24 +366,12 @@ void UFlowNode::ExecuteBranch(USpellExecutionContext* Context)
 
 void UFlowNode::ExecuteGate(USpellExecutionContext* Context)
 {
-    bool bGateOpen = Context->HasVariable(TEXT("GateOpen")) ? 
-                     Context->GetVariable(TEXT("GateOpen")).BoolValue : true;
+    const FSpellValue& GateVar = Context->GetRegister(ESpellRegister::GateOpen);
+    const bool bGateOpen = GateVar.IsSet() ? GateVar.GetBool() : true;
     
-    FName PinName = bGateOpen ? TEXT("Open") : TEXT("Closed");
-    
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
+    for (USpellNode* SpellNode : GetConnectedSpellNodes(bGateOpen ? ESpellPin::Open : ESpellPin::Closed))
     {
-        TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), PinName);
-        for (const FHeartGraphPinReference& Connection : Connections)
-        {
-            if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    SpellNode->Execute(Context);
-                }
-            }
-        }
+        SpellNode->Execute(Context);
     }
     
     UE_LOG(LogTemp, Log, TEXT("Gate %s for %s"), 
@@ -442,24 +381,37 @@ void UFlowNode::ExecuteGate(USpellExecutionContext* Context)
 void UFlowNode::InitializeLoopState(USpellExecutionContext* Context)
 {
     CurrentLoopState.CurrentIteration = 0;
-    CurrentLoopState.MaxIterations = MaxIterations;
     CurrentLoopState.bIsActive = true;
     CurrentLoopState.bShouldContinue = true;
     CurrentLoopState.IterationDelay = IterationDelay;
+    CurrentLoopState.MaxIterations = ResolveIterationLimit(Context);
+}
+
+int32 UFlowNode::ResolveIterationLimit(USpellExecutionContext* Context) const
+{
+    int32 LoopCount = MaxIterations;
     
     // Override max iterations from input
-    if (Context->HasVariable(TEXT("IterationCount")))
+    const FSpellValue& CountVar = Context->GetRegister(ESpellRegister::IterationCount);
+    if (CountVar.GetType() == EGWTVariableType::Int)
     {
-        FGWTVariableValue CountVar = Context->GetVariable(TEXT("IterationCount"));
-        if (CountVar.Type == EGWTVariableType::Int)
-        {
-            CurrentLoopState.MaxIterations = CountVar.IntValue;
-        }
+        LoopCount = CountVar.GetInt();
+    }
+    
+    return GetIterationLimit(LoopCount);
+}
+
+int32 UFlowNode::GetIterationLimit(int32 RequestedCount) const
+{
+    int32 LoopCount = RequestedCount;
+    
+    // Apply rarity scaling, For loops also scale the count itself
+    if (FlowType == EFlowNodeType::ForLoop)
+    {
+        LoopCount = FMath::FloorToInt(LoopCount * GetRarityScaleFactor());
     }
     
-    // Apply rarity scaling
-    int32 MaxAllowed = GetMaxIterationsByRarity();
-    CurrentLoopState.MaxIterations = FMath::Min(CurrentLoopState.MaxIterations, MaxAllowed);
+    return FMath::Min(LoopCount, GetMaxIterationsByRarity());
 }
 
 bool UFlowNode::ShouldContinueLoop(USpellExecutionContext* Context)
@@ -474,149 +426,131 @@ void UFlowNode::UpdateLoopState(USpellExecutionContext* Context)
     CurrentLoopState.CurrentIteration++;
     
     // Check for dynamic loop control
-    if (Context->HasVariable(TEXT("ShouldContinue")))
+    const FSpellValue& ContinueVar = Context->GetRegister(ESpellRegister::ShouldContinue);
+    if (ContinueVar.IsSet())
     {
-        CurrentLoopState.bShouldContinue = Context->GetVariable(TEXT("ShouldContinue")).BoolValue;
+        CurrentLoopState.bShouldContinue = ContinueVar.GetBool();
     }
 }
 
-void UFlowNode::HandleDelayComplete()
+void UFlowNode::HandleDelayComplete(TWeakObjectPtr<USpellExecutionContext> WeakContext)
 {
-    if (CachedContext)
+    USpellExecutionContext* Context = WeakContext.Get();
+    if (Context)
     {
         // Execute connected nodes after delay
-        TArray<USpellNode*> NextNodes = GetConnectedOutputNodes();
-        for (USpellNode* Node : NextNodes)
+        for (USpellNode* Node : GetConnectedOutputNodes())
         {
             if (Node && IsValid(Node))
             {
-                Node->Execute(CachedContext);
+                Node->Execute(Context);
             }
         }
         
         UE_LOG(LogTemp, Log, TEXT("Delay completed for %s"), *NodeName);
+
+        Context->ReleaseCast();
     }
-    
-    DelayTimerHandle.Invalidate();
 }
 
-void UFlowNode::HandleIterationTimer()
+TConstArrayView<USpellNode*> UFlowNode::GetLoopBodyNodes() const
 {
-    // Called for timed loop iterations
-    if (CachedContext && ShouldContinueLoop(CachedContext))
-    {
-        TArray<USpellNode*> LoopBodyNodes = GetLoopBodyNodes();
-        
-        for (USpellNode* Node : LoopBodyNodes)
-        {
-            if (Node && IsValid(Node))
-            {
-                Node->Execute(CachedContext);
-            }
-        }
-        
-        UpdateLoopState(CachedContext);
-        
-        if (ShouldContinueLoop(CachedContext))
-        {
-            // Schedule next iteration
-            UWorld* World = GetWorld();
-            if (World)
-            {
-                World->GetTimerManager().SetTimer(
-                    IterationTimerHandle,
-                    this,
-                    &UFlowNode::HandleIterationTimer,
-                    CurrentLoopState.IterationDelay,
-                    false
-                );
-            }
-        }
-    }
+    return GetConnectedSpellNodes(ESpellPin::LoopBody);
 }
 
-TArray<USpellNode*> UFlowNode::GetLoopBodyNodes() const
+TConstArrayView<USpellNode*> UFlowNode::GetParallelNodes() const
 {
-    TArray<USpellNode*> BodyNodes;
-    
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
-    {
-        TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("LoopBody"));
-        for (const FHeartGraphPinReference& Connection : Connections)
-        {
-            if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    BodyNodes.Add(SpellNode);
-                }
-            }
-        }
-    }
-    
-    return BodyNodes;
+    return GetConnectedSpellNodes(ESpellPin::Branch1, ESpellPin::Branch3);
 }
 
-TArray<USpellNode*> UFlowNode::GetParallelNodes() const
+TConstArrayView<USpellNode*> UFlowNode::GetConnectedOutputNodes() const
 {
-    TArray<USpellNode*> ParallelNodes;
-    
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
-    {
-        TArray<FName> BranchNames = {TEXT("Branch1"), TEXT("Branch2"), TEXT("Branch3")};
-        
-        for (const FName& BranchName : BranchNames)
-        {
-            TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), BranchName);
-            for (const FHeartGraphPinReference& Connection : Connections)
-            {
-                if (UHeartGraphNode* Node = Graph->GetNode(Connection.NodeGuid))
-                {
-                    if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                    {
-                        ParallelNodes.Add(SpellNode);
-                    }
-                }
-            }
-        }
-    }
-    
-    return ParallelNodes;
+    return GetConnectedSpellNodes(ESpellPin::ExecOut, ESpellPin::Next);
 }
 
 bool UFlowNode::EvaluateBreakCondition(USpellExecutionContext* Context)
 {
-    if (Context->HasVariable(BreakConditionVariable))
-    {
-        FGWTVariableValue BreakVar = Context->GetVariable(BreakConditionVariable);
-        if (BreakVar.Type == EGWTVariableType::Bool)
-        {
-            return BreakVar.BoolValue;
-        }
-    }
-    
-    return false;
+    const FSpellValue& BreakVar = Context->GetRegister(BreakConditionSlot);
+    return BreakVar.GetType() == EGWTVariableType::Bool && BreakVar.GetBool();
 }
 
-bool UFlowNode::CheckRecursionLimit(USpellExecutionContext* Context)
+void UFlowNode::ResolveRegisters(FSpellRegisterLayout& Layout)
 {
-    RecursionDepth++;
-    
-    if (RecursionDepth > MaxRecursionDepth)
+    BreakConditionSlot = bBreakOnCondition ? Layout.AddSlot(BreakConditionVariable) : FSpellRegisterLayout::InvalidSlot;
+}
+
+bool UFlowNode::GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const
+{
+    switch (FlowType)
     {
-        RecursionDepth = 0;
-        return false;
+        case EFlowNodeType::Sequence:
+            OutAccess.Write(ESpellRegister::SequenceIndex);
+            OutAccess.Write(ESpellRegister::SequenceTotal);
+            break;
+        case EFlowNodeType::Loop:
+            OutAccess.Read(ESpellRegister::IterationCount);
+            OutAccess.Read(ESpellRegister::ShouldContinue);
+            OutAccess.Write(ESpellRegister::LoopIndex);
+            OutAccess.Write(ESpellRegister::LoopTotal);
+            break;
+        case EFlowNodeType::WhileLoop:
+            OutAccess.Read(ESpellRegister::IterationCount);
+            OutAccess.Read(ESpellRegister::Condition);
+            OutAccess.Write(ESpellRegister::WhileIndex);
+            break;
+        case EFlowNodeType::ForLoop:
+            OutAccess.Read(ESpellRegister::IterationCount);
+            OutAccess.Write(ESpellRegister::ForIndex);
+            OutAccess.Write(ESpellRegister::ForTotal);
+            break;
+        case EFlowNodeType::Delay:
+            OutAccess.Read(ESpellRegister::DelayTime);
+            break;
+        case EFlowNodeType::Branch:
+            OutAccess.Read(ESpellRegister::Condition);
+            break;
+        case EFlowNodeType::Gate:
+            OutAccess.Read(ESpellRegister::GateOpen);
+            break;
+        default:
+            break;
     }
-    
-    // Reset recursion depth when execution completes
-    if (Context->ExecutionDepth == 0)
+
+    OutAccess.Read(BreakConditionSlot);
+
+    // Written by ApplyRarityEffects
+    switch (NodeRarity)
     {
-        RecursionDepth = 0;
+        case EItemRarity::Uncommon:  OutAccess.Write(Layout, TEXT("TimingPrecision")); break;
+        case EItemRarity::Rare:      OutAccess.Write(Layout, TEXT("OptimizedLoop")); break;
+        case EItemRarity::Epic:      OutAccess.Write(Layout, TEXT("ParallelSupport")); break;
+        case EItemRarity::Legendary: OutAccess.Write(Layout, TEXT("QuantumFlow")); break;
+        default: break;
     }
-    
     return true;
 }
 
+bool UFlowNode::IsTaskSafe() const
+{
+    switch (FlowType)
+    {
+        case EFlowNodeType::Sequence:
+        case EFlowNodeType::Branch:
+        case EFlowNodeType::Gate:
+            return true;
+
+        // Iteration delays suspend the spell, which a worker thread cannot do
+        case EFlowNodeType::Loop:
+        case EFlowNodeType::WhileLoop:
+        case EFlowNodeType::ForLoop:
+            return ResolveIterationDelay() <= 0.0f;
+
+        // Delays suspend, and Parallel forks contexts from the cast's pool
+        default:
+            return false;
+    }
+}
+
 int32 UFlowNode::GetMaxIterationsByRarity() const
 {
     switch (NodeRarity)
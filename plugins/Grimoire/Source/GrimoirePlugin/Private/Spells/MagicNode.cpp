@@ -1,24 +1,39 @@
 #include "Spells/MagicNode.h"
+#include "Spells/SpellExecutionContext.h"
+#include "Spells/ElementInteractionMatrix.h"
 #include "model/HeartGraphPin.h"
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
-#include "NiagaraFunctionLibrary.h" // For Niagara effects
+#include "Subsystems/GrimoireVFXSubsystem.h"
 
-void UMagicNode::Execute(UGrimoireComponent* Grimoire, AActor* ContextActor)
+void UMagicNode::OnExecute(USpellExecutionContext* Context)
 {
-    Super::Execute(Grimoire, ContextActor);
+    Super::OnExecute(Context);
 
-    UWorld* World = ContextActor ? ContextActor->GetWorld() : nullptr;
+    UWorld* World = Context->Caster ? Context->Caster->GetWorld() : nullptr;
     if (!World) return;
 
-    FVector SpawnLocation = FVector::ZeroVector; // From context or caster
-    FRotator SpawnRotation = FRotator::ZeroRotator;
-    AActor* Projectile = World->SpawnActor<AActor>(AActor::StaticClass(), SpawnLocation, SpawnRotation);
-    if (Projectile)
+    // Fired from the caster at the target, else straight ahead
+    const FVector SpawnLocation = Context->Caster->GetActorLocation();
+    FVector Direction = Context->Caster->GetActorForwardVector();
+    if (Context->Target)
     {
-        Projectile->SetLifeSpan(Range / 1000.0f);
-        UE_LOG(LogTemp, Log, TEXT("Magic Node: Spawned Projectile with Element %s"), *UEnum::GetValueAsString(ElementType));
+        Direction = (Context->Target->GetActorLocation() - SpawnLocation).GetSafeNormal(UE_SMALL_NUMBER, Direction);
     }
+    else if (!Context->TargetLocation.IsZero())
+    {
+        Direction = (Context->TargetLocation - SpawnLocation).GetSafeNormal(UE_SMALL_NUMBER, Direction);
+    }
+
+    if (ProjectileClass)
+    {
+        Context->GetCommandBuffer().Spawn(ProjectileClass, SpawnLocation, Direction.Rotation(), Range / 1000.0f, Context->Caster);
+    }
+    else
+    {
+        Context->GetCommandBuffer().Projectile(SpawnLocation, Direction * ProjectileSpeed, ElementType, Range, Context->Caster, Context->Grimoire.Get(), Context->SpellName);
+    }
+    UE_LOG(LogTemp, Log, TEXT("Magic Node: Queued Projectile with Element %s"), *UEnum::GetValueAsString(ElementType));
 }
 
 float UMagicNode::GetBasePower() const
@@ -26,6 +41,13 @@ float UMagicNode::GetBasePower() const
     return BaseDamage * GetRarityScaleFactor();
 }
 
+bool UMagicNode::GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const
+{
+    // Spawns projectiles, no registers
+    OutAccess.bHasSideEffects = true;
+    return true;
+}
+
 void UMagicNode::ApplyDamage(AActor* Target, float DamageAmount)
 {
     UGameplayStatics::ApplyDamage(Target, DamageAmount, nullptr, GetOwner(), UDamageType::StaticClass());
@@ -43,7 +65,10 @@ void UMagicNode::OnPinCollision(UHeartGraphPin* OtherPin, UObject* Context)
         if (World && Interaction.bCreatesSustainedEffect)
         {
             FVector CollisionLocation = FVector::ZeroVector; // From collision data
-            UNiagaraFunctionLibrary::SpawnSystemAtLocation(World, LoadObject<UNiagaraSystem>(nullptr, TEXT("/Content/Niagara/NS_GenericEffect.niagara")), CollisionLocation); // Example Niagara
+            if (UGrimoireVFXSubsystem* Effects = World->GetSubsystem<UGrimoireVFXSubsystem>())
+            {
+                Effects->RequestEffect(Effects->GetElementalCollisionEffect(), CollisionLocation);
+            }
             UE_LOG(LogTemp, Log, TEXT("Interaction: %s - Duration %.2f"), *Interaction.EffectDescription.ToString(), Interaction.Duration);
         }
         float Damage = BaseDamage * Interaction.DamageMultiplier;
@@ -51,16 +76,8 @@ void UMagicNode::OnPinCollision(UHeartGraphPin* OtherPin, UObject* Context)
     }
 }
 
-FElementInteraction UMagicNode::GetElementInteraction(EElementType Source, EElementType Target)
+FElementInteraction UMagicNode::GetElementInteraction(ESpellElement Source, ESpellElement Target)
 {
-    // Full table loaded from data asset
-    static UDataTable* InteractionTable = LoadObject<UDataTable>(nullptr, TEXT("/Content/ElementalInteractionsDataTable.ElementalInteractionsDataTable"));
-    if (InteractionTable)
-    {
-        FName RowName = FName(*FString::Printf(TEXT("%s_%s"), *UEnum::GetValueAsString(Source), *UEnum::GetValueAsString(Target)));
-        FElementInteraction* Interaction = InteractionTable->FindRow<FElementInteraction>(RowName, TEXT(""));
-        if (Interaction)
-            return *Interaction;
-    }
-    return FElementInteraction{ Source, Target, FText::FromString("No interaction"), 1.0f, 0.0f, false };
-}
\ No newline at end of file
+    // Compiled from the data table when the engine starts, see UGrimoireElementSubsystem
+    return FElementInteractionMatrix::Get().GetInteraction(Source, Target);
+}
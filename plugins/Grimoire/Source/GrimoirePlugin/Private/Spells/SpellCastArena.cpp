@@ -0,0 +1,46 @@
+#include "Spells/SpellCastArena.h"
+
+FSpellCastArena::~FSpellCastArena()
+{
+    for (FBlock& Block : Blocks)
+    {
+        FMemory::Free(Block.Data);
+    }
+}
+
+void* FSpellCastArena::Allocate(SIZE_T Size, SIZE_T Alignment)
+{
+    if (Cursor)
+    {
+        uint8* Aligned = Align(Cursor, Alignment);
+        if (Aligned + Size <= End)
+        {
+            Cursor = Aligned + Size;
+            BytesUsed += Size;
+            return Aligned;
+        }
+    }
+
+    // Move on to the next retained block that fits, or add one
+    const SIZE_T Required = Size + Alignment;
+    do
+    {
+        ++CurrentBlock;
+    }
+    while (Blocks.IsValidIndex(CurrentBlock) && Blocks[CurrentBlock].Size < Required);
+
+    if (!Blocks.IsValidIndex(CurrentBlock))
+    {
+        FBlock Block;
+        Block.Size = FMath::Max(BlockSize, Required);
+        Block.Data = static_cast<uint8*>(FMemory::Malloc(Block.Size));
+        CurrentBlock = Blocks.Add(Block);
+    }
+
+    const FBlock& Block = Blocks[CurrentBlock];
+    uint8* Aligned = Align(Block.Data, Alignment);
+    Cursor = Aligned + Size;
+    End = Block.Data + Block.Size;
+    BytesUsed += Size;
+    return Aligned;
+}
@@ -0,0 +1,267 @@
+#include "Spells/SpellCommandBuffer.h"
+#include "Spells/EffectNode.h"
+#include "Subsystems/GrimoireDamageSubsystem.h"
+#include "Subsystems/GrimoireProjectilePoolSubsystem.h"
+#include "Subsystems/GrimoireProjectileSubsystem.h"
+#include "Subsystems/GrimoireStatusSubsystem.h"
+#include "Components/GrimoireComponent.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spell Commands Applied"), STAT_GrimoireCommandsApplied, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spell Commands Folded"), STAT_GrimoireCommandsFolded, STATGROUP_Grimoire);
+
+void FSpellCommandBuffer::Damage(AActor* Target, float Amount, AActor* Instigator, ESpellElement Element)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::Damage;
+    Command.Subtype = static_cast<uint8>(Element);
+    Command.Target = Target;
+    Command.Instigator = Instigator;
+    Command.Magnitude = Amount;
+    Add(Command);
+}
+
+void FSpellCommandBuffer::Heal(AActor* Target, float Amount, AActor* Instigator)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::Heal;
+    Command.Target = Target;
+    Command.Instigator = Instigator;
+    Command.Magnitude = Amount;
+    Add(Command);
+}
+
+void FSpellCommandBuffer::Launch(AActor* Target, const FVector& Velocity, AActor* Instigator)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::Launch;
+    Command.Target = Target;
+    Command.Instigator = Instigator;
+    Command.Vector = Velocity;
+    Add(Command);
+}
+
+void FSpellCommandBuffer::Teleport(AActor* Target, const FVector& Offset, AActor* Instigator)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::Teleport;
+    Command.Target = Target;
+    Command.Instigator = Instigator;
+    Command.Vector = Offset;
+    Add(Command);
+}
+
+void FSpellCommandBuffer::Spawn(TSubclassOf<AActor> ActorClass, const FVector& Location, const FRotator& Rotation, float LifeSpan, AActor* Instigator)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::Spawn;
+    Command.Instigator = Instigator;
+    Command.Magnitude = LifeSpan;
+    Command.Vector = Location;
+    Command.Rotation = Rotation;
+    Command.ActorClass = ActorClass.Get();
+    Add(Command);
+}
+
+void FSpellCommandBuffer::ApplyStatus(AActor* Target, EStatusEffectType Status, float Duration, AActor* Instigator)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::ApplyStatus;
+    Command.Subtype = static_cast<uint8>(Status);
+    Command.Target = Target;
+    Command.Instigator = Instigator;
+    Command.Magnitude = Duration;
+    Add(Command);
+}
+
+void FSpellCommandBuffer::Projectile(const FVector& Location, const FVector& Velocity, ESpellElement Element, float Range, AActor* Instigator, UGrimoireComponent* Grimoire, FName SpellName)
+{
+    FSpellCommand Command;
+    Command.Type = ESpellCommandType::Projectile;
+    Command.Subtype = static_cast<uint8>(Element);
+    Command.Instigator = Instigator;
+    Command.Magnitude = Range;
+    Command.Vector = Location;
+    Command.Velocity = Velocity;
+    Command.Grimoire = Grimoire;
+    Command.SpellName = SpellName;
+    Add(Command);
+}
+
+void FSpellCommandBuffer::Add(const FSpellCommand& Command)
+{
+    // Hits are aggregated per frame by UGrimoireDamageSubsystem, which keeps each one in the breakdown
+    if (Command.Type == ESpellCommandType::Damage || Command.Type == ESpellCommandType::Spawn || Command.Type == ESpellCommandType::Projectile)
+    {
+        Commands.Add(Command);
+        return;
+    }
+
+    const TTuple<FObjectKey, ESpellCommandType, uint8> Key(FObjectKey(Command.Target.Get()), Command.Type, Command.Subtype);
+    if (const int32* Pending = FoldTargets.Find(Key))
+    {
+        FSpellCommand& Folded = Commands[*Pending];
+        switch (Command.Type)
+        {
+            case ESpellCommandType::Heal:
+                Folded.Magnitude += Command.Magnitude;
+                break;
+
+            // Teleports are relative, so back-to-back ones add up
+            case ESpellCommandType::Teleport:
+                Folded.Vector += Command.Vector;
+                break;
+
+            // A character only keeps its last pending launch of a frame
+            case ESpellCommandType::Launch:
+                Folded.Vector = Command.Vector;
+                break;
+
+            // Reapplying a status refreshes it
+            case ESpellCommandType::ApplyStatus:
+                Folded.Magnitude = FMath::Max(Folded.Magnitude, Command.Magnitude);
+                break;
+
+            default:
+                break;
+        }
+
+        INC_DWORD_STAT(STAT_GrimoireCommandsFolded);
+        return;
+    }
+
+    FoldTargets.Add(Key, Commands.Add(Command));
+}
+
+void FSpellCommandBuffer::Append(FSpellCommandBuffer& Other)
+{
+    for (const FSpellCommand& Command : Other.Commands)
+    {
+        Add(Command);
+    }
+    Other.Reset();
+}
+
+void FSpellCommandBuffer::Apply()
+{
+    if (bApplying || Commands.Num() == 0)
+    {
+        return;
+    }
+
+    check(IsInGameThread());
+    TGuardValue<bool> ApplyingGuard(bApplying, true);
+
+    // Applied commands must not absorb new ones
+    FoldTargets.Reset();
+
+    for (int32 Index = 0; Index < Commands.Num(); ++Index)
+    {
+        // Copied, since applying can record more commands and grow the array
+        const FSpellCommand Command = Commands[Index];
+        ApplyCommand(Command);
+    }
+
+    INC_DWORD_STAT_BY(STAT_GrimoireCommandsApplied, Commands.Num());
+    Reset();
+}
+
+void FSpellCommandBuffer::Reset()
+{
+    Commands.Reset();
+    FoldTargets.Reset();
+}
+
+void FSpellCommandBuffer::ApplyCommand(const FSpellCommand& Command)
+{
+    AActor* Target = Command.Target.Get();
+    ACharacter* Character = Cast<ACharacter>(Target);
+
+    switch (Command.Type)
+    {
+        case ESpellCommandType::Damage:
+            if (UGrimoireDamageSubsystem* DamageSubsystem = Target ? UWorld::GetSubsystem<UGrimoireDamageSubsystem>(Target->GetWorld()) : nullptr)
+            {
+                DamageSubsystem->AddHit(Target, Command.Magnitude, Command.Instigator.Get(), static_cast<ESpellElement>(Command.Subtype));
+            }
+            else if (Target)
+            {
+                UGameplayStatics::ApplyDamage(Target, Command.Magnitude, nullptr, nullptr, UDamageType::StaticClass());
+                UE_LOG(LogTemp, Log, TEXT("Effect: Applied %.2f Damage"), Command.Magnitude);
+            }
+            break;
+
+        case ESpellCommandType::Heal:
+            if (Character)
+            {
+                Character->ModifyHealth(Command.Magnitude); // Assume custom health method
+                UE_LOG(LogTemp, Log, TEXT("Effect: Healed %.2f Health"), Command.Magnitude);
+            }
+            break;
+
+        case ESpellCommandType::Launch:
+            if (Character)
+            {
+                Character->LaunchCharacter(Command.Vector, false, false);
+                UE_LOG(LogTemp, Log, TEXT("Effect: Applied Knockback"));
+            }
+            break;
+
+        case ESpellCommandType::Teleport:
+            if (Target)
+            {
+                const FVector NewLocation = Target->GetActorLocation() + Command.Vector;
+                Target->SetActorLocation(NewLocation);
+                UE_LOG(LogTemp, Log, TEXT("Effect: Teleported to %s"), *NewLocation.ToString());
+            }
+            break;
+
+        case ESpellCommandType::Spawn:
+        {
+            AActor* Instigator = Command.Instigator.Get();
+            UWorld* World = Instigator ? Instigator->GetWorld() : nullptr;
+            UClass* ActorClass = Command.ActorClass.Get();
+            if (!World || !ActorClass)
+            {
+                break;
+            }
+
+            if (UGrimoireProjectilePoolSubsystem* ProjectilePool = World->GetSubsystem<UGrimoireProjectilePoolSubsystem>())
+            {
+                ProjectilePool->Acquire(ActorClass, Command.Vector, Command.Rotation, Command.Magnitude);
+            }
+            else if (AActor* Spawned = World->SpawnActor<AActor>(ActorClass, Command.Vector, Command.Rotation))
+            {
+                Spawned->SetLifeSpan(Command.Magnitude);
+            }
+            break;
+        }
+
+        case ESpellCommandType::ApplyStatus:
+            if (UGrimoireStatusSubsystem* StatusSubsystem = Target ? UWorld::GetSubsystem<UGrimoireStatusSubsystem>(Target->GetWorld()) : nullptr)
+            {
+                StatusSubsystem->ApplyStatus(Target, static_cast<EStatusEffectType>(Command.Subtype), Command.Magnitude, Command.Instigator.Get());
+                UE_LOG(LogTemp, Log, TEXT("Effect: Applied %s for %.2f seconds"),
+                    *UEnum::GetValueAsString(static_cast<EStatusEffectType>(Command.Subtype)), Command.Magnitude);
+            }
+            break;
+
+        case ESpellCommandType::Projectile:
+        {
+            AActor* Instigator = Command.Instigator.Get();
+            UWorld* World = Instigator ? Instigator->GetWorld() : nullptr;
+            if (UGrimoireProjectileSubsystem* Projectiles = World ? World->GetSubsystem<UGrimoireProjectileSubsystem>() : nullptr)
+            {
+                Projectiles->Launch(Command.Vector, Command.Velocity, static_cast<ESpellElement>(Command.Subtype), Command.Magnitude,
+                    Instigator, Command.Grimoire.Get(), Command.SpellName);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,375 @@
+#include "Spells/SpellCompiler.h"
+#include "Spells/SpellNode.h"
+#include "Spells/FlowNode.h"
+#include "Spells/ConditionNode.h"
+#include "Spells/TriggerNode.h"
+#include "Model/HeartGraph.h"
+
+namespace SpellCompiler
+{
+    static ESpellOpCode GetOpCode(const USpellNode* Node)
+    {
+        if (const UFlowNode* FlowNode = Cast<UFlowNode>(Node))
+        {
+            switch (FlowNode->FlowType)
+            {
+                case EFlowNodeType::Sequence:  return ESpellOpCode::Sequence;
+                case EFlowNodeType::Loop:      return ESpellOpCode::Loop;
+                case EFlowNodeType::WhileLoop: return ESpellOpCode::WhileLoop;
+                case EFlowNodeType::ForLoop:   return ESpellOpCode::ForLoop;
+                case EFlowNodeType::Delay:     return ESpellOpCode::Delay;
+                case EFlowNodeType::Parallel:  return ESpellOpCode::Parallel;
+                case EFlowNodeType::Branch:    return ESpellOpCode::Branch;
+                case EFlowNodeType::Gate:      return ESpellOpCode::Gate;
+                default:                       return ESpellOpCode::Sequence;
+            }
+        }
+
+        if (Cast<UConditionNode>(Node))
+        {
+            return ESpellOpCode::Condition;
+        }
+
+        if (const UTriggerNode* TriggerNode = Cast<UTriggerNode>(Node))
+        {
+            if (TriggerNode->EventType == ETriggerEventType::OnTimer && TriggerNode->TimerInterval > 0.0f)
+            {
+                return ESpellOpCode::Trigger;
+            }
+        }
+
+        return ESpellOpCode::Action;
+    }
+
+    // Output pins feeding each exit, per opcode
+    static void GetExitPins(ESpellOpCode OpCode, TArray<ESpellPin, TInlineAllocator<3>>& OutExit0, TArray<ESpellPin, TInlineAllocator<3>>& OutExit1)
+    {
+        switch (OpCode)
+        {
+            case ESpellOpCode::Action:
+            case ESpellOpCode::Trigger:
+                OutExit0 = { ESpellPin::ExecOut };
+                break;
+            case ESpellOpCode::Sequence:
+            case ESpellOpCode::Delay:
+                OutExit0 = { ESpellPin::Next, ESpellPin::ExecOut };
+                break;
+            case ESpellOpCode::Loop:
+                // Only the plain loop runs its completion pin
+                OutExit0 = { ESpellPin::LoopBody };
+                OutExit1 = { ESpellPin::OnComplete };
+                break;
+            case ESpellOpCode::WhileLoop:
+            case ESpellOpCode::ForLoop:
+                OutExit0 = { ESpellPin::LoopBody };
+                break;
+            case ESpellOpCode::Parallel:
+                OutExit0 = { ESpellPin::Branch1, ESpellPin::Branch2, ESpellPin::Branch3 };
+                OutExit1 = { ESpellPin::OnAllComplete };
+                break;
+            case ESpellOpCode::Branch:
+            case ESpellOpCode::Condition:
+                OutExit0 = { ESpellPin::True };
+                OutExit1 = { ESpellPin::False };
+                break;
+            case ESpellOpCode::Gate:
+                OutExit0 = { ESpellPin::Open };
+                OutExit1 = { ESpellPin::Closed };
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+FSpellCompiler::FSpellCompiler(const FSpellGraphIndex& InIndex, FCompiledSpell& InProgram)
+    : GraphIndex(InIndex)
+    , Program(InProgram)
+{
+    NodeToInstruction.Init(FSpellGraphIndex::InvalidNodeIndex, GraphIndex.Num());
+}
+
+TSharedPtr<FCompiledSpell> FSpellCompiler::Compile(UHeartGraph* Graph, USpellNode* EntryNode)
+{
+    if (!Graph || !EntryNode)
+    {
+        return nullptr;
+    }
+
+    TSharedRef<const FSpellGraphIndex> SharedIndex = FSpellGraphIndex::Get(Graph);
+    const uint16 EntryIndex = SharedIndex->GetNodeIndex(EntryNode);
+    if (EntryIndex == FSpellGraphIndex::InvalidNodeIndex)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Entry node %s is not part of spell graph %s"), *EntryNode->GetName(), *Graph->GetName());
+        return nullptr;
+    }
+
+    // A single OnCast entry
+    int32 EntryNodeOffsets[FSpellGraphIndex::EntryKindCount + 1];
+    EntryNodeOffsets[0] = 0;
+    for (int32 KindIndex = 1; KindIndex <= FSpellGraphIndex::EntryKindCount; ++KindIndex)
+    {
+        EntryNodeOffsets[KindIndex] = 1;
+    }
+
+    return Compile(Graph, SharedIndex, MakeArrayView(&EntryIndex, 1), EntryNodeOffsets);
+}
+
+TSharedPtr<FCompiledSpell> FSpellCompiler::Compile(UHeartGraph* Graph)
+{
+    if (!Graph)
+    {
+        return nullptr;
+    }
+
+    TSharedRef<const FSpellGraphIndex> SharedIndex = FSpellGraphIndex::Get(Graph);
+
+    TArray<uint16, TInlineAllocator<8>> EntryNodes;
+    int32 EntryNodeOffsets[FSpellGraphIndex::EntryKindCount + 1];
+    for (int32 KindIndex = 0; KindIndex < FSpellGraphIndex::EntryKindCount; ++KindIndex)
+    {
+        EntryNodeOffsets[KindIndex] = EntryNodes.Num();
+        EntryNodes.Append(SharedIndex->GetEntryPoints(static_cast<ETriggerEventType>(KindIndex)));
+    }
+    EntryNodeOffsets[FSpellGraphIndex::EntryKindCount] = EntryNodes.Num();
+
+    if (EntryNodes.Num() == 0)
+    {
+        return nullptr;
+    }
+
+    return Compile(Graph, SharedIndex, EntryNodes, EntryNodeOffsets);
+}
+
+TSharedPtr<FCompiledSpell> FSpellCompiler::Compile(const UHeartGraph* Graph, const TSharedRef<const FSpellGraphIndex>& SharedIndex,
+    TConstArrayView<uint16> EntryNodes, const int32* EntryNodeOffsets)
+{
+    TSharedPtr<FCompiledSpell> NewProgram = MakeShared<FCompiledSpell>();
+    NewProgram->SourceIndex = SharedIndex;
+    FSpellCompiler Compiler(*SharedIndex, *NewProgram);
+
+    // Depth-first walk with an explicit stack so instruction order follows execution order.
+    // Entries are pushed in reverse so the first one is emitted first.
+    TArray<uint16> PendingNodes;
+    for (int32 Index = EntryNodes.Num() - 1; Index >= 0; --Index)
+    {
+        PendingNodes.Add(EntryNodes[Index]);
+    }
+
+    TArray<ESpellPin, TInlineAllocator<3>> Exit0;
+    TArray<ESpellPin, TInlineAllocator<3>> Exit1;
+    TArray<uint16, TInlineAllocator<8>> Successors;
+
+    while (PendingNodes.Num() > 0 && !Compiler.bOverflow)
+    {
+        const uint16 NodeIndex = PendingNodes.Pop(EAllowShrinking::No);
+        if (Compiler.NodeToInstruction[NodeIndex] != FSpellGraphIndex::InvalidNodeIndex || !IsValid(SharedIndex->GetNode(NodeIndex)))
+        {
+            continue;
+        }
+
+        const uint16 InstructionIndex = Compiler.EmitNode(NodeIndex);
+
+        Exit0.Reset();
+        Exit1.Reset();
+        SpellCompiler::GetExitPins(NewProgram->Instructions[InstructionIndex].OpCode, Exit0, Exit1);
+
+        Successors.Reset();
+        for (ESpellPin Pin : Exit0)
+        {
+            Successors.Append(SharedIndex->GetSuccessors(NodeIndex, Pin));
+        }
+        for (ESpellPin Pin : Exit1)
+        {
+            Successors.Append(SharedIndex->GetSuccessors(NodeIndex, Pin));
+        }
+
+        // Push in reverse so the first successor is emitted next
+        for (int32 Index = Successors.Num() - 1; Index >= 0; --Index)
+        {
+            PendingNodes.Add(Successors[Index]);
+        }
+    }
+
+    for (int32 Index = 0; Index < NewProgram->Instructions.Num() && !Compiler.bOverflow; ++Index)
+    {
+        Compiler.LinkExits(static_cast<uint16>(Index));
+    }
+
+    if (Compiler.bOverflow)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Spell graph %s is too large to compile"), *Graph->GetName());
+        return nullptr;
+    }
+
+    // Map entry nodes to their instructions, dropping any that were not emitted
+    for (int32 KindIndex = 0; KindIndex < FSpellGraphIndex::EntryKindCount; ++KindIndex)
+    {
+        NewProgram->EntryOffsets[KindIndex] = NewProgram->EntryPoints.Num();
+        for (int32 Index = EntryNodeOffsets[KindIndex]; Index < EntryNodeOffsets[KindIndex + 1]; ++Index)
+        {
+            const uint16 Instruction = Compiler.NodeToInstruction[EntryNodes[Index]];
+            if (Instruction != FSpellGraphIndex::InvalidNodeIndex)
+            {
+                NewProgram->EntryPoints.Add(Instruction);
+            }
+        }
+    }
+    NewProgram->EntryOffsets[FSpellGraphIndex::EntryKindCount] = NewProgram->EntryPoints.Num();
+
+    if (NewProgram->IsEmpty())
+    {
+        return nullptr;
+    }
+
+    const TConstArrayView<uint16> CastEntries = NewProgram->GetEntryPoints(ETriggerEventType::OnCast);
+    NewProgram->EntryPoint = CastEntries.Num() > 0 ? CastEntries[0] : NewProgram->EntryPoints[0];
+    NewProgram->MaxDepth = NewProgram->ComputeMaxDepth();
+
+    for (const USpellNode* Node : NewProgram->Nodes)
+    {
+        NewProgram->Rarity = FMath::Max(NewProgram->Rarity, Node->NodeRarity);
+    }
+    return NewProgram;
+}
+
+uint16 FSpellCompiler::EmitNode(uint16 NodeIndex)
+{
+    if (Program.Instructions.Num() >= MAX_uint16)
+    {
+        bOverflow = true;
+        return 0;
+    }
+
+    USpellNode* Node = GraphIndex.GetNode(NodeIndex);
+    const uint16 InstructionIndex = static_cast<uint16>(Program.Instructions.Num());
+
+    FSpellInstruction& Instruction = Program.Instructions.AddDefaulted_GetRef();
+    Instruction.OpCode = SpellCompiler::GetOpCode(Node);
+    Instruction.NodeIndex = static_cast<uint16>(Program.Nodes.Add(Node));
+
+    NodeToInstruction[NodeIndex] = InstructionIndex;
+    InstructionToNode.Add(NodeIndex);
+    return InstructionIndex;
+}
+
+void FSpellCompiler::LinkExits(uint16 InstructionIndex)
+{
+    const uint16 NodeIndex = InstructionToNode[InstructionIndex];
+
+    TArray<ESpellPin, TInlineAllocator<3>> Exit0;
+    TArray<ESpellPin, TInlineAllocator<3>> Exit1;
+    SpellCompiler::GetExitPins(Program.Instructions[InstructionIndex].OpCode, Exit0, Exit1);
+
+    const FSpellExitRange Range0 = EmitExit(Exit0, NodeIndex);
+    const FSpellExitRange Range1 = EmitExit(Exit1, NodeIndex);
+
+    FSpellInstruction& Instruction = Program.Instructions[InstructionIndex];
+    Instruction.Exits[0] = Range0;
+    Instruction.Exits[1] = Range1;
+}
+
+FSpellExitRange FSpellCompiler::EmitExit(TConstArrayView<ESpellPin> Pins, uint16 NodeIndex)
+{
+    FSpellExitRange Range;
+    Range.Start = static_cast<uint16>(Program.Successors.Num());
+
+    for (ESpellPin Pin : Pins)
+    {
+        for (uint16 SuccessorIndex : GraphIndex.GetSuccessors(NodeIndex, Pin))
+        {
+            const uint16 Target = NodeToInstruction[SuccessorIndex];
+            if (Target == FSpellGraphIndex::InvalidNodeIndex)
+            {
+                continue;
+            }
+
+            if (Program.Successors.Num() >= MAX_uint16)
+            {
+                bOverflow = true;
+                return Range;
+            }
+
+            Program.Successors.Add(Target);
+            ++Range.Num;
+        }
+    }
+
+    return Range;
+}
+
+uint16 FCompiledSpell::ComputeMaxDepth() const
+{
+    // Longest chain of frames from any entry point, found with an explicit post-order walk
+    enum EVisitState : uint8 { Unvisited, Active, Done };
+
+    struct FVisit
+    {
+        uint16 Instruction;
+        uint16 NextSuccessor;
+    };
+
+    const auto GetSuccessor = [this](const FSpellInstruction& Instruction, int32 Index)
+    {
+        const FSpellExitRange& Exit0 = Instruction.Exits[0];
+        return Index < Exit0.Num
+            ? Successors[Exit0.Start + Index]
+            : Successors[Instruction.Exits[1].Start + Index - Exit0.Num];
+    };
+
+    TArray<uint8> State;
+    State.Init(Unvisited, Instructions.Num());
+    TArray<uint16> Depth;
+    Depth.Init(0, Instructions.Num());
+
+    TArray<FVisit> Stack;
+    uint16 ProgramDepth = 0;
+
+    // Each entry point is a separate root; instructions are shared, so each is walked once
+    for (uint16 Entry : EntryPoints)
+    {
+        if (State[Entry] != Unvisited)
+        {
+            continue;
+        }
+
+        Stack.Add({ Entry, 0 });
+        State[Entry] = Active;
+
+        while (Stack.Num() > 0)
+        {
+            FVisit& Visit = Stack.Last();
+            const FSpellInstruction& Instruction = Instructions[Visit.Instruction];
+            const int32 NumSuccessors = Instruction.Exits[0].Num + Instruction.Exits[1].Num;
+
+            if (Visit.NextSuccessor < NumSuccessors)
+            {
+                const uint16 Target = GetSuccessor(Instruction, Visit.NextSuccessor++);
+                if (State[Target] == Active)
+                {
+                    return DepthLimit;
+                }
+                if (State[Target] == Unvisited)
+                {
+                    State[Target] = Active;
+                    Stack.Add({ Target, 0 });
+                }
+                continue;
+            }
+
+            uint16 Deepest = 0;
+            for (int32 Index = 0; Index < NumSuccessors; ++Index)
+            {
+                Deepest = FMath::Max(Deepest, Depth[GetSuccessor(Instruction, Index)]);
+            }
+
+            Depth[Visit.Instruction] = static_cast<uint16>(FMath::Min<int32>(Deepest + 1, DepthLimit));
+            State[Visit.Instruction] = Done;
+            Stack.Pop(EAllowShrinking::No);
+        }
+
+        ProgramDepth = FMath::Max(ProgramDepth, Depth[Entry]);
+    }
+
+    return ProgramDepth;
+}
@@ -0,0 +1,211 @@
+#include "Spells/SpellCostAnalyzer.h"
+#include "Spells/SpellNode.h"
+#include "Spells/FlowNode.h"
+#include "Spells/ConditionNode.h"
+#include "Spells/TriggerNode.h"
+#include "GrimoireSettings.h"
+
+namespace SpellCostAnalyzer
+{
+    static int64 SaturatingAdd(int64 A, int64 B)
+    {
+        return A > FSpellCost::Unbounded - B ? FSpellCost::Unbounded : A + B;
+    }
+
+    static int64 SaturatingMultiply(int64 A, int64 B)
+    {
+        return B != 0 && A > FSpellCost::Unbounded / B ? FSpellCost::Unbounded : A * B;
+    }
+
+    // Adds Times runs of From to Into
+    static void Accumulate(FSpellCost& Into, const FSpellCost& From, int64 Times)
+    {
+        Into.NodeExecutions = SaturatingAdd(Into.NodeExecutions, SaturatingMultiply(From.NodeExecutions, Times));
+        Into.Forks = SaturatingAdd(Into.Forks, SaturatingMultiply(From.Forks, Times));
+        Into.SideEffects = SaturatingAdd(Into.SideEffects, SaturatingMultiply(From.SideEffects, Times));
+    }
+}
+
+FSpellCost FSpellCostAnalyzer::Analyze(const FCompiledSpell& Spell)
+{
+    FSpellCost Total;
+    Total.Rarity = Spell.Rarity;
+
+    const int32 NumInstructions = Spell.Instructions.Num();
+    if (NumInstructions == 0)
+    {
+        return Total;
+    }
+
+    // Nodes we cannot see into count as acting on the world and as overriding loop counts
+    TBitArray<> SideEffects(false, NumInstructions);
+    bool bCountCanChange = !Spell.SourceIndex.IsValid();
+    if (Spell.SourceIndex.IsValid())
+    {
+        const FSpellRegisterLayout& Layout = *Spell.SourceIndex->GetRegisterLayout();
+        const int32 CountSlot = static_cast<int32>(ESpellRegister::IterationCount);
+        for (int32 Index = 0; Index < NumInstructions; ++Index)
+        {
+            const USpellNode* Node = Spell.Nodes[Spell.Instructions[Index].NodeIndex];
+            FSpellRegisterAccess Access;
+            const bool bKnown = IsValid(Node) && Node->GetRegisterAccess(Layout, Access);
+            SideEffects[Index] = !bKnown || Access.bHasSideEffects;
+            bCountCanChange |= !bKnown || (CountSlot < Access.Writes.Num() && Access.Writes[CountSlot]);
+        }
+    }
+    else
+    {
+        SideEffects.Init(true, NumInstructions);
+    }
+
+    // Post-order walk like FCompiledSpell::ComputeMaxDepth, summing successor costs instead of depths
+    enum EVisitState : uint8 { Unvisited, Active, Done };
+
+    struct FVisit
+    {
+        uint16 Instruction;
+        uint16 NextSuccessor;
+    };
+
+    const auto GetSuccessor = [&Spell](const FSpellInstruction& Instruction, int32 Index)
+    {
+        const FSpellExitRange& Exit0 = Instruction.Exits[0];
+        return Index < Exit0.Num
+            ? Spell.Successors[Exit0.Start + Index]
+            : Spell.Successors[Instruction.Exits[1].Start + Index - Exit0.Num];
+    };
+
+    TArray<uint8> State;
+    State.Init(Unvisited, NumInstructions);
+    TArray<FSpellCost> Costs;
+    Costs.SetNum(NumInstructions);
+    TArray<FVisit> Stack;
+
+    for (uint16 Entry : Spell.EntryPoints)
+    {
+        if (State[Entry] == Unvisited)
+        {
+            Stack.Add({ Entry, 0 });
+            State[Entry] = Active;
+        }
+
+        while (Stack.Num() > 0)
+        {
+            FVisit& Visit = Stack.Last();
+            const FSpellInstruction& Instruction = Spell.Instructions[Visit.Instruction];
+            const int32 NumSuccessors = Instruction.Exits[0].Num + Instruction.Exits[1].Num;
+
+            if (Visit.NextSuccessor < NumSuccessors)
+            {
+                const uint16 Target = GetSuccessor(Instruction, Visit.NextSuccessor++);
+                if (State[Target] == Active)
+                {
+                    Total.bHasCycle = true;
+                    Total.NodeExecutions = Total.Forks = Total.SideEffects = FSpellCost::Unbounded;
+                    return Total;
+                }
+                if (State[Target] == Unvisited)
+                {
+                    State[Target] = Active;
+                    Stack.Add({ Target, 0 });
+                }
+                continue;
+            }
+
+            const USpellNode* Node = Spell.Nodes[Instruction.NodeIndex];
+            FSpellCost& Cost = Costs[Visit.Instruction];
+            Cost.NodeExecutions = 1;
+            Cost.SideEffects = SideEffects[Visit.Instruction] ? 1 : 0;
+            Cost.Forks = GetForks(Instruction, Node);
+
+            // Unrolled loops already repeat their body in Exits[0]
+            const bool bLoop = Instruction.OpCode == ESpellOpCode::Loop || Instruction.OpCode == ESpellOpCode::WhileLoop || Instruction.OpCode == ESpellOpCode::ForLoop;
+            const int64 Iterations = bLoop ? GetIterationBound(Node, bCountCanChange)
+                : Instruction.OpCode == ESpellOpCode::Trigger ? GetFiringBound(Node)
+                : 1;
+
+            // Timer triggers run themselves again on every firing, not just their body
+            if (Instruction.OpCode == ESpellOpCode::Trigger)
+            {
+                Cost.NodeExecutions = Iterations;
+            }
+            for (int32 Index = 0; Index < NumSuccessors; ++Index)
+            {
+                SpellCostAnalyzer::Accumulate(Cost, Costs[GetSuccessor(Instruction, Index)], Index < Instruction.Exits[0].Num ? Iterations : 1);
+            }
+
+            State[Visit.Instruction] = Done;
+            Stack.Pop(EAllowShrinking::No);
+        }
+
+        SpellCostAnalyzer::Accumulate(Total, Costs[Entry], 1);
+    }
+
+    return Total;
+}
+
+int64 FSpellCostAnalyzer::GetIterationBound(const USpellNode* Node, bool bCountCanChange)
+{
+    const UFlowNode* FlowNode = Cast<UFlowNode>(Node);
+    if (!FlowNode)
+    {
+        return 0;
+    }
+
+    // An overridden count is still clamped to the rarity cap
+    const int32 Limit = bCountCanChange ? FlowNode->GetMaxIterationsByRarity() : FlowNode->GetIterationLimit(FlowNode->MaxIterations);
+    return FMath::Max(Limit, 0);
+}
+
+int64 FSpellCostAnalyzer::GetFiringBound(const USpellNode* Node)
+{
+    const UTriggerNode* TriggerNode = Cast<UTriggerNode>(Node);
+    return TriggerNode ? FMath::Max(TriggerNode->MaxFirings, 1) : 1;
+}
+
+int64 FSpellCostAnalyzer::GetForks(const FSpellInstruction& Instruction, const USpellNode* Node)
+{
+    switch (Instruction.OpCode)
+    {
+        case ESpellOpCode::Parallel:
+            return Instruction.Exits[0].Num;
+
+        case ESpellOpCode::Condition:
+        {
+            const UConditionNode* ConditionNode = Cast<UConditionNode>(Node);
+            return ConditionNode && ConditionNode->RunsBothBranches(true) ? 1 : 0;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+bool FSpellCostAnalyzer::IsWithinBudget(const FSpellCost& Cost, FString& OutReason)
+{
+    if (Cost.bHasCycle)
+    {
+        OutReason = TEXT("the graph has a cycle");
+        return false;
+    }
+
+    const FSpellCostBudget& Budget = GetDefault<UGrimoireSettings>()->GetCostBudget(Cost.Rarity);
+    const FString Tier = UEnum::GetDisplayValueAsText(Cost.Rarity).ToString();
+
+    if (Cost.NodeExecutions > Budget.MaxNodeExecutions)
+    {
+        OutReason = FString::Printf(TEXT("up to %lld node executions, %s budget is %d"), Cost.NodeExecutions, *Tier, Budget.MaxNodeExecutions);
+        return false;
+    }
+    if (Cost.Forks > Budget.MaxForks)
+    {
+        OutReason = FString::Printf(TEXT("up to %lld forked contexts, %s budget is %d"), Cost.Forks, *Tier, Budget.MaxForks);
+        return false;
+    }
+    if (Cost.SideEffects > Budget.MaxSideEffects)
+    {
+        OutReason = FString::Printf(TEXT("up to %lld side effects, %s budget is %d"), Cost.SideEffects, *Tier, Budget.MaxSideEffects);
+        return false;
+    }
+    return true;
+}
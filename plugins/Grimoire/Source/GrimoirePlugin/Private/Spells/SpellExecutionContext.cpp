@@ -1,104 +1,426 @@
-﻿// Source/GrimoirePlugin/Private/SpellExecutionContext.cpp
-#include "SpellExecutionContext.h"
+// Source/GrimoirePlugin/Private/SpellExecutionContext.cpp
+#include "Spells/SpellExecutionContext.h"
+#include "Components/GrimoireComponent.h"
+#include "Subsystems/GrimoireContextSubsystem.h"
 #include "Engine/World.h"
 
-// Variable value conversion helpers
-FVariableValue FVariableValue::FromFloat(float Value)
+const FSpellValue USpellExecutionContext::EmptyValue;
+
+USpellExecutionContext::USpellExecutionContext()
+    : Layout(FSpellRegisterLayout::GetDefault())
 {
-    FVariableValue Result;
-    Result.Type = EVariableType::Float;
-    Result.FloatValue = Value;
-    return Result;
 }
 
-FVariableValue FVariableValue::FromInt(int32 Value)
+void USpellExecutionContext::ResetForCast(FSpellCast* InCast)
 {
-    FVariableValue Result;
-    Result.Type = EVariableType::Int;
-    Result.IntValue = Value;
-    return Result;
+    Caster = nullptr;
+    Target = nullptr;
+    Grimoire.Reset();
+    SpellName = NAME_None;
+    TargetLocation = FVector::ZeroVector;
+    HitResult = FHitResult();
+    ExecutionTime = 0.0f;
+    ExecutionDepth = 0;
+    SpellPower = 1.0f;
+    ManaCost = 0.0f;
+
+    Layout = FSpellRegisterLayout::GetDefault();
+    LocalRegisters = TArrayView<FSpellValue>();
+    GlobalRegisters = TArrayView<FSpellValue>();
+    LocalVariables.Reset();
+    GlobalVariables.Reset();
+
+    Parent = nullptr;
+    GlobalWritten = TArrayView<bool>();
+    FirstForked = nullptr;
+    LastForked = nullptr;
+    NextForked = nullptr;
+
+    Cast = InCast;
+    OwnedCast.Reset();
+    CommandBuffer = nullptr;
+    NextPooled = nullptr;
 }
 
-FVariableValue FVariableValue::FromBool(bool Value)
+void USpellExecutionContext::RetainCast()
 {
-    FVariableValue Result;
-    Result.Type = EVariableType::Bool;
-    Result.BoolValue = Value;
-    return Result;
+    ++GetMeteredCast().RefCount;
 }
 
-FVariableValue FVariableValue::FromString(const FString& Value)
+void USpellExecutionContext::ReleaseCast()
 {
-    FVariableValue Result;
-    Result.Type = EVariableType::String;
-    Result.StringValue = Value;
-    return Result;
+    // Counted on the root's cast, which children outside a pool do not share
+    FSpellCast& RootCast = GetMeteredCast();
+    check(RootCast.RefCount > 0);
+    if (--RootCast.RefCount > 0)
+    {
+        return;
+    }
+
+    if (RootCast.OnFinished)
+    {
+        const TFunction<void(const FSpellCast&)> OnFinished = MoveTemp(RootCast.OnFinished);
+        RootCast.OnFinished = nullptr;
+        OnFinished(RootCast);
+    }
+
+    if (RootCast.Pool)
+    {
+        RootCast.Pool->RecycleCast(RootCast);
+    }
 }
 
-FVariableValue FVariableValue::FromVector(const FVector& Value)
+void USpellExecutionContext::SetOnCastFinished(TFunction<void(const FSpellCast&)>&& Callback)
 {
-    FVariableValue Result;
-    Result.Type = EVariableType::Vector;
-    Result.VectorValue = Value;
-    return Result;
+    GetMeteredCast().OnFinished = MoveTemp(Callback);
 }
 
-FVariableValue FVariableValue::FromActor(AActor* Value)
+FSpellCast& USpellExecutionContext::GetCast()
 {
-    FVariableValue Result;
-    Result.Type = EVariableType::Object;
-    Result.ObjectValue = Value;
-    return Result;
+    if (!Cast)
+    {
+        // Held by whoever created this context until it calls ReleaseCast
+        OwnedCast = MakeUnique<FSpellCast>();
+        OwnedCast->RefCount = 1;
+        Cast = OwnedCast.Get();
+    }
+    return *Cast;
 }
 
-// Context implementation
-void USpellExecutionContext::SetVariable(FName Name, const FVariableValue& Value, bool bGlobal)
+FSpellCast& USpellExecutionContext::GetMeteredCast()
 {
-    if (bGlobal)
+    USpellExecutionContext* Root = this;
+    while (Root->Parent)
     {
-        GlobalVariables.Add(Name, Value);
+        Root = Root->Parent;
     }
-    else
+    return Root->GetCast();
+}
+
+const FSpellCast* USpellExecutionContext::FindMeteredCast() const
+{
+    const USpellExecutionContext* Root = this;
+    while (Root->Parent)
     {
-        LocalVariables.Add(Name, Value);
+        Root = Root->Parent;
     }
+    return Root->Cast;
 }
 
-FVariableValue USpellExecutionContext::GetVariable(FName Name, bool bGlobal) const
+void USpellExecutionContext::SetFuelBudget(int32 Budget)
 {
-    const FVariableValue* Value = nullptr;
-    
-    if (bGlobal)
+    GetMeteredCast().FuelBudget = FMath::Max(Budget, 0);
+}
+
+bool USpellExecutionContext::ConsumeFuel(int32 Amount)
+{
+    FSpellCast& MeteredCast = GetMeteredCast();
+    MeteredCast.FuelUsed += Amount;
+    return MeteredCast.FuelBudget == 0 || MeteredCast.FuelUsed <= MeteredCast.FuelBudget;
+}
+
+int32 USpellExecutionContext::GetFuelUsed() const
+{
+    const FSpellCast* MeteredCast = FindMeteredCast();
+    return MeteredCast ? MeteredCast->FuelUsed : 0;
+}
+
+int32 USpellExecutionContext::GetFuelRemaining() const
+{
+    const FSpellCast* MeteredCast = FindMeteredCast();
+    if (!MeteredCast || MeteredCast->FuelBudget == 0)
     {
-        Value = GlobalVariables.Find(Name);
+        return MAX_int32;
     }
-    else
+    return FMath::Max(MeteredCast->FuelBudget - MeteredCast->FuelUsed, 0);
+}
+
+bool USpellExecutionContext::IsOutOfFuel() const
+{
+    const FSpellCast* MeteredCast = FindMeteredCast();
+    return MeteredCast && MeteredCast->IsOutOfFuel();
+}
+
+FSpellCommandBuffer& USpellExecutionContext::GetCommandBuffer()
+{
+    for (USpellExecutionContext* Scope = this; Scope; Scope = Scope->Parent)
     {
-        Value = LocalVariables.Find(Name);
-        // Fall back to global if not found locally
-        if (!Value)
+        if (Scope->CommandBuffer)
         {
-            Value = GlobalVariables.Find(Name);
+            return *Scope->CommandBuffer;
         }
     }
-    
-    return Value ? *Value : FVariableValue();
+    return GetMeteredCast().Commands;
 }
 
-bool USpellExecutionContext::HasVariable(FName Name, bool bGlobal) const
+void USpellExecutionContext::ReserveRegisters()
 {
-    if (bGlobal)
+    if (LocalRegisters.Num() < Layout->Num())
+    {
+        GrowRegisters(LocalRegisters, Layout->Num());
+    }
+    if (GlobalRegisters.Num() < Layout->Num())
     {
-        return GlobalVariables.Contains(Name);
+        GrowRegisters(GlobalRegisters, Layout->Num());
+    }
+}
+
+void USpellExecutionContext::GrowRegisters(TArrayView<FSpellValue>& Registers, int32 MinNum)
+{
+    // The old storage stays in the arena until the cast is released
+    const int32 NewNum = FMath::Max(MinNum, Layout->Num());
+    TArrayView<FSpellValue> Grown = GetArena().AllocateArray<FSpellValue>(NewNum);
+    for (int32 Slot = 0; Slot < Registers.Num(); ++Slot)
+    {
+        Grown[Slot] = Registers[Slot];
+    }
+
+    if (Parent && &Registers == &GlobalRegisters)
+    {
+        TArrayView<bool> GrownWritten = GetArena().AllocateArray<bool>(NewNum);
+        for (int32 Slot = 0; Slot < GlobalWritten.Num(); ++Slot)
+        {
+            GrownWritten[Slot] = GlobalWritten[Slot];
+        }
+        GlobalWritten = GrownWritten;
+    }
+
+    Registers = Grown;
+}
+
+const FSpellValue& USpellExecutionContext::FindScopedGlobal(int32 Slot) const
+{
+    // A scope chain shares one layout (see BindRegisterLayout), so Slot means the same thing at every level
+    const USpellExecutionContext* Scope = this;
+    while (Scope->Parent && !(Scope->GlobalWritten.IsValidIndex(Slot) && Scope->GlobalWritten[Slot]))
+    {
+        Scope = Scope->Parent;
+    }
+    return Scope->GlobalRegisters.IsValidIndex(Slot) ? Scope->GlobalRegisters[Slot] : EmptyValue;
+}
+
+const FSpellValue* USpellExecutionContext::FindScopedVariable(FName Name) const
+{
+    for (const USpellExecutionContext* Scope = this; Scope; Scope = Scope->Parent)
+    {
+        if (const FSpellValue* Value = Scope->GlobalVariables.Find(Name))
+        {
+            return Value->IsSet() ? Value : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+bool USpellExecutionContext::IsGlobalWritten(int32 Slot) const
+{
+    if (Parent)
+    {
+        return GlobalWritten.IsValidIndex(Slot) && GlobalWritten[Slot];
+    }
+    return GlobalRegisters.IsValidIndex(Slot) && GlobalRegisters[Slot].IsSet();
+}
+
+void USpellExecutionContext::Initialize(AActor* InCaster, UGrimoireComponent* InGrimoire)
+{
+    Caster = InCaster;
+    Grimoire = InGrimoire;
+
+    UWorld* World = GetWorld();
+    ExecutionTime = World ? World->GetTimeSeconds() : 0.0f;
+}
+
+void USpellExecutionContext::SetTarget(AActor* InTarget)
+{
+    Target = InTarget;
+    if (Target)
+    {
+        TargetLocation = Target->GetActorLocation();
+    }
+}
+
+void USpellExecutionContext::SetTargetLocation(const FVector& InLocation)
+{
+    TargetLocation = InLocation;
+}
+
+UWorld* USpellExecutionContext::GetWorld() const
+{
+    if (Caster)
+    {
+        return Caster->GetWorld();
+    }
+
+    const UObject* Outer = GetOuter();
+    return Outer && !HasAnyFlags(RF_ClassDefaultObject) ? Outer->GetWorld() : nullptr;
+}
+
+void USpellExecutionContext::BindRegisterLayout(const TSharedRef<const FSpellRegisterLayout>& InLayout)
+{
+    if (Layout == InLayout)
+    {
+        return;
+    }
+
+    // Every layout starts with the built-in registers, so those slots carry over as-is.
+    // Slots past the built-ins belonged to the old layout and are re-homed by name.
+    const auto Rebind = [this, &InLayout](TArrayView<FSpellValue>& Registers, TMap<FName, FSpellValue>& Overflow)
+    {
+        if (Registers.Num() == 0 && Overflow.Num() == 0)
+        {
+            // Nothing to carry over; storage is allocated on first write
+            return;
+        }
+
+        TArrayView<FSpellValue> Rebound = GetArena().AllocateArray<FSpellValue>(InLayout->Num());
+        for (int32 Slot = 0; Slot < Registers.Num(); ++Slot)
+        {
+            if (Slot < FSpellRegisterLayout::BuiltinCount)
+            {
+                Rebound[Slot] = Registers[Slot];
+            }
+            else if (Registers[Slot].IsSet())
+            {
+                Overflow.Add(Layout->GetSlotName(Slot), Registers[Slot]);
+            }
+        }
+        Registers = Rebound;
+
+        for (auto It = Overflow.CreateIterator(); It; ++It)
+        {
+            const int32 Slot = InLayout->FindSlot(It.Key());
+            if (Slot != FSpellRegisterLayout::InvalidSlot)
+            {
+                Registers[Slot] = It.Value();
+                It.RemoveCurrent();
+            }
+        }
+    };
+
+    Rebind(LocalRegisters, LocalVariables);
+
+    if (Parent)
+    {
+        // A child leaving its parent's layout can no longer defer slot reads upwards,
+        // so it takes its own copy of every global visible through the chain
+        const int32 NumSlots = InLayout->Num();
+        TArrayView<FSpellValue> Rebound = GetArena().AllocateArray<FSpellValue>(NumSlots);
+        TArrayView<bool> Written = GetArena().AllocateArray<bool>(NumSlots);
+        for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+        {
+            const FName Name = InLayout->GetSlotName(Slot);
+            const int32 OldSlot = Slot < FSpellRegisterLayout::BuiltinCount ? Slot : Layout->FindSlot(Name);
+            if (OldSlot != FSpellRegisterLayout::InvalidSlot)
+            {
+                Rebound[Slot] = GetRegister(OldSlot, true);
+            }
+            else if (const FSpellValue* Value = FindScopedVariable(Name))
+            {
+                Rebound[Slot] = *Value;
+            }
+            GlobalVariables.Remove(Name);
+            Written[Slot] = true;
+        }
+
+        // Written slots with no home in the new layout become named variables
+        for (int32 Slot = FSpellRegisterLayout::BuiltinCount; Slot < GlobalRegisters.Num(); ++Slot)
+        {
+            const FName Name = Layout->GetSlotName(Slot);
+            if (GlobalWritten[Slot] && InLayout->FindSlot(Name) == FSpellRegisterLayout::InvalidSlot)
+            {
+                GlobalVariables.Add(Name, GlobalRegisters[Slot]);
+            }
+        }
+
+        GlobalRegisters = Rebound;
+        GlobalWritten = Written;
+    }
+    else
+    {
+        Rebind(GlobalRegisters, GlobalVariables);
+    }
+
+    Layout = InLayout;
+}
+
+void USpellExecutionContext::SetVariable(FName Name, const FGWTVariableValue& InValue, bool bGlobal)
+{
+    const FSpellValue Value(InValue);
+    const int32 Slot = Layout->FindSlot(Name);
+    if (Slot != FSpellRegisterLayout::InvalidSlot)
+    {
+        SetRegister(Slot, Value, bGlobal);
+    }
+    else if (bGlobal)
+    {
+        GlobalVariables.Add(Name, Value);
     }
     else
     {
-        return LocalVariables.Contains(Name) || GlobalVariables.Contains(Name);
+        LocalVariables.Add(Name, Value);
     }
 }
 
+FGWTVariableValue USpellExecutionContext::GetVariable(FName Name, bool bGlobal) const
+{
+    const int32 Slot = Layout->FindSlot(Name);
+    if (Slot != FSpellRegisterLayout::InvalidSlot)
+    {
+        return GetRegister(Slot, bGlobal).ToVariableValue();
+    }
+
+    const FSpellValue* Value = bGlobal ? nullptr : LocalVariables.Find(Name);
+    if (!Value)
+    {
+        // Fall back to global if not found locally
+        Value = FindScopedVariable(Name);
+    }
+
+    return Value ? Value->ToVariableValue() : FGWTVariableValue();
+}
+
+bool USpellExecutionContext::HasVariable(FName Name, bool bGlobal) const
+{
+    const int32 Slot = Layout->FindSlot(Name);
+    if (Slot != FSpellRegisterLayout::InvalidSlot)
+    {
+        return HasRegister(Slot, bGlobal);
+    }
+
+    return (!bGlobal && LocalVariables.Contains(Name)) || FindScopedVariable(Name) != nullptr;
+}
+
 void USpellExecutionContext::ClearVariables(bool bGlobal)
 {
+    if (bGlobal && Parent)
+    {
+        // Shadow everything visible from the enclosing scopes
+        if (GlobalRegisters.Num() < Layout->Num())
+        {
+            GrowRegisters(GlobalRegisters, Layout->Num());
+        }
+        for (int32 Slot = 0; Slot < GlobalRegisters.Num(); ++Slot)
+        {
+            GlobalRegisters[Slot] = FSpellValue();
+            GlobalWritten[Slot] = true;
+        }
+
+        GlobalVariables.Empty();
+        for (const USpellExecutionContext* Scope = Parent; Scope; Scope = Scope->Parent)
+        {
+            for (const TPair<FName, FSpellValue>& Pair : Scope->GlobalVariables)
+            {
+                GlobalVariables.Add(Pair.Key, FSpellValue());
+            }
+        }
+        return;
+    }
+
+    TArrayView<FSpellValue> Registers = bGlobal ? GlobalRegisters : LocalRegisters;
+    for (FSpellValue& Register : Registers)
+    {
+        Register = FSpellValue();
+    }
+
     if (bGlobal)
     {
         GlobalVariables.Empty();
@@ -111,29 +433,124 @@ void USpellExecutionContext::ClearVariables(bool bGlobal)
 
 USpellExecutionContext* USpellExecutionContext::CreateChildContext() const
 {
-    USpellExecutionContext* ChildContext = NewObject<USpellExecutionContext>();
+    // Pooled casts hand out children from the same pool, released together with the root
+    USpellExecutionContext* ChildContext = Cast && Cast->Pool
+        ? Cast->Pool->AcquireContext(*Cast)
+        : NewObject<USpellExecutionContext>(GetOuter());
     ChildContext->Caster = Caster;
     ChildContext->Target = Target;
+    ChildContext->Grimoire = Grimoire;
+    ChildContext->SpellName = SpellName;
     ChildContext->TargetLocation = TargetLocation;
     ChildContext->HitResult = HitResult;
-    ChildContext->GlobalVariables = GlobalVariables; // Copy global variables
     ChildContext->ExecutionTime = ExecutionTime;
     ChildContext->ExecutionDepth = ExecutionDepth + 1;
-    
+    ChildContext->SpellPower = SpellPower;
+
+    // Children share the parent's layout and read its globals through the scope chain until they write them
+    ChildContext->Layout = Layout;
+    ChildContext->Parent = const_cast<USpellExecutionContext*>(this);
+
+    return ChildContext;
+}
+
+USpellExecutionContext* USpellExecutionContext::ForkChildContext()
+{
+    USpellExecutionContext* ChildContext = CreateChildContext();
+    if (LastForked)
+    {
+        LastForked->NextForked = ChildContext;
+    }
+    else
+    {
+        FirstForked = ChildContext;
+    }
+    LastForked = ChildContext;
+
     return ChildContext;
 }
 
+void USpellExecutionContext::JoinChildContexts()
+{
+    USpellExecutionContext* ChildContext = FirstForked;
+    FirstForked = nullptr;
+    LastForked = nullptr;
+
+    while (ChildContext)
+    {
+        MergeChildContext(ChildContext);
+
+        USpellExecutionContext* Next = ChildContext->NextForked;
+        ChildContext->NextForked = nullptr;
+        ChildContext = Next;
+    }
+}
+
 void USpellExecutionContext::MergeChildContext(const USpellExecutionContext* ChildContext)
 {
-    // Merge global variables (child can modify globals)
-    GlobalVariables = ChildContext->GlobalVariables;
+    if (!ChildContext)
+    {
+        return;
+    }
+
+    // Apply only what the child wrote; anything it merely inherited is already ours.
+    // Removals are applied at the root and kept as markers while this context is itself a child.
+    const auto MergeNamed = [this](FName Name, const FSpellValue& Value)
+    {
+        const int32 Slot = Layout->FindSlot(Name);
+        if (Slot != FSpellRegisterLayout::InvalidSlot)
+        {
+            SetRegister(Slot, Value, true);
+        }
+        else if (Value.IsSet() || Parent)
+        {
+            GlobalVariables.Add(Name, Value);
+        }
+        else
+        {
+            GlobalVariables.Remove(Name);
+        }
+    };
+
+    const bool bSameLayout = ChildContext->Layout == Layout;
+    for (int32 Slot = 0; Slot < ChildContext->GlobalRegisters.Num(); ++Slot)
+    {
+        if (!ChildContext->IsGlobalWritten(Slot))
+        {
+            continue;
+        }
+
+        if (bSameLayout)
+        {
+            SetRegister(Slot, ChildContext->GlobalRegisters[Slot], true);
+        }
+        else
+        {
+            MergeNamed(ChildContext->Layout->GetSlotName(Slot), ChildContext->GlobalRegisters[Slot]);
+        }
+    }
+
+    for (const TPair<FName, FSpellValue>& Pair : ChildContext->GlobalVariables)
+    {
+        MergeNamed(Pair.Key, Pair.Value);
+    }
 }
 
 FString USpellExecutionContext::GetDebugString() const
 {
+    const auto CountSet = [](TConstArrayView<FSpellValue> Registers)
+    {
+        int32 Count = 0;
+        for (const FSpellValue& Register : Registers)
+        {
+            Count += Register.IsSet() ? 1 : 0;
+        }
+        return Count;
+    };
+
     return FString::Printf(TEXT("SpellContext [Caster: %s, Target: %s, Vars: %d local, %d global]"),
         Caster ? *Caster->GetName() : TEXT("None"),
         Target ? *Target->GetName() : TEXT("None"),
-        LocalVariables.Num(),
-        GlobalVariables.Num());
-}
\ No newline at end of file
+        CountSet(LocalRegisters) + LocalVariables.Num(),
+        CountSet(GlobalRegisters) + GlobalVariables.Num());
+}
@@ -0,0 +1,181 @@
+#include "Spells/SpellGraphIndex.h"
+#include "Spells/SpellNode.h"
+#include "Spells/TriggerNode.h"
+#include "Model/HeartGraph.h"
+
+TMap<FObjectKey, TSharedRef<FSpellGraphIndex>> FSpellGraphIndex::Cache;
+
+TSharedRef<const FSpellGraphIndex> FSpellGraphIndex::Get(const UHeartGraph* Graph)
+{
+    check(IsInGameThread());
+
+    if (const TSharedRef<FSpellGraphIndex>* Cached = Cache.Find(FObjectKey(Graph)))
+    {
+        return *Cached;
+    }
+
+    // Drop indices of graphs that have been garbage collected
+    for (auto It = Cache.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().ResolveObjectPtr())
+        {
+            It.Value()->bStale = true;
+            It.RemoveCurrent();
+        }
+    }
+
+    TSharedRef<FSpellGraphIndex> Index = MakeShared<FSpellGraphIndex>();
+    if (Graph)
+    {
+        Index->Build(Graph);
+        Cache.Add(FObjectKey(Graph), Index);
+    }
+    return Index;
+}
+
+void FSpellGraphIndex::Invalidate(const UHeartGraph* Graph)
+{
+    check(IsInGameThread());
+
+    const FObjectKey Key(Graph);
+    if (const TSharedRef<FSpellGraphIndex>* Cached = Cache.Find(Key))
+    {
+        // Holders of the old index notice on their next lookup
+        (*Cached)->bStale = true;
+        Cache.Remove(Key);
+    }
+}
+
+FName FSpellGraphIndex::GetPinName(ESpellPin Pin)
+{
+    static const FName PinNames[PinCount] =
+    {
+        TEXT("ExecOut"),
+        TEXT("Next"),
+        TEXT("LoopBody"),
+        TEXT("OnComplete"),
+        TEXT("Branch1"),
+        TEXT("Branch2"),
+        TEXT("Branch3"),
+        TEXT("OnAllComplete"),
+        TEXT("True"),
+        TEXT("False"),
+        TEXT("Open"),
+        TEXT("Closed"),
+    };
+    return Pin < ESpellPin::MAX ? PinNames[static_cast<int32>(Pin)] : NAME_None;
+}
+
+uint16 FSpellGraphIndex::GetNodeIndex(const USpellNode* Node) const
+{
+    if (Node && Nodes.IsValidIndex(Node->SpellGraphIndex) && Nodes[Node->SpellGraphIndex] == Node)
+    {
+        return Node->SpellGraphIndex;
+    }
+    return InvalidNodeIndex;
+}
+
+void FSpellGraphIndex::Build(const UHeartGraph* Graph)
+{
+    TArray<UHeartGraphNode*> AllNodes;
+    Graph->GetAllNodes(AllNodes);
+
+    for (UHeartGraphNode* Node : AllNodes)
+    {
+        USpellNode* SpellNode = Cast<USpellNode>(Node);
+        if (!SpellNode)
+        {
+            continue;
+        }
+
+        if (Nodes.Num() >= InvalidNodeIndex)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Spell graph %s has too many nodes to index"), *Graph->GetName());
+            break;
+        }
+
+        SpellNode->SpellGraphIndex = static_cast<uint16>(Nodes.Add(SpellNode));
+    }
+
+    for (USpellNode* Node : Nodes)
+    {
+        Node->ResolveRegisters(*RegisterLayout);
+    }
+
+    Offsets.Reserve(Nodes.Num() * PinCount + 1);
+    for (USpellNode* Node : Nodes)
+    {
+        for (int32 PinIndex = 0; PinIndex < PinCount; ++PinIndex)
+        {
+            Offsets.Add(SuccessorIndices.Num());
+
+            const FName PinName = GetPinName(static_cast<ESpellPin>(PinIndex));
+            TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(Node->GetNodeGuid(), PinName);
+            for (const FHeartGraphPinReference& Connection : Connections)
+            {
+                USpellNode* Target = Cast<USpellNode>(Graph->GetNode(Connection.NodeGuid));
+                const uint16 TargetIndex = GetNodeIndex(Target);
+                if (TargetIndex != InvalidNodeIndex)
+                {
+                    SuccessorIndices.Add(TargetIndex);
+                    SuccessorNodes.Add(Target);
+                }
+            }
+        }
+    }
+    Offsets.Add(SuccessorIndices.Num());
+
+    BuildEntryPoints();
+}
+
+void FSpellGraphIndex::BuildEntryPoints()
+{
+    TBitArray<> HasIncoming(false, Nodes.Num());
+    for (uint16 SuccessorIndex : SuccessorIndices)
+    {
+        HasIncoming[SuccessorIndex] = true;
+    }
+
+    const auto GetKind = [this](uint16 NodeIndex)
+    {
+        const UTriggerNode* TriggerNode = Cast<UTriggerNode>(Nodes[NodeIndex]);
+        return static_cast<int32>(TriggerNode ? TriggerNode->EventType : ETriggerEventType::OnCast);
+    };
+
+    // Counting sort by kind so each kind is one contiguous run
+    int32 Counts[EntryKindCount] = {};
+    for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+    {
+        if (!HasIncoming[NodeIndex])
+        {
+            ++Counts[GetKind(static_cast<uint16>(NodeIndex))];
+        }
+    }
+
+    for (int32 KindIndex = 0; KindIndex < EntryKindCount; ++KindIndex)
+    {
+        EntryOffsets[KindIndex + 1] = EntryOffsets[KindIndex] + Counts[KindIndex];
+    }
+
+    EntryPoints.SetNumUninitialized(EntryOffsets[EntryKindCount]);
+    int32 Cursor[EntryKindCount];
+    FMemory::Memcpy(Cursor, EntryOffsets, sizeof(Cursor));
+    for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+    {
+        if (!HasIncoming[NodeIndex])
+        {
+            EntryPoints[Cursor[GetKind(static_cast<uint16>(NodeIndex))]++] = static_cast<uint16>(NodeIndex);
+        }
+    }
+
+    // A graph that is one big cycle has no root; start it from its first node
+    if (EntryPoints.Num() == 0 && Nodes.Num() > 0)
+    {
+        EntryPoints.Add(0);
+        const int32 KindIndex = GetKind(0);
+        for (int32 Index = KindIndex + 1; Index <= EntryKindCount; ++Index)
+        {
+            EntryOffsets[Index] = 1;
+        }
+    }
+}
@@ -0,0 +1,802 @@
+#include "Spells/SpellInterpreter.h"
+#include "Spells/SpellNode.h"
+#include "Spells/FlowNode.h"
+#include "Spells/ConditionNode.h"
+#include "Spells/TriggerNode.h"
+#include "Spells/SpellExecutionContext.h"
+#include "Components/GrimoireComponent.h"
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
+#include "Subsystems/GrimoireExecutorSubsystem.h"
+#include "GrimoireSettings.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "Tasks/Task.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spell Fuel Burned"), STAT_GrimoireFuelBurned, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Casts Out Of Fuel"), STAT_GrimoireCastsOutOfFuel, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Concurrent Spell Branches"), STAT_GrimoireConcurrentBranches, STATGROUP_Grimoire);
+
+FSpellInterpreter::FSpellInterpreter(const TSharedRef<const FCompiledSpell>& InProgram, USpellExecutionContext* InRootContext)
+    : ProgramRef(InProgram)
+    , Program(*InProgram)
+    , RootContext(InRootContext)
+    , DepthLimit(InProgram->MaxDepth)
+{
+    Frames.Reserve(Program.MaxDepth);
+}
+
+void FSpellInterpreter::Execute(const TSharedRef<const FCompiledSpell>& Program, USpellExecutionContext* Context)
+{
+    Execute(Program, Context, Program->EntryPoint);
+}
+
+void FSpellInterpreter::ExecuteEntryPoints(const TSharedRef<const FCompiledSpell>& Program, USpellExecutionContext* Context, ETriggerEventType Kind)
+{
+    for (uint16 EntryInstruction : Program->GetEntryPoints(Kind))
+    {
+        Execute(Program, Context, EntryInstruction);
+    }
+}
+
+void FSpellInterpreter::Execute(const TSharedRef<const FCompiledSpell>& Program, USpellExecutionContext* Context, uint16 EntryInstruction)
+{
+    if (!Context || !Program->Instructions.IsValidIndex(EntryInstruction))
+    {
+        return;
+    }
+
+    // Node register slots were resolved against the graph's layout
+    if (Program->SourceIndex.IsValid())
+    {
+        Context->BindRegisterLayout(Program->SourceIndex->GetRegisterLayout());
+    }
+
+    // Runs on the stack; only a spell that suspends is moved to the heap
+    FSpellInterpreter Interpreter(Program, Context);
+    Interpreter.PushInstruction(EntryInstruction, Context);
+    Interpreter.Run();
+
+    // Sync point: the world sees what the run recorded
+    Context->GetCommandBuffer().Apply();
+
+    if (Interpreter.bSuspended)
+    {
+        Park(MakeShareable(new FSpellInterpreter(MoveTemp(Interpreter))));
+    }
+}
+
+void FSpellInterpreter::Run()
+{
+    UGrimoireExecutorSubsystem* Executor = GetExecutor();
+    const double StartTime = FPlatformTime::Seconds();
+    const double Deadline = Executor ? Executor->BeginSlice(StartTime) : 0.0;
+
+    while (Frames.Num() > 0 && !bSuspended)
+    {
+        Step(Frames.Num() - 1);
+
+        // Checked after the step so a slice always makes progress
+        if (Executor && Frames.Num() > 0 && !bSuspended && FPlatformTime::Seconds() >= Deadline)
+        {
+            bSuspended = true;
+            bYielded = true;
+        }
+    }
+
+    if (Executor)
+    {
+        Executor->EndSlice(StartTime);
+    }
+}
+
+UGrimoireExecutorSubsystem* FSpellInterpreter::GetExecutor() const
+{
+    // A concurrent branch has to finish before its Parallel can join, so it never yields
+    if (bTask)
+    {
+        return nullptr;
+    }
+
+    // Only pooled contexts can outlive the synchronous run, so only they can yield
+    const UWorld* World = RootContext->IsPooled() ? RootContext->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UGrimoireExecutorSubsystem>() : nullptr;
+}
+
+bool FSpellInterpreter::Suspend(float Seconds)
+{
+    // Only pooled contexts can outlive the synchronous run; anything else finishes the spell now
+    if (bTask)
+    {
+        return false;
+    }
+
+    const UWorld* World = RootContext->IsPooled() ? RootContext->GetWorld() : nullptr;
+    if (!World || !World->GetSubsystem<UGrimoireSchedulerSubsystem>())
+    {
+        return false;
+    }
+
+    ResumeDelay = Seconds;
+    bSuspended = true;
+    return true;
+}
+
+void FSpellInterpreter::Park(const TSharedRef<FSpellInterpreter>& Interpreter)
+{
+    UWorld* World = Interpreter->RootContext->GetWorld();
+    UGrimoireSchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UGrimoireSchedulerSubsystem>() : nullptr;
+    UGrimoireExecutorSubsystem* Executor = World ? World->GetSubsystem<UGrimoireExecutorSubsystem>() : nullptr;
+    if (Interpreter->bYielded ? !Executor : !Scheduler)
+    {
+        return;
+    }
+
+    // The frames reference contexts of this cast, so keep it out of the pool until the spell finishes
+    if (!Interpreter->bRetainedCast)
+    {
+        Interpreter->RootContext->RetainCast();
+        Interpreter->bRetainedCast = true;
+    }
+
+    // Out of frame budget rather than waiting, so carry on as soon as the executor has budget again
+    if (Interpreter->bYielded)
+    {
+        Executor->Enqueue(Interpreter, Interpreter->RootContext->Caster);
+        return;
+    }
+
+    // The scheduler owns the parked interpreter until it wakes
+    Scheduler->Schedule(Interpreter->ResumeDelay, FSimpleDelegate::CreateLambda([Interpreter]()
+    {
+        Interpreter->Resume();
+    }));
+}
+
+void FSpellInterpreter::Resume()
+{
+    bSuspended = false;
+    bYielded = false;
+
+    // Editing the graph invalidates the node pointers the frames were built from
+    if (Program.IsStale())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Spell graph changed while a cast was suspended, aborting the cast"));
+        Frames.Reset();
+    }
+
+    Run();
+    RootContext->GetCommandBuffer().Apply();
+
+    if (bSuspended)
+    {
+        Park(AsShared());
+    }
+    else if (bRetainedCast)
+    {
+        bRetainedCast = false;
+        RootContext->ReleaseCast();
+    }
+}
+
+void FSpellInterpreter::Step(int32 FrameIndex)
+{
+    const FSpellInstruction& Instruction = Program.Instructions[Frames[FrameIndex].Instruction];
+    USpellNode* Node = Program.Nodes[Instruction.NodeIndex];
+
+    // The node may have been destroyed while the spell was suspended
+    if (!IsValid(Node))
+    {
+        PopFrame();
+        return;
+    }
+
+    if (Frames[FrameIndex].Phase == 0 && !ChargeFuel(Frames[FrameIndex].Context, Node))
+    {
+        return;
+    }
+
+    switch (Instruction.OpCode)
+    {
+        case ESpellOpCode::Action:
+            StepAction(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Sequence:
+            StepSequence(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Loop:
+        case ESpellOpCode::WhileLoop:
+        case ESpellOpCode::ForLoop:
+            StepLoop(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Delay:
+            StepDelay(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Parallel:
+            StepParallel(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Branch:
+        case ESpellOpCode::Gate:
+            StepBranch(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Condition:
+            StepCondition(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Trigger:
+            StepTrigger(FrameIndex, Node);
+            break;
+
+        case ESpellOpCode::Unrolled:
+            StepUnrolled(FrameIndex, Node);
+            break;
+
+        default:
+            PopFrame();
+            break;
+    }
+}
+
+bool FSpellInterpreter::ChargeFuel(USpellExecutionContext* Context, const USpellNode* Node)
+{
+    const int32 Cost = GetDefault<UGrimoireSettings>()->GetFuelCost(Node);
+
+    // Worker threads meter against what the cast had left at the fork, shared with their siblings.
+    // A failed draw still counts, so billing the branch at the join runs the cast dry.
+    if (bTask)
+    {
+        TaskFuelUsed += Cost;
+        if (!TaskFuel || TaskFuel->fetch_sub(Cost, std::memory_order_relaxed) >= Cost)
+        {
+            return true;
+        }
+        Frames.Reset();
+        return false;
+    }
+
+    return BurnFuel(Context, Cost, Node);
+}
+
+bool FSpellInterpreter::BurnFuel(USpellExecutionContext* Context, int32 Amount, const USpellNode* Node)
+{
+    // Another interpreter of this cast already ran dry and reported it
+    if (Context->IsOutOfFuel())
+    {
+        Frames.Reset();
+        return false;
+    }
+
+    INC_DWORD_STAT_BY(STAT_GrimoireFuelBurned, Amount);
+    if (Context->ConsumeFuel(Amount))
+    {
+        return true;
+    }
+
+    INC_DWORD_STAT(STAT_GrimoireCastsOutOfFuel);
+    UE_LOG(LogTemp, Warning, TEXT("Spell ran out of fuel at %s after burning %d, aborting the cast"), *Node->NodeName, Context->GetFuelUsed());
+    Frames.Reset();
+    return false;
+}
+
+void FSpellInterpreter::PushInstruction(uint16 InstructionIndex, USpellExecutionContext* Context)
+{
+    if (!IsValid(Program.Nodes[Program.Instructions[InstructionIndex].NodeIndex]))
+    {
+        return;
+    }
+
+    // The limit belongs to this cast alone, so overlapping casts of the same graph cannot trip each other
+    if (Frames.Num() >= DepthLimit)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Spell exceeded the maximum execution depth of %d, aborting"), Program.MaxDepth);
+        Frames.Reset();
+        return;
+    }
+
+    FSpellFrame& Frame = Frames.AddDefaulted_GetRef();
+    Frame.Context = Context;
+    Frame.BranchContext = Context;
+    Frame.Instruction = InstructionIndex;
+}
+
+bool FSpellInterpreter::PushNextSuccessor(int32 FrameIndex)
+{
+    FSpellFrame& Frame = Frames[FrameIndex];
+    if (Frame.Cursor >= Frame.Walk.Num)
+    {
+        return false;
+    }
+
+    const uint16 Target = Program.Successors[Frame.Walk.Start + Frame.Cursor];
+    ++Frame.Cursor;
+
+    // Frame may be invalidated by the push
+    PushInstruction(Target, Frame.BranchContext);
+    return true;
+}
+
+void FSpellInterpreter::BeginWalk(int32 FrameIndex, const FSpellExitRange& Range, USpellExecutionContext* Context)
+{
+    FSpellFrame& Frame = Frames[FrameIndex];
+    Frame.Walk = Range;
+    Frame.Cursor = 0;
+    Frame.BranchContext = Context;
+}
+
+void FSpellInterpreter::PopFrame()
+{
+    Frames.Pop(EAllowShrinking::No);
+}
+
+void FSpellInterpreter::StepAction(int32 FrameIndex, USpellNode* Node)
+{
+    FSpellFrame& Frame = Frames[FrameIndex];
+    if (Frame.Phase == 0)
+    {
+        Node->OnExecute(Frame.Context);
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Program.Instructions[Frame.Instruction].Exits[0], Frame.Context);
+    }
+
+    if (!PushNextSuccessor(FrameIndex))
+    {
+        Node->OnExecutionComplete(Frames[FrameIndex].Context);
+        PopFrame();
+    }
+}
+
+void FSpellInterpreter::StepSequence(int32 FrameIndex, USpellNode* Node)
+{
+    UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+
+    if (Frame.Phase == 0)
+    {
+        FlowNode->ApplyRarityEffects(Context);
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Program.Instructions[Frame.Instruction].Exits[0], Context);
+    }
+
+    // Break is checked after every child, like the graph walker did
+    if (Frame.Cursor > 0 && FlowNode->bBreakOnCondition && FlowNode->EvaluateBreakCondition(Context))
+    {
+        PopFrame();
+        return;
+    }
+
+    if (Frame.Cursor >= Frame.Walk.Num)
+    {
+        PopFrame();
+        return;
+    }
+
+    Context->SetRegister(ESpellRegister::SequenceIndex, FSpellValue::FromInt(Frame.Cursor));
+    Context->SetRegister(ESpellRegister::SequenceTotal, FSpellValue::FromInt(Frame.Walk.Num));
+    PushNextSuccessor(FrameIndex);
+}
+
+void FSpellInterpreter::StepLoop(int32 FrameIndex, USpellNode* Node)
+{
+    UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const FSpellInstruction& Instruction = Program.Instructions[Frame.Instruction];
+
+    // Switching on MAX below skips work the optimizer proved unobservable
+    const bool bCheckRegisters = !EnumHasAnyFlags(Instruction.Flags, ESpellInstructionFlags::NoLoopChecks);
+    const bool bWriteRegisters = !EnumHasAnyFlags(Instruction.Flags, ESpellInstructionFlags::NoLoopRegisters);
+
+    if (Frame.Phase == 0)
+    {
+        FlowNode->ApplyRarityEffects(Context);
+        Frame.Iteration = 0;
+        Frame.Limit = FlowNode->ResolveIterationLimit(Context);
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Instruction.Exits[0], Context);
+    }
+
+    if (Frame.Phase == 2)
+    {
+        if (!PushNextSuccessor(FrameIndex))
+        {
+            PopFrame();
+        }
+        return;
+    }
+
+    // Start of an iteration
+    if (Frame.Cursor == 0)
+    {
+        bool bRunIteration = Frame.Iteration < Frame.Limit;
+        switch (bCheckRegisters ? Instruction.OpCode : ESpellOpCode::MAX)
+        {
+            case ESpellOpCode::Loop:
+                bRunIteration = bRunIteration && (!FlowNode->bBreakOnCondition || !FlowNode->EvaluateBreakCondition(Context));
+                break;
+            case ESpellOpCode::WhileLoop:
+                if (bRunIteration && Context->HasRegister(ESpellRegister::Condition))
+                {
+                    bRunIteration = Context->GetRegister(ESpellRegister::Condition).GetBool();
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (!bRunIteration)
+        {
+            if (Instruction.OpCode == ESpellOpCode::Loop)
+            {
+                Frame.Phase = 2;
+                BeginWalk(FrameIndex, Instruction.Exits[1], Context);
+                if (!PushNextSuccessor(FrameIndex))
+                {
+                    PopFrame();
+                }
+            }
+            else
+            {
+                PopFrame();
+            }
+            return;
+        }
+
+        switch (bWriteRegisters ? Instruction.OpCode : ESpellOpCode::MAX)
+        {
+            case ESpellOpCode::Loop:
+                Context->SetRegister(ESpellRegister::LoopIndex, FSpellValue::FromInt(Frame.Iteration));
+                Context->SetRegister(ESpellRegister::LoopTotal, FSpellValue::FromInt(Frame.Limit));
+                break;
+            case ESpellOpCode::WhileLoop:
+                Context->SetRegister(ESpellRegister::WhileIndex, FSpellValue::FromInt(Frame.Iteration));
+                break;
+            case ESpellOpCode::ForLoop:
+                Context->SetRegister(ESpellRegister::ForIndex, FSpellValue::FromInt(Frame.Iteration));
+                Context->SetRegister(ESpellRegister::ForTotal, FSpellValue::FromInt(Frame.Limit));
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (PushNextSuccessor(FrameIndex))
+    {
+        return;
+    }
+
+    // Body finished, close out the iteration
+    ++Frame.Iteration;
+    Frame.Cursor = 0;
+
+    switch (bCheckRegisters ? Instruction.OpCode : ESpellOpCode::MAX)
+    {
+        case ESpellOpCode::Loop:
+            if (Context->HasRegister(ESpellRegister::ShouldContinue) && !Context->GetRegister(ESpellRegister::ShouldContinue).GetBool())
+            {
+                Frame.Limit = Frame.Iteration;
+            }
+            break;
+        case ESpellOpCode::ForLoop:
+            if (FlowNode->bBreakOnCondition && FlowNode->EvaluateBreakCondition(Context))
+            {
+                Frame.Limit = Frame.Iteration;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Wait out the iteration delay before the next iteration starts
+    if (Frame.Iteration < Frame.Limit)
+    {
+        const float IterationDelay = FlowNode->ResolveIterationDelay();
+        if (IterationDelay > 0.0f)
+        {
+            Suspend(IterationDelay);
+        }
+    }
+}
+
+void FSpellInterpreter::StepUnrolled(int32 FrameIndex, USpellNode* Node)
+{
+    UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const FSpellInstruction& Instruction = Program.Instructions[Frame.Instruction];
+
+    // The optimizer already laid out every iteration, so the loop is a straight walk
+    if (Frame.Phase == 0)
+    {
+        FlowNode->ApplyRarityEffects(Context);
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Instruction.Exits[0], Context);
+    }
+
+    if (PushNextSuccessor(FrameIndex))
+    {
+        return;
+    }
+
+    if (Frame.Phase == 1)
+    {
+        Frame.Phase = 2;
+        BeginWalk(FrameIndex, Instruction.Exits[1], Context);
+        if (PushNextSuccessor(FrameIndex))
+        {
+            return;
+        }
+    }
+
+    PopFrame();
+}
+
+void FSpellInterpreter::StepDelay(int32 FrameIndex, USpellNode* Node)
+{
+    UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+
+    if (Frame.Phase == 0)
+    {
+        FlowNode->ApplyRarityEffects(Context);
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Program.Instructions[Frame.Instruction].Exits[0], Context);
+
+        // Successors run when the frame is stepped again after the delay
+        if (Suspend(FlowNode->ResolveDelayTime(Context)))
+        {
+            return;
+        }
+    }
+
+    if (!PushNextSuccessor(FrameIndex))
+    {
+        PopFrame();
+    }
+}
+
+void FSpellInterpreter::StepParallel(int32 FrameIndex, USpellNode* Node)
+{
+    UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const FSpellInstruction& Instruction = Program.Instructions[Frame.Instruction];
+
+    if (Frame.Phase == 0)
+    {
+        FlowNode->ApplyRarityEffects(Context);
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Instruction.Exits[0], Context);
+
+        // Finished branches leave nothing to walk, only the join
+        if (CanRunConcurrently(Instruction) && !RunConcurrentBranches(FrameIndex))
+        {
+            return;
+        }
+    }
+
+    if (Frame.Phase == 1)
+    {
+        if (Frame.Cursor < Frame.Walk.Num)
+        {
+            // Every branch gets its own child scope; siblings do not see each other's writes until the join
+            Frame.BranchContext = Context->ForkChildContext();
+            PushNextSuccessor(FrameIndex);
+            return;
+        }
+
+        Context->JoinChildContexts();
+        Frame.Phase = 2;
+        BeginWalk(FrameIndex, Instruction.Exits[1], Context);
+    }
+
+    if (!PushNextSuccessor(FrameIndex))
+    {
+        PopFrame();
+    }
+}
+
+bool FSpellInterpreter::CanRunConcurrently(const FSpellInstruction& Instruction) const
+{
+    // Branches already on a worker run nested parallels in order; only the game thread bills the cast at a join
+    return !bTask
+        && EnumHasAnyFlags(Instruction.Flags, ESpellInstructionFlags::ConcurrentBranches)
+        && Program.Rarity >= GetDefault<UGrimoireSettings>()->MinConcurrentRarity
+        && FApp::ShouldUseThreadingForPerformance();
+}
+
+bool FSpellInterpreter::RunConcurrentBranches(int32 FrameIndex)
+{
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const int32 FuelRemaining = Context->GetFuelRemaining();
+
+    // Once one branch empties it every other branch stops at its next node, so together they never outspend the cast
+    std::atomic<int32> SharedFuel(FuelRemaining);
+    std::atomic<int32>* BranchFuel = FuelRemaining < MAX_int32 ? &SharedFuel : nullptr;
+
+    // Each branch records world changes privately; they are appended in graph order below
+    TArray<FSpellCommandBuffer, TInlineAllocator<8>> BranchCommands;
+    BranchCommands.SetNum(Frame.Walk.Num - Frame.Cursor);
+
+    // Contexts come from the cast's pool, so fork them here, in graph order, for the join to merge as a sequential run would
+    TArray<TUniquePtr<FSpellInterpreter>, TInlineAllocator<8>> Branches;
+    for (; Frame.Cursor < Frame.Walk.Num; ++Frame.Cursor)
+    {
+        USpellExecutionContext* BranchContext = Context->ForkChildContext();
+        BranchContext->ReserveRegisters();
+        BranchContext->SetCommandBuffer(&BranchCommands[Branches.Num()]);
+
+        FSpellInterpreter* Branch = new FSpellInterpreter(ProgramRef, BranchContext);
+        Branch->bTask = true;
+        Branch->DepthLimit = DepthLimit - Frames.Num();
+        Branch->TaskFuel = BranchFuel;
+        Branch->PushInstruction(Program.Successors[Frame.Walk.Start + Frame.Cursor], BranchContext);
+        Branches.Emplace(Branch);
+    }
+
+    // The world is only read while the game thread waits, which it spends on the first branch and then helping out
+    TArray<UE::Tasks::FTask, TInlineAllocator<8>> Tasks;
+    for (int32 Index = 1; Index < Branches.Num(); ++Index)
+    {
+        FSpellInterpreter* Branch = Branches[Index].Get();
+        Tasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [Branch]() { Branch->Run(); }));
+    }
+    Branches[0]->Run();
+    UE::Tasks::Wait(Tasks);
+    INC_DWORD_STAT_BY(STAT_GrimoireConcurrentBranches, Branches.Num());
+
+    // A branch that ran dry burned past what was left, so billing it runs the cast dry too.
+    // Branches after it would not have started in a sequential run, so their commands are dropped.
+    const USpellNode* Node = Program.Nodes[Program.Instructions[Frame.Instruction].NodeIndex];
+    FSpellCommandBuffer& Commands = Context->GetCommandBuffer();
+    bool bHasFuel = true;
+    for (int32 Index = 0; Index < Branches.Num(); ++Index)
+    {
+        Branches[Index]->RootContext->SetCommandBuffer(nullptr);
+        if (bHasFuel)
+        {
+            Commands.Append(BranchCommands[Index]);
+            bHasFuel = BurnFuel(Context, Branches[Index]->TaskFuelUsed, Node);
+        }
+    }
+    return bHasFuel;
+}
+
+void FSpellInterpreter::StepBranch(int32 FrameIndex, USpellNode* Node)
+{
+    UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const FSpellInstruction& Instruction = Program.Instructions[Frame.Instruction];
+
+    if (Frame.Phase == 0)
+    {
+        FlowNode->ApplyRarityEffects(Context);
+
+        const FSpellValue& ConditionValue = Context->GetRegister(Instruction.OpCode == ESpellOpCode::Gate ? ESpellRegister::GateOpen : ESpellRegister::Condition);
+        const bool bCondition = ConditionValue.IsSet() ? ConditionValue.GetBool() : true;
+
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Instruction.Exits[bCondition ? 0 : 1], Context);
+    }
+
+    if (!PushNextSuccessor(FrameIndex))
+    {
+        PopFrame();
+    }
+}
+
+void FSpellInterpreter::StepCondition(int32 FrameIndex, USpellNode* Node)
+{
+    UConditionNode* ConditionNode = CastChecked<UConditionNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const FSpellInstruction& Instruction = Program.Instructions[Frame.Instruction];
+
+    if (Frame.Phase == 0)
+    {
+        const bool bResult = ConditionNode->EvaluateBranch(Context);
+        Frame.Iteration = bResult ? 1 : 0;
+        Frame.Phase = 1;
+
+        // Quantum conditioning runs the false branch first on a weakened child context
+        if (ConditionNode->RunsBothBranches(bResult))
+        {
+            USpellExecutionContext* AltContext = Context->CreateChildContext();
+            AltContext->ModifySpellPower(0.5f);
+            BeginWalk(FrameIndex, Instruction.Exits[1], AltContext);
+        }
+        else
+        {
+            BeginWalk(FrameIndex, FSpellExitRange(), Context);
+        }
+    }
+
+    if (Frame.Phase == 1)
+    {
+        if (PushNextSuccessor(FrameIndex))
+        {
+            return;
+        }
+
+        if (Frame.Iteration != 0)
+        {
+            BeginWalk(FrameIndex, Instruction.Exits[0], Context);
+        }
+        else if (ConditionNode->HasElseBranch())
+        {
+            BeginWalk(FrameIndex, Instruction.Exits[1], Context);
+        }
+        else
+        {
+            PopFrame();
+            return;
+        }
+        Frame.Phase = 2;
+    }
+
+    if (!PushNextSuccessor(FrameIndex))
+    {
+        PopFrame();
+    }
+}
+
+void FSpellInterpreter::StepTrigger(int32 FrameIndex, USpellNode* Node)
+{
+    UTriggerNode* TriggerNode = CastChecked<UTriggerNode>(Node);
+    FSpellFrame& Frame = Frames[FrameIndex];
+    USpellExecutionContext* Context = Frame.Context;
+    const FSpellExitRange& Exit = Program.Instructions[Frame.Instruction].Exits[0];
+
+    // Iteration counts firings, Limit holds the caster's timer chain for this spell
+    const UGrimoireComponent* Grimoire = Context->Grimoire.Get();
+    if (Frame.Phase == 0)
+    {
+        TriggerNode->OnExecute(Context);
+        Frame.Iteration = 1;
+        Frame.Limit = Grimoire ? Grimoire->GetTimerChain(Context->SpellName) : 0;
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Exit, Context);
+    }
+    else if (Frame.Phase == 2)
+    {
+        // Woken by the timer. The trigger stops once its caster is gone or the spell was cast again.
+        if (!IsValid(Context->Caster) || (Grimoire && Grimoire->GetTimerChain(Context->SpellName) != Frame.Limit))
+        {
+            TriggerNode->OnExecutionComplete(Context);
+            PopFrame();
+            return;
+        }
+
+        // Each firing runs the node again
+        if (!ChargeFuel(Context, TriggerNode))
+        {
+            return;
+        }
+
+        TriggerNode->HandleTimerTrigger(Context);
+        ++Frame.Iteration;
+        Frame.Phase = 1;
+        BeginWalk(FrameIndex, Exit, Context);
+    }
+
+    if (PushNextSuccessor(FrameIndex))
+    {
+        return;
+    }
+
+    Frame.Phase = 2;
+    if (Frame.Iteration >= TriggerNode->MaxFirings || !Suspend(TriggerNode->TimerInterval))
+    {
+        TriggerNode->OnExecutionComplete(Context);
+        PopFrame();
+    }
+}
@@ -0,0 +1,134 @@
+#include "Spells/SpellMetrics.h"
+#include "Spells/SpellNode.h"
+#include "Spells/MagicNode.h"
+#include "Model/HeartGraph.h"
+
+TMap<FObjectKey, FSpellMetrics> FSpellMetrics::Cache;
+
+FSpellNodeMetrics FSpellNodeMetrics::Of(const USpellNode* Node)
+{
+    FSpellNodeMetrics Metrics;
+    Metrics.ManaCost = Node->NodeManaCost * Node->GetRarityScaleFactor();
+    Metrics.Power = Node->IsA<UMagicNode>() ? Node->GetBasePower() : 0.0f;
+    Metrics.RarityLevel = static_cast<int32>(Node->NodeRarity);
+    return Metrics;
+}
+
+const FSpellMetrics& FSpellMetrics::Get(const UHeartGraph* Graph)
+{
+    check(IsInGameThread());
+
+    static const FSpellMetrics Empty;
+    if (!Graph)
+    {
+        return Empty;
+    }
+
+    if (const FSpellMetrics* Cached = Cache.Find(FObjectKey(Graph)))
+    {
+        return *Cached;
+    }
+
+    // Drop aggregates of graphs that have been garbage collected
+    for (auto It = Cache.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().ResolveObjectPtr())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    FSpellMetrics& Metrics = Cache.Add(FObjectKey(Graph));
+    Metrics.Build(Graph);
+    return Metrics;
+}
+
+void FSpellMetrics::AddNode(const UHeartGraph* Graph, const USpellNode* Node)
+{
+    check(IsInGameThread());
+
+    FSpellMetrics* Metrics = Cache.Find(FObjectKey(Graph));
+    if (!Metrics || !Node || Metrics->Contributions.Contains(FObjectKey(Node)))
+    {
+        return;
+    }
+
+    const FSpellNodeMetrics NodeMetrics = FSpellNodeMetrics::Of(Node);
+    Metrics->Contributions.Add(FObjectKey(Node), NodeMetrics);
+    Metrics->Add(NodeMetrics, 1.0);
+}
+
+void FSpellMetrics::RemoveNode(const UHeartGraph* Graph, const USpellNode* Node)
+{
+    check(IsInGameThread());
+
+    FSpellMetrics* Metrics = Cache.Find(FObjectKey(Graph));
+    FSpellNodeMetrics NodeMetrics;
+    if (Metrics && Metrics->Contributions.RemoveAndCopyValue(FObjectKey(Node), NodeMetrics))
+    {
+        Metrics->Add(NodeMetrics, -1.0);
+    }
+}
+
+void FSpellMetrics::RefreshNode(const UHeartGraph* Graph, const USpellNode* Node)
+{
+    check(IsInGameThread());
+
+    FSpellMetrics* Metrics = Cache.Find(FObjectKey(Graph));
+    if (!Metrics || !Node)
+    {
+        return;
+    }
+
+    FSpellNodeMetrics& Previous = Metrics->Contributions.FindOrAdd(FObjectKey(Node));
+    Metrics->Add(Previous, -1.0);
+    Previous = FSpellNodeMetrics::Of(Node);
+    Metrics->Add(Previous, 1.0);
+}
+
+void FSpellMetrics::Invalidate(const UHeartGraph* Graph)
+{
+    check(IsInGameThread());
+    Cache.Remove(FObjectKey(Graph));
+}
+
+float FSpellMetrics::GetAverageRarity() const
+{
+    return Contributions.Num() > 0 ? static_cast<float>(RaritySum) / Contributions.Num() : 0.0f;
+}
+
+float FSpellMetrics::GetComplexityFactor() const
+{
+    const int32 ExcessNodes = Contributions.Num() - ComplexityThreshold;
+    return ExcessNodes > 0 ? FMath::Max(0.5f, 1.0f - ExcessNodes * 0.05f) : 1.0f;
+}
+
+float FSpellMetrics::GetSpellPower() const
+{
+    const float RarityBonus = 1.0f + GetAverageRarity() * 0.1f;
+    return GetBasePower() * GetComplexityFactor() * RarityBonus;
+}
+
+void FSpellMetrics::Build(const UHeartGraph* Graph)
+{
+    TArray<UHeartGraphNode*> AllNodes;
+    Graph->GetAllNodes(AllNodes);
+
+    Contributions.Reserve(AllNodes.Num());
+    for (UHeartGraphNode* Node : AllNodes)
+    {
+        if (const USpellNode* SpellNode = Cast<USpellNode>(Node))
+        {
+            const FSpellNodeMetrics NodeMetrics = FSpellNodeMetrics::Of(SpellNode);
+            Contributions.Add(FObjectKey(SpellNode), NodeMetrics);
+            Add(NodeMetrics, 1.0);
+        }
+    }
+}
+
+void FSpellMetrics::Add(const FSpellNodeMetrics& Metrics, double Sign)
+{
+    ManaCost += Sign * Metrics.ManaCost;
+    Power += Sign * Metrics.Power;
+    RaritySum += Sign > 0.0 ? Metrics.RarityLevel : -Metrics.RarityLevel;
+}
@@ -1,5 +1,11 @@
 ﻿#include "Spells/SpellNode.h"
 #include "Components/GrimoireComponent.h"
+#include "Spells/SpellExecutionContext.h"
+#include "Spells/SpellCompiler.h"
+#include "Spells/SpellInterpreter.h"
+#include "Spells/SpellMetrics.h"
+#include "Spells/SpellOptimizer.h"
+#include "Spells/SpellCostAnalyzer.h"
 #include "Model/HeartGraph.h"
 #include "Model/HeartGraphNode.h"
 #include "BloodProperty.h"
@@ -90,54 +96,81 @@ TArray<FHeartGraphPinDesc> USpellNode::GetPins(EHeartPinDirection Direction) con
     return Pins;
 }
 
-void USpellNode::Execute(UGrimoireComponent* Grimoire, AActor* ContextActor)
+void USpellNode::Execute(USpellExecutionContext* Context)
 {
-    if (!ContextActor || !Grimoire) return;
+    if (!Context) return;
 
-    OnExecute(Grimoire, ContextActor);
+    // Run the subgraph from this node on the interpreter rather than recursing into connected nodes
+    if (!CachedProgram.IsValid() || CachedProgram->IsStale())
+    {
+        CachedProgram = FSpellCompiler::Compile(GetTypedOuter<UHeartGraph>(), this);
+    }
 
-    // Execute connected nodes through HeartGraph connections
-    TArray<USpellNode*> ConnectedNodes = GetConnectedSpellNodes();
-    for (USpellNode* ConnectedNode : ConnectedNodes)
+    if (CachedProgram.IsValid())
     {
-        if (ConnectedNode && IsValid(ConnectedNode))
+        FSpellInterpreter::Execute(CachedProgram.ToSharedRef(), Context);
+    }
+}
+
+const FSpellGraphIndex* USpellNode::GetGraphIndex() const
+{
+    if (!CachedGraphIndex.IsValid() || CachedGraphIndex->IsStale())
+    {
+        UHeartGraph* Graph = GetTypedOuter<UHeartGraph>();
+        if (!Graph)
         {
-            ConnectedNode->Execute(Grimoire, ContextActor);
+            return nullptr;
         }
+        CachedGraphIndex = FSpellGraphIndex::Get(Graph);
     }
+    return CachedGraphIndex.Get();
+}
+
+TConstArrayView<USpellNode*> USpellNode::GetConnectedSpellNodes(ESpellPin Pin) const
+{
+    return GetConnectedSpellNodes(Pin, Pin);
+}
 
-    OnExecutionComplete(ContextActor);
+TConstArrayView<USpellNode*> USpellNode::GetConnectedSpellNodes(ESpellPin FirstPin, ESpellPin LastPin) const
+{
+    const FSpellGraphIndex* Index = GetGraphIndex();
+    if (!Index || Index->GetNodeIndex(this) == FSpellGraphIndex::InvalidNodeIndex)
+    {
+        return TConstArrayView<USpellNode*>();
+    }
+    return Index->GetSuccessorNodes(SpellGraphIndex, FirstPin, LastPin);
 }
 
-TArray<USpellNode*> USpellNode::GetConnectedSpellNodes() const
+#if WITH_EDITOR
+void USpellNode::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
-    TArray<USpellNode*> ConnectedNodes;
-    if (UHeartGraph* Graph = GetTypedOuter<UHeartGraph>())
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // Node settings such as FlowType change which pins are walked
+    FSpellGraphIndex::Invalidate(GetTypedOuter<UHeartGraph>());
+    FSpellMetrics::RefreshNode(GetTypedOuter<UHeartGraph>(), this);
+
+    // Warn while the spell is being edited, the component refuses to compile it later
+    if (const TSharedPtr<FCompiledSpell> Program = FSpellCompiler::Compile(GetTypedOuter<UHeartGraph>()))
     {
-        FHeartGraphPinReference ExecOutPin = GetPinReference(TEXT("ExecOut"));
-        TArray<FHeartGraphPinReference> Connections = Graph->GetConnectedPins(GetNodeGuid(), TEXT("ExecOut"));
-        for (const FHeartGraphPinReference& Ref : Connections)
+        FSpellOptimizer::Optimize(*Program);
+
+        FString Reason;
+        if (!FSpellCostAnalyzer::IsWithinBudget(FSpellCostAnalyzer::Analyze(*Program), Reason))
         {
-            UHeartGraphNode* Node = Graph->GetNode(Conn.OtherNode);
-            if (UHeartGraphNode* Node = Graph->GetNode(Ref.NodeGuid))
-            {
-                if (USpellNode* SpellNode = Cast<USpellNode>(Node))
-                {
-                    ConnectedNodes.Add(SpellNode);
-                }
-            }
+            UE_LOG(LogTemp, Warning, TEXT("Editing %s put its spell over the cost budget: %s"), *NodeName, *Reason);
         }
     }
-    return ConnectedNodes;
 }
+#endif
 
-void USpellNode::OnExecute(UGrimoireComponent* Grimoire, AActor* ContextActor)
+void USpellNode::OnExecute(USpellExecutionContext* Context)
 {
     // Base implementation - override in derived classes
     UE_LOG(LogTemp, Log, TEXT("Executing node: %s"), *NodeName);
 }
 
-void USpellNode::OnExecutionComplete(AActor* ContextActor)
+void USpellNode::OnExecutionComplete(USpellExecutionContext* Context)
 {
     UE_LOG(LogTemp, Log, TEXT("Node execution complete: %s"), *NodeName);
 }
@@ -160,6 +193,15 @@ float USpellNode::GetRarityScaleFactor() const
     }
 }
 
+void USpellNode::SetNodeRarity(EItemRarity NewRarity)
+{
+    if (NodeRarity != NewRarity)
+    {
+        NodeRarity = NewRarity;
+        FSpellMetrics::RefreshNode(GetTypedOuter<UHeartGraph>(), this);
+    }
+}
+
 int32 USpellNode::GetMaxInputConnections() const
 {
     switch (NodeRarity)
@@ -187,8 +229,7 @@ UGameplayAbility* USpellNode::CompileToGASAbility(float& OutSpellManaCost, int32
     // Map node logic to ability tasks (e.g., add UAbilityTask_PlayMontageAndWait for animations)
     // Example stub: Set cost based on mana
     Ability->AbilityTags.AddTag(FGameplayTag::RequestGameplayTag(FName("Spell.Basic")));
-    TArray<USpellNode*> Connected = GetConnectedSpellNodes();
-    for (USpellNode* Node : Connected)
+    for (USpellNode* Node : GetConnectedSpellNodes())
     {
         float NodeCost;
 	    int32 NodeID;
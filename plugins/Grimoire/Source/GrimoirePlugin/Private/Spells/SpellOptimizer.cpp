@@ -0,0 +1,808 @@
+#include "Spells/SpellOptimizer.h"
+#include "Spells/SpellNode.h"
+#include "Spells/FlowNode.h"
+#include "Spells/ConditionNode.h"
+
+namespace SpellOptimizer
+{
+    static bool IsLoop(ESpellOpCode OpCode)
+    {
+        return OpCode == ESpellOpCode::Loop || OpCode == ESpellOpCode::WhileLoop || OpCode == ESpellOpCode::ForLoop;
+    }
+}
+
+FSpellOptimizer::FSpellOptimizer(FCompiledSpell& InProgram)
+    : Program(InProgram)
+{
+}
+
+void FSpellOptimizer::Optimize(FCompiledSpell& Spell)
+{
+    if (Spell.IsEmpty() || !Spell.SourceIndex.IsValid())
+    {
+        return;
+    }
+
+    FSpellOptimizer Optimizer(Spell);
+    if (!Optimizer.Analyze())
+    {
+        return;
+    }
+
+    // Folding a branch can orphan a writer, and dropping a writer can decide another branch
+    bool bChanged = true;
+    while (bChanged)
+    {
+        bChanged = Optimizer.FoldBranches();
+        bChanged |= Optimizer.RemoveUnreachable();
+        bChanged |= Optimizer.CollapsePassThrough();
+    }
+
+    Optimizer.OptimizeLoops();
+    Optimizer.MarkConcurrentBranches();
+
+    const int32 NumBefore = Spell.Instructions.Num();
+    Optimizer.Rebuild();
+
+    UE_LOG(LogTemp, Verbose, TEXT("Optimized spell from %d to %d instructions"), NumBefore, Spell.Instructions.Num());
+}
+
+bool FSpellOptimizer::Analyze()
+{
+    const FSpellRegisterLayout& Layout = *Program.SourceIndex->GetRegisterLayout();
+    ReadCounts.Init(0, Layout.Num());
+    WriteCounts.Init(0, Layout.Num());
+
+    Work.SetNum(Program.Instructions.Num());
+    for (int32 Index = 0; Index < Program.Instructions.Num(); ++Index)
+    {
+        const FSpellInstruction& Instruction = Program.Instructions[Index];
+        FWorkInstruction& Item = Work[Index];
+        Item.OpCode = Instruction.OpCode;
+        Item.Flags = Instruction.Flags;
+        Item.NodeIndex = Instruction.NodeIndex;
+        Item.Exits[0].Append(Program.GetExit(Instruction, 0));
+        Item.Exits[1].Append(Program.GetExit(Instruction, 1));
+
+        // One node we cannot see into could read or write anything
+        const USpellNode* Node = Program.Nodes[Instruction.NodeIndex];
+        if (!IsValid(Node) || !Node->GetRegisterAccess(Layout, Item.Access))
+        {
+            return false;
+        }
+
+        CountAccess(Item.Access, 1);
+    }
+
+    for (uint16 Entry : Program.EntryPoints)
+    {
+        Work[Entry].bEntry = true;
+    }
+    return true;
+}
+
+void FSpellOptimizer::CountAccess(const FSpellRegisterAccess& Access, int32 Delta)
+{
+    for (TConstSetBitIterator<> It(Access.Reads); It; ++It)
+    {
+        ReadCounts[It.GetIndex()] += Delta;
+    }
+    for (TConstSetBitIterator<> It(Access.Writes); It; ++It)
+    {
+        WriteCounts[It.GetIndex()] += Delta;
+    }
+}
+
+bool FSpellOptimizer::FoldBranches()
+{
+    TBitArray<> WrittenSlots(false, WriteCounts.Num());
+    for (int32 Slot = 0; Slot < WriteCounts.Num(); ++Slot)
+    {
+        WrittenSlots[Slot] = WriteCounts[Slot] > 0;
+    }
+
+    bool bChanged = false;
+    for (FWorkInstruction& Item : Work)
+    {
+        if (Item.bRemoved)
+        {
+            continue;
+        }
+
+        // Index of the exit that can never run
+        int32 DeadExit = INDEX_NONE;
+        switch (Item.OpCode)
+        {
+            case ESpellOpCode::Branch:
+                // An unset condition reads as true
+                DeadExit = IsWritten(ESpellRegister::Condition) ? INDEX_NONE : 1;
+                break;
+
+            case ESpellOpCode::Gate:
+                // A gate nobody closes stays open
+                DeadExit = IsWritten(ESpellRegister::GateOpen) ? INDEX_NONE : 1;
+                break;
+
+            case ESpellOpCode::Condition:
+            {
+                const UConditionNode* ConditionNode = CastChecked<UConditionNode>(Program.Nodes[Item.NodeIndex]);
+                bool bResult = false;
+                if (ConditionNode->GetConstantResult(WrittenSlots, bResult))
+                {
+                    if (!bResult)
+                    {
+                        DeadExit = 0;
+                    }
+                    else if (!ConditionNode->RunsBothBranches(true))
+                    {
+                        DeadExit = 1;
+                    }
+                }
+
+                // The false exit only runs as an else branch or as the Legendary second path
+                if (DeadExit == INDEX_NONE && !ConditionNode->HasElseBranch() && ConditionNode->NodeRarity != EItemRarity::Legendary)
+                {
+                    DeadExit = 1;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (DeadExit != INDEX_NONE && Item.Exits[DeadExit].Num() > 0)
+        {
+            Item.Exits[DeadExit].Reset();
+            bChanged = true;
+        }
+    }
+    return bChanged;
+}
+
+bool FSpellOptimizer::RemoveUnreachable()
+{
+    TBitArray<> Reached(false, Work.Num());
+    TArray<uint16> Pending(Program.EntryPoints);
+    while (Pending.Num() > 0)
+    {
+        const uint16 Index = Pending.Pop(EAllowShrinking::No);
+        if (Reached[Index])
+        {
+            continue;
+        }
+
+        Reached[Index] = true;
+        Pending.Append(Work[Index].Exits[0]);
+        Pending.Append(Work[Index].Exits[1]);
+    }
+
+    // Instructions on pruned branches no longer count as readers or writers
+    bool bChanged = false;
+    for (int32 Index = 0; Index < Work.Num(); ++Index)
+    {
+        FWorkInstruction& Item = Work[Index];
+        if (!Item.bRemoved && !Reached[Index])
+        {
+            Item.bRemoved = true;
+            CountAccess(Item.Access, -1);
+            bChanged = true;
+        }
+    }
+    return bChanged;
+}
+
+bool FSpellOptimizer::GetPassThrough(int32 Index, TArray<uint16, TInlineAllocator<4>>& OutReplacement) const
+{
+    const FWorkInstruction& Item = Work[Index];
+    const USpellNode* Node = Program.Nodes[Item.NodeIndex];
+
+    // Entry points are looked up by instruction index, so they stay
+    if (Item.bEntry || Item.bRemoved)
+    {
+        return false;
+    }
+
+    switch (Item.OpCode)
+    {
+        case ESpellOpCode::Sequence:
+        {
+            const UFlowNode* FlowNode = CastChecked<UFlowNode>(Node);
+            if (FlowNode->NodeRarity != EItemRarity::Common || FlowNode->bBreakOnCondition
+                || IsRead(ESpellRegister::SequenceIndex) || IsRead(ESpellRegister::SequenceTotal))
+            {
+                return false;
+            }
+            break;
+        }
+
+        case ESpellOpCode::Branch:
+        case ESpellOpCode::Gate:
+        {
+            const ESpellRegister Register = Item.OpCode == ESpellOpCode::Gate ? ESpellRegister::GateOpen : ESpellRegister::Condition;
+            if (Node->NodeRarity != EItemRarity::Common || IsWritten(Register))
+            {
+                return false;
+            }
+            break;
+        }
+
+        case ESpellOpCode::Action:
+        {
+            if (Item.Access.bHasSideEffects)
+            {
+                return false;
+            }
+
+            // Dead store: nothing else in the spell reads what this node writes
+            for (TConstSetBitIterator<> It(Item.Access.Writes); It; ++It)
+            {
+                const int32 Slot = It.GetIndex();
+                const bool bReadsSelf = Slot < Item.Access.Reads.Num() && Item.Access.Reads[Slot];
+                if (ReadCounts[Slot] > (bReadsSelf ? 1 : 0))
+                {
+                    return false;
+                }
+            }
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    // Walking exit 0 in order is all these instructions do once the checks above hold
+    OutReplacement = Item.Exits[0];
+    return !OutReplacement.Contains(static_cast<uint16>(Index));
+}
+
+bool FSpellOptimizer::CanSplice(const FWorkInstruction& Predecessor, int32 ExitIndex, int32 ReplacementNum) const
+{
+    if (ReplacementNum == 1)
+    {
+        return true;
+    }
+
+    switch (Predecessor.OpCode)
+    {
+        case ESpellOpCode::Sequence:
+        {
+            // Children are numbered and the break condition is checked between them
+            const UFlowNode* FlowNode = CastChecked<UFlowNode>(Program.Nodes[Predecessor.NodeIndex]);
+            return !FlowNode->bBreakOnCondition && !IsRead(ESpellRegister::SequenceIndex) && !IsRead(ESpellRegister::SequenceTotal);
+        }
+
+        case ESpellOpCode::Parallel:
+            // Each branch gets its own scope, so branches cannot be merged or split. An empty branch changes nothing.
+            return ExitIndex != 0 || ReplacementNum == 0;
+
+        default:
+            return true;
+    }
+}
+
+bool FSpellOptimizer::CollapsePassThrough()
+{
+    bool bChanged = false;
+    TArray<uint16, TInlineAllocator<4>> Replacement;
+
+    for (int32 Index = 0; Index < Work.Num(); ++Index)
+    {
+        if (!GetPassThrough(Index, Replacement))
+        {
+            continue;
+        }
+
+        const uint16 Target = static_cast<uint16>(Index);
+        bool bCanSplice = true;
+        for (const FWorkInstruction& Item : Work)
+        {
+            for (int32 ExitIndex = 0; ExitIndex < 2 && bCanSplice && !Item.bRemoved; ++ExitIndex)
+            {
+                bCanSplice = !Item.Exits[ExitIndex].Contains(Target) || CanSplice(Item, ExitIndex, Replacement.Num());
+            }
+        }
+        if (!bCanSplice)
+        {
+            continue;
+        }
+
+        for (FWorkInstruction& Item : Work)
+        {
+            for (TArray<uint16, TInlineAllocator<4>>& Exit : Item.Exits)
+            {
+                for (int32 Slot = Exit.Num() - 1; Slot >= 0; --Slot)
+                {
+                    if (Exit[Slot] == Target)
+                    {
+                        Exit.RemoveAt(Slot, 1, EAllowShrinking::No);
+                        Exit.Insert(Replacement.GetData(), Replacement.Num(), Slot);
+                    }
+                }
+            }
+        }
+
+        FWorkInstruction& Removed = Work[Index];
+        Removed.bRemoved = true;
+        Removed.Exits[0].Reset();
+        Removed.Exits[1].Reset();
+        CountAccess(Removed.Access, -1);
+        bChanged = true;
+    }
+
+    return bChanged;
+}
+
+void FSpellOptimizer::OptimizeLoops()
+{
+    // Fusing and hoisting need each loop referenced once, which unrolling gives up
+    while (FuseLoops())
+    {
+    }
+
+    bool bHoisted = true;
+    while (bHoisted)
+    {
+        bHoisted = false;
+        for (int32 Index = 0; Index < Work.Num(); ++Index)
+        {
+            bHoisted |= HoistInvariant(Index);
+        }
+    }
+
+    for (int32 Index = 0; Index < Work.Num(); ++Index)
+    {
+        if (!UnrollLoop(Index))
+        {
+            SetLoopFlags(Index);
+        }
+    }
+}
+
+bool FSpellOptimizer::FuseLoops()
+{
+    for (FWorkInstruction& Predecessor : Work)
+    {
+        for (int32 ExitIndex = 0; ExitIndex < 2 && !Predecessor.bRemoved; ++ExitIndex)
+        {
+            // Parallel branches run in separate scopes, so their loops stay apart
+            if (Predecessor.OpCode == ESpellOpCode::Parallel && ExitIndex == 0)
+            {
+                continue;
+            }
+
+            TArray<uint16, TInlineAllocator<4>>& Exit = Predecessor.Exits[ExitIndex];
+            for (int32 Slot = 0; Slot + 1 < Exit.Num(); ++Slot)
+            {
+                if (!CanFuse(Exit[Slot], Exit[Slot + 1]) || !CanSplice(Predecessor, ExitIndex, 0))
+                {
+                    continue;
+                }
+
+                // One loop runs both bodies per iteration, then the second loop's completion
+                FWorkInstruction& First = Work[Exit[Slot]];
+                FWorkInstruction& Second = Work[Exit[Slot + 1]];
+                First.Exits[0].Append(Second.Exits[0]);
+                First.Exits[1] = Second.Exits[1];
+
+                Second.bRemoved = true;
+                Second.Exits[0].Reset();
+                Second.Exits[1].Reset();
+                CountAccess(Second.Access, -1);
+
+                Exit.RemoveAt(Slot + 1, 1, EAllowShrinking::No);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool FSpellOptimizer::CanFuse(uint16 First, uint16 Second) const
+{
+    const FWorkInstruction& FirstLoop = Work[First];
+    const FWorkInstruction& SecondLoop = Work[Second];
+    if (First == Second || FirstLoop.OpCode != SecondLoop.OpCode || FirstLoop.bEntry || SecondLoop.bEntry
+        || FirstLoop.Exits[1].Num() > 0 || ReadsLoopRegisters(FirstLoop.OpCode))
+    {
+        return false;
+    }
+
+    const int32 Count = GetFixedIterationCount(FirstLoop);
+    if (Count == INDEX_NONE || Count != GetFixedIterationCount(SecondLoop))
+    {
+        return false;
+    }
+
+    // Paced loops keep their own timing, and rarity decides what the loop node writes
+    const UFlowNode* FirstNode = CastChecked<UFlowNode>(Program.Nodes[FirstLoop.NodeIndex]);
+    const UFlowNode* SecondNode = CastChecked<UFlowNode>(Program.Nodes[SecondLoop.NodeIndex]);
+    if (FirstNode->NodeRarity != SecondNode->NodeRarity || CanSuspend(FirstLoop) || CanSuspend(SecondLoop))
+    {
+        return false;
+    }
+
+    if (CountReferences(First) != 1 || CountReferences(Second) != 1)
+    {
+        return false;
+    }
+
+    FLoopRegion FirstBody;
+    FLoopRegion SecondBody;
+    GetRegion(FirstLoop.Exits[0], FirstBody);
+    GetRegion(SecondLoop.Exits[0], SecondBody);
+    if (FirstBody.bSuspends || SecondBody.bSuspends
+        || FirstBody.Instructions[First] || FirstBody.Instructions[Second]
+        || SecondBody.Instructions[First] || SecondBody.Instructions[Second])
+    {
+        return false;
+    }
+
+    // Only one body may act on the world, so world effects keep their order
+    if (FirstBody.Access.bHasSideEffects && (SecondBody.Access.bHasSideEffects || SecondLoop.Access.bHasSideEffects))
+    {
+        return false;
+    }
+
+    // Interleaved bodies must not see each other's writes, and the first body must not
+    // leave a value the second loop node used to overwrite
+    return !Conflicts(FirstBody.Access.Writes, SecondBody.Access.Reads)
+        && !Conflicts(SecondBody.Access.Writes, FirstBody.Access.Reads)
+        && !Conflicts(FirstBody.Access.Writes, SecondLoop.Access.Writes);
+}
+
+bool FSpellOptimizer::HoistInvariant(int32 Index)
+{
+    FWorkInstruction& Loop = Work[Index];
+    if (Loop.bRemoved || Loop.bEntry || Loop.Exits[0].Num() == 0 || CanSuspend(Loop))
+    {
+        return false;
+    }
+
+    // The hoisted node runs once up front, so the body must run at least once
+    if (GetFixedIterationCount(Loop) < 1)
+    {
+        return false;
+    }
+
+    // Only a leaf at the front of the body, so nothing in the body runs before it
+    const uint16 Target = Loop.Exits[0][0];
+    const FWorkInstruction& Candidate = Work[Target];
+    if (Candidate.OpCode != ESpellOpCode::Action || Candidate.bEntry
+        || Candidate.Exits[0].Num() > 0 || Candidate.Exits[1].Num() > 0
+        || Candidate.Access.bHasSideEffects || !Candidate.Access.bIdempotent
+        || CountReferences(Target) != 1)
+    {
+        return false;
+    }
+
+    FLoopRegion Rest;
+    GetRegion(MakeArrayView(Loop.Exits[0]).RightChop(1), Rest);
+    if (Rest.bSuspends || Rest.Instructions[Index])
+    {
+        return false;
+    }
+
+    // Its inputs must not change inside the loop, and nothing else in the loop may replace its outputs
+    if (Conflicts(Rest.Access.Writes, Candidate.Access.Reads) || Conflicts(Loop.Access.Writes, Candidate.Access.Reads)
+        || Conflicts(Candidate.Access.Writes, Rest.Access.Writes)
+        || Conflicts(Candidate.Access.Writes, Loop.Access.Writes) || Conflicts(Candidate.Access.Writes, Loop.Access.Reads))
+    {
+        return false;
+    }
+
+    const uint16 LoopIndex = static_cast<uint16>(Index);
+    for (const FWorkInstruction& Item : Work)
+    {
+        for (int32 ExitIndex = 0; ExitIndex < 2 && !Item.bRemoved; ++ExitIndex)
+        {
+            if (Item.Exits[ExitIndex].Contains(LoopIndex) && !CanSplice(Item, ExitIndex, 2))
+            {
+                return false;
+            }
+        }
+    }
+
+    for (FWorkInstruction& Item : Work)
+    {
+        for (TArray<uint16, TInlineAllocator<4>>& Exit : Item.Exits)
+        {
+            for (int32 Slot = Exit.Num() - 1; Slot >= 0; --Slot)
+            {
+                if (Exit[Slot] == LoopIndex)
+                {
+                    Exit.Insert(Target, Slot);
+                }
+            }
+        }
+    }
+
+    Loop.Exits[0].RemoveAt(0, 1, EAllowShrinking::No);
+    return true;
+}
+
+bool FSpellOptimizer::UnrollLoop(int32 Index)
+{
+    FWorkInstruction& Loop = Work[Index];
+    if (Loop.bRemoved || !SpellOptimizer::IsLoop(Loop.OpCode) || ReadsLoopRegisters(Loop.OpCode))
+    {
+        return false;
+    }
+
+    // A single iteration never waits, so only longer loops keep their pacing
+    const int32 Count = GetFixedIterationCount(Loop);
+    if (Count == INDEX_NONE || (Count > 1 && CanSuspend(Loop)))
+    {
+        return false;
+    }
+
+    const int32 NumUnrolled = Count * Loop.Exits[0].Num();
+    if (NumUnrolled > MaxUnrolledSuccessors)
+    {
+        return false;
+    }
+
+    // Successor ranges are 16 bit
+    int32 NumSuccessors = NumUnrolled - Loop.Exits[0].Num();
+    for (const FWorkInstruction& Item : Work)
+    {
+        NumSuccessors += Item.bRemoved ? 0 : Item.Exits[0].Num() + Item.Exits[1].Num();
+    }
+    if (NumSuccessors > MAX_uint16)
+    {
+        return false;
+    }
+
+    const TArray<uint16, TInlineAllocator<4>> Body = Loop.Exits[0];
+    Loop.Exits[0].Reset(NumUnrolled);
+    for (int32 Iteration = 0; Iteration < Count; ++Iteration)
+    {
+        Loop.Exits[0].Append(Body);
+    }
+
+    Loop.OpCode = ESpellOpCode::Unrolled;
+    Loop.Flags = ESpellInstructionFlags::None;
+    return true;
+}
+
+void FSpellOptimizer::SetLoopFlags(int32 Index)
+{
+    FWorkInstruction& Item = Work[Index];
+    if (Item.bRemoved || !SpellOptimizer::IsLoop(Item.OpCode))
+    {
+        return;
+    }
+
+    Item.Flags = ESpellInstructionFlags::None;
+    if (!HasLoopChecks(Item))
+    {
+        Item.Flags |= ESpellInstructionFlags::NoLoopChecks;
+    }
+    if (!ReadsLoopRegisters(Item.OpCode))
+    {
+        Item.Flags |= ESpellInstructionFlags::NoLoopRegisters;
+    }
+}
+
+void FSpellOptimizer::MarkConcurrentBranches()
+{
+    for (FWorkInstruction& Item : Work)
+    {
+        if (Item.bRemoved || Item.OpCode != ESpellOpCode::Parallel || Item.Exits[0].Num() < 2)
+        {
+            continue;
+        }
+
+        FLoopRegion Region;
+        GetRegion(Item.Exits[0], Region);
+        if (IsTaskSafe(Region))
+        {
+            Item.Flags |= ESpellInstructionFlags::ConcurrentBranches;
+        }
+    }
+}
+
+bool FSpellOptimizer::IsTaskSafe(const FLoopRegion& Region) const
+{
+    if (Region.bSuspends)
+    {
+        return false;
+    }
+
+    for (TConstSetBitIterator<> It(Region.Instructions); It; ++It)
+    {
+        const USpellNode* Node = Program.Nodes[Work[It.GetIndex()].NodeIndex];
+        if (!Node || !Node->IsTaskSafe())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int32 FSpellOptimizer::GetFixedIterationCount(const FWorkInstruction& Item) const
+{
+    if (!SpellOptimizer::IsLoop(Item.OpCode) || HasLoopChecks(Item) || IsWritten(ESpellRegister::IterationCount))
+    {
+        return INDEX_NONE;
+    }
+
+    const UFlowNode* FlowNode = CastChecked<UFlowNode>(Program.Nodes[Item.NodeIndex]);
+    return FMath::Max(FlowNode->GetIterationLimit(FlowNode->MaxIterations), 0);
+}
+
+bool FSpellOptimizer::HasLoopChecks(const FWorkInstruction& Item) const
+{
+    // Unset break, while and continue registers never stop a loop
+    const UFlowNode* FlowNode = CastChecked<UFlowNode>(Program.Nodes[Item.NodeIndex]);
+    const bool bCanBreak = FlowNode->bBreakOnCondition && IsWritten(FlowNode->BreakConditionSlot);
+
+    switch (Item.OpCode)
+    {
+        case ESpellOpCode::Loop:
+            return bCanBreak || IsWritten(ESpellRegister::ShouldContinue);
+        case ESpellOpCode::WhileLoop:
+            return IsWritten(ESpellRegister::Condition);
+        case ESpellOpCode::ForLoop:
+            return bCanBreak;
+        default:
+            return true;
+    }
+}
+
+bool FSpellOptimizer::ReadsLoopRegisters(ESpellOpCode OpCode) const
+{
+    switch (OpCode)
+    {
+        case ESpellOpCode::Loop:
+            return IsRead(ESpellRegister::LoopIndex) || IsRead(ESpellRegister::LoopTotal);
+        case ESpellOpCode::WhileLoop:
+            return IsRead(ESpellRegister::WhileIndex);
+        case ESpellOpCode::ForLoop:
+            return IsRead(ESpellRegister::ForIndex) || IsRead(ESpellRegister::ForTotal);
+        default:
+            return false;
+    }
+}
+
+bool FSpellOptimizer::CanSuspend(const FWorkInstruction& Item) const
+{
+    switch (Item.OpCode)
+    {
+        case ESpellOpCode::Delay:
+        case ESpellOpCode::Trigger:
+            return true;
+
+        case ESpellOpCode::Loop:
+        case ESpellOpCode::WhileLoop:
+        case ESpellOpCode::ForLoop:
+            return CastChecked<UFlowNode>(Program.Nodes[Item.NodeIndex])->ResolveIterationDelay() > 0.0f;
+
+        default:
+            return false;
+    }
+}
+
+void FSpellOptimizer::GetRegion(TConstArrayView<uint16> Roots, FLoopRegion& OutRegion) const
+{
+    OutRegion.Instructions.Init(false, Work.Num());
+
+    TArray<uint16> Pending(Roots.GetData(), Roots.Num());
+    while (Pending.Num() > 0)
+    {
+        const uint16 Index = Pending.Pop(EAllowShrinking::No);
+        if (OutRegion.Instructions[Index])
+        {
+            continue;
+        }
+
+        const FWorkInstruction& Item = Work[Index];
+        OutRegion.Instructions[Index] = true;
+        OutRegion.Access.Reads.CombineWithBitwiseOR(Item.Access.Reads, EBitwiseOperatorFlags::MaxSize);
+        OutRegion.Access.Writes.CombineWithBitwiseOR(Item.Access.Writes, EBitwiseOperatorFlags::MaxSize);
+        OutRegion.Access.bHasSideEffects |= Item.Access.bHasSideEffects;
+        OutRegion.bSuspends |= CanSuspend(Item);
+
+        Pending.Append(Item.Exits[0]);
+        Pending.Append(Item.Exits[1]);
+    }
+}
+
+int32 FSpellOptimizer::CountReferences(uint16 Index) const
+{
+    int32 Count = Work[Index].bEntry ? 1 : 0;
+    for (const FWorkInstruction& Item : Work)
+    {
+        for (int32 ExitIndex = 0; ExitIndex < 2 && !Item.bRemoved; ++ExitIndex)
+        {
+            for (uint16 Successor : Item.Exits[ExitIndex])
+            {
+                Count += Successor == Index ? 1 : 0;
+            }
+        }
+    }
+    return Count;
+}
+
+bool FSpellOptimizer::Conflicts(const TBitArray<>& Writes, const TBitArray<>& Other) const
+{
+    for (TConstSetBitIterator<> It(Writes); It; ++It)
+    {
+        const int32 Slot = It.GetIndex();
+        if (Slot < Other.Num() && Other[Slot] && ReadCounts[Slot] > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FSpellOptimizer::Rebuild()
+{
+    // Re-emit live instructions in depth-first order from the entry points, like the compiler does
+    TArray<uint16> OldToNew;
+    OldToNew.Init(FSpellGraphIndex::InvalidNodeIndex, Work.Num());
+    TArray<uint16> NewToOld;
+
+    TArray<uint16> Pending;
+    for (int32 Index = Program.EntryPoints.Num() - 1; Index >= 0; --Index)
+    {
+        Pending.Add(Program.EntryPoints[Index]);
+    }
+
+    while (Pending.Num() > 0)
+    {
+        const uint16 OldIndex = Pending.Pop(EAllowShrinking::No);
+        if (OldToNew[OldIndex] != FSpellGraphIndex::InvalidNodeIndex || Work[OldIndex].bRemoved)
+        {
+            continue;
+        }
+
+        OldToNew[OldIndex] = static_cast<uint16>(NewToOld.Add(OldIndex));
+
+        const FWorkInstruction& Item = Work[OldIndex];
+        for (int32 ExitIndex = 1; ExitIndex >= 0; --ExitIndex)
+        {
+            for (int32 Slot = Item.Exits[ExitIndex].Num() - 1; Slot >= 0; --Slot)
+            {
+                Pending.Add(Item.Exits[ExitIndex][Slot]);
+            }
+        }
+    }
+
+    TArray<FSpellInstruction> Instructions;
+    TArray<uint16> Successors;
+    TArray<USpellNode*> Nodes;
+    Instructions.Reserve(NewToOld.Num());
+    Nodes.Reserve(NewToOld.Num());
+
+    for (uint16 OldIndex : NewToOld)
+    {
+        const FWorkInstruction& Item = Work[OldIndex];
+        FSpellInstruction& Instruction = Instructions.AddDefaulted_GetRef();
+        Instruction.OpCode = Item.OpCode;
+        Instruction.Flags = Item.Flags;
+        Instruction.NodeIndex = static_cast<uint16>(Nodes.Add(Program.Nodes[Item.NodeIndex]));
+
+        for (int32 ExitIndex = 0; ExitIndex < 2; ++ExitIndex)
+        {
+            Instruction.Exits[ExitIndex].Start = static_cast<uint16>(Successors.Num());
+            for (uint16 Successor : Item.Exits[ExitIndex])
+            {
+                Successors.Add(OldToNew[Successor]);
+            }
+            Instruction.Exits[ExitIndex].Num = static_cast<uint16>(Item.Exits[ExitIndex].Num());
+        }
+    }
+
+    for (uint16& Entry : Program.EntryPoints)
+    {
+        Entry = OldToNew[Entry];
+    }
+    Program.EntryPoint = OldToNew[Program.EntryPoint];
+
+    Program.Instructions = MoveTemp(Instructions);
+    Program.Successors = MoveTemp(Successors);
+    Program.Nodes = MoveTemp(Nodes);
+    Program.MaxDepth = Program.ComputeMaxDepth();
+}
@@ -0,0 +1,64 @@
+#include "Spells/SpellRegisters.h"
+
+FSpellRegisterLayout::FSpellRegisterLayout()
+{
+    SlotNames.Reserve(BuiltinCount);
+    for (int32 Index = 0; Index < BuiltinCount; ++Index)
+    {
+        AddSlot(GetRegisterName(static_cast<ESpellRegister>(Index)));
+    }
+}
+
+const TSharedRef<const FSpellRegisterLayout>& FSpellRegisterLayout::GetDefault()
+{
+    static const TSharedRef<const FSpellRegisterLayout> DefaultLayout = MakeShared<const FSpellRegisterLayout>();
+    return DefaultLayout;
+}
+
+FName FSpellRegisterLayout::GetRegisterName(ESpellRegister Register)
+{
+    static const FName RegisterNames[BuiltinCount] =
+    {
+        TEXT("Condition"),
+        TEXT("ConditionResult"),
+        TEXT("LastConditionNode"),
+        TEXT("BoolCondition"),
+        TEXT("ConditionValue"),
+        TEXT("CompareValue"),
+        TEXT("GateOpen"),
+        TEXT("ShouldContinue"),
+        TEXT("DelayTime"),
+        TEXT("IterationCount"),
+        TEXT("SequenceIndex"),
+        TEXT("SequenceTotal"),
+        TEXT("LoopIndex"),
+        TEXT("LoopTotal"),
+        TEXT("WhileIndex"),
+        TEXT("ForIndex"),
+        TEXT("ForTotal"),
+        TEXT("Value"),
+        TEXT("NewValue"),
+        TEXT("OperandB"),
+        TEXT("CurrentValue"),
+        TEXT("PreviousValue"),
+        TEXT("ValueChanged"),
+    };
+    return Register < ESpellRegister::MAX ? RegisterNames[static_cast<int32>(Register)] : NAME_None;
+}
+
+int32 FSpellRegisterLayout::AddSlot(FName Name)
+{
+    if (Name.IsNone())
+    {
+        return InvalidSlot;
+    }
+
+    if (const int32* Existing = NameToSlot.Find(Name))
+    {
+        return *Existing;
+    }
+
+    const int32 Slot = SlotNames.Add(Name);
+    NameToSlot.Add(Name, Slot);
+    return Slot;
+}
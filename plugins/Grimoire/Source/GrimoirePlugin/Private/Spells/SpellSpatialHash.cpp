@@ -0,0 +1,74 @@
+#include "Spells/SpellSpatialHash.h"
+
+void FSpellSpatialHash::Build(TConstArrayView<float> X, TConstArrayView<float> Y, TConstArrayView<float> Z, float ContactDistance)
+{
+    const int32 NumPoints = X.Num();
+    check(Y.Num() == NumPoints && Z.Num() == NumPoints);
+
+    CellSize = FMath::Max(ContactDistance, UE_KINDA_SMALL_NUMBER);
+    const float InvCellSize = 1.0f / CellSize;
+
+    // About two buckets per point keeps collisions between unrelated cells rare
+    const uint32 NumBuckets = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(NumPoints * 2, 1)));
+    BucketMask = NumBuckets - 1;
+
+    Points.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+    Cells.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+    SortedPoints.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+    BucketStart.Reset();
+    BucketStart.SetNumZeroed(NumBuckets + 1);
+
+    // Count points per bucket
+    for (int32 Index = 0; Index < NumPoints; ++Index)
+    {
+        Points[Index] = FVector3f(X[Index], Y[Index], Z[Index]);
+        Cells[Index] = FIntVector(
+            FMath::FloorToInt32(X[Index] * InvCellSize),
+            FMath::FloorToInt32(Y[Index] * InvCellSize),
+            FMath::FloorToInt32(Z[Index] * InvCellSize));
+        ++BucketStart[GetBucket(Cells[Index]) + 1];
+    }
+
+    for (uint32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        BucketStart[Bucket + 1] += BucketStart[Bucket];
+    }
+
+    // Scatter, using a copy of the starts as write cursors
+    TArray<int32> Cursors(BucketStart.GetData(), NumBuckets);
+    for (int32 Index = 0; Index < NumPoints; ++Index)
+    {
+        SortedPoints[Cursors[GetBucket(Cells[Index])]++] = Index;
+    }
+}
+
+void FSpellSpatialHash::FindPairs(TArray<TPair<int32, int32>>& OutPairs) const
+{
+    const float ContactDistanceSquared = CellSize * CellSize;
+
+    for (int32 Index = 0; Index < Points.Num(); ++Index)
+    {
+        const FIntVector& Cell = Cells[Index];
+        for (int32 DZ = -1; DZ <= 1; ++DZ)
+        {
+            for (int32 DY = -1; DY <= 1; ++DY)
+            {
+                for (int32 DX = -1; DX <= 1; ++DX)
+                {
+                    const FIntVector Neighbour = Cell + FIntVector(DX, DY, DZ);
+                    const uint32 Bucket = GetBucket(Neighbour);
+                    for (int32 Slot = BucketStart[Bucket]; Slot < BucketStart[Bucket + 1]; ++Slot)
+                    {
+                        // Buckets are shared by cells that hash alike, so match the cell to report each pair once
+                        const int32 Other = SortedPoints[Slot];
+                        if (Other > Index && Cells[Other] == Neighbour
+                            && FVector3f::DistSquared(Points[Index], Points[Other]) <= ContactDistanceSquared)
+                        {
+                            OutPairs.Emplace(Index, Other);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include "Spells/SpellValue.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace SpellValue
+{
+    /** FString hashes and compares ignoring case by default; interned strings must round-trip exactly */
+    struct FCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, int32, false>
+    {
+        static bool Matches(const FString& A, const FString& B)
+        {
+            return A.Equals(B, ESearchCase::CaseSensitive);
+        }
+
+        static uint32 GetKeyHash(const FString& Key)
+        {
+            return FCrc::StrCrc32(*Key);
+        }
+    };
+
+    /** Interned strings. Entries are never removed, so handles and references stay valid for the process lifetime. */
+    class FStringTable
+    {
+    public:
+        FStringTable()
+        {
+            Strings.Add(MakeUnique<FString>());
+            Handles.Add(FString(), 0);
+        }
+
+        int32 Intern(const FString& String)
+        {
+            {
+                FReadScopeLock ReadLock(Lock);
+                if (const int32* Handle = Handles.Find(String))
+                {
+                    return *Handle;
+                }
+            }
+
+            FWriteScopeLock WriteLock(Lock);
+            if (const int32* Handle = Handles.Find(String))
+            {
+                return *Handle;
+            }
+
+            const int32 Handle = Strings.Add(MakeUnique<FString>(String));
+            Handles.Add(String, Handle);
+            return Handle;
+        }
+
+        const FString& Get(int32 Handle) const
+        {
+            FReadScopeLock ReadLock(Lock);
+            return *Strings[Handle];
+        }
+
+    private:
+        mutable FRWLock Lock;
+        TArray<TUniquePtr<FString>> Strings;
+        TMap<FString, int32, FDefaultSetAllocator, FCaseSensitiveKeyFuncs> Handles;
+    };
+
+    static FStringTable& GetStringTable()
+    {
+        static FStringTable Table;
+        return Table;
+    }
+}
+
+FSpellValue::FSpellValue(const FGWTVariableValue& Value)
+    : FSpellValue()
+{
+    switch (Value.Type)
+    {
+        case EGWTVariableType::Float:
+            *this = FromFloat(Value.FloatValue);
+            break;
+        case EGWTVariableType::Int:
+            *this = FromInt(Value.IntValue);
+            break;
+        case EGWTVariableType::Bool:
+            *this = FromBool(Value.BoolValue);
+            break;
+        case EGWTVariableType::String:
+            *this = FromString(Value.StringValue);
+            break;
+        case EGWTVariableType::Vector:
+            *this = FromVector(Value.VectorValue);
+            break;
+        case EGWTVariableType::Object:
+            *this = FromObject(Value.ObjectValue.Get());
+            break;
+        default:
+            break;
+    }
+}
+
+FGWTVariableValue FSpellValue::ToVariableValue() const
+{
+    FGWTVariableValue Result;
+    Result.Type = Type;
+
+    switch (Type)
+    {
+        case EGWTVariableType::Float:
+            Result.FloatValue = GetFloat();
+            break;
+        case EGWTVariableType::Int:
+            Result.IntValue = GetInt();
+            break;
+        case EGWTVariableType::Bool:
+            Result.BoolValue = GetBool();
+            break;
+        case EGWTVariableType::String:
+            Result.StringValue = GetString();
+            break;
+        case EGWTVariableType::Vector:
+            Result.VectorValue = FVector(GetVector());
+            break;
+        case EGWTVariableType::Object:
+            Result.ObjectValue = GetObject();
+            break;
+        default:
+            break;
+    }
+
+    return Result;
+}
+
+FSpellValue FSpellValue::FromVector(const FVector3f& In)
+{
+    FSpellValue V;
+    V.Type = EGWTVariableType::Vector;
+    V.Payload.Vector[0] = In.X;
+    V.Payload.Vector[1] = In.Y;
+    V.Payload.Vector[2] = In.Z;
+    return V;
+}
+
+FSpellValue FSpellValue::FromString(const FString& In)
+{
+    FSpellValue V;
+    V.Type = EGWTVariableType::String;
+    V.Payload.StringHandle = SpellValue::GetStringTable().Intern(In);
+    return V;
+}
+
+FSpellValue FSpellValue::FromObject(const UObject* In)
+{
+    FSpellValue V;
+    V.Type = EGWTVariableType::Object;
+
+    const FWeakObjectPtr WeakObject(In);
+    FMemory::Memcpy(V.Payload.Object, &WeakObject, sizeof(FWeakObjectPtr));
+    return V;
+}
+
+FVector3f FSpellValue::GetVector() const
+{
+    return Type == EGWTVariableType::Vector
+        ? FVector3f(Payload.Vector[0], Payload.Vector[1], Payload.Vector[2])
+        : FVector3f::ZeroVector;
+}
+
+const FString& FSpellValue::GetString() const
+{
+    return SpellValue::GetStringTable().Get(Type == EGWTVariableType::String ? Payload.StringHandle : 0);
+}
+
+UObject* FSpellValue::GetObject() const
+{
+    if (Type != EGWTVariableType::Object)
+    {
+        return nullptr;
+    }
+
+    FWeakObjectPtr WeakObject;
+    FMemory::Memcpy(&WeakObject, Payload.Object, sizeof(FWeakObjectPtr));
+    return WeakObject.Get();
+}
+
+FString FSpellValue::ToString() const
+{
+    switch (Type)
+    {
+        case EGWTVariableType::Float:
+            return FString::Printf(TEXT("%.2f"), GetFloat());
+        case EGWTVariableType::Int:
+            return FString::Printf(TEXT("%d"), GetInt());
+        case EGWTVariableType::Bool:
+            return GetBool() ? TEXT("true") : TEXT("false");
+        case EGWTVariableType::String:
+            return GetString();
+        case EGWTVariableType::Vector:
+            return GetVector().ToString();
+        case EGWTVariableType::Object:
+            return GetNameSafe(GetObject());
+        default:
+            return TEXT("None");
+    }
+}
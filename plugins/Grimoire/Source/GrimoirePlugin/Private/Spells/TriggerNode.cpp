@@ -1,13 +1,13 @@
 // Source/GrimoirePlugin/Private/TriggerNode.cpp
-#include "TriggerNode.h"
+#include "Spells/TriggerNode.h"
+#include "Spells/SpellExecutionContext.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
 
-void UTriggerNode::Execute(UObject* Context)
+void UTriggerNode::OnExecute(USpellExecutionContext* Context)
 {
-    Super::Execute(Context); // Validate and propagate
+    Super::OnExecute(Context);
 
-    UWorld* World = Context ? Context->GetWorld() : nullptr;
+    UWorld* World = Context->Caster ? Context->Caster->GetWorld() : nullptr;
     if (!World) return;
 
     switch (EventType)
@@ -28,10 +28,7 @@ void UTriggerNode::Execute(UObject* Context)
             }
             break;
         case ETriggerEventType::OnTimer:
-            if (TimerInterval > 0.0f)
-            {
-                World->GetTimerManager().SetTimer(TimerHandle, FTimerDelegate::CreateUObject(this, &UTriggerNode::HandleTimerTrigger, Context), TimerInterval, true);
-            }
+            // Repeats are scheduled by the interpreter, see ESpellOpCode::Trigger
             break;
         default:
             break;
@@ -43,8 +40,13 @@ float UTriggerNode::GetBasePower() const
     return 0.0f; // Triggers don't have power; modifier only
 }
 
-void UTriggerNode::HandleTimerTrigger(UObject* Context)
+bool UTriggerNode::GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const
+{
+    // Only logs; timer repeats are driven by the interpreter
+    return true;
+}
+
+void UTriggerNode::HandleTimerTrigger(USpellExecutionContext* Context)
 {
     UE_LOG(LogTemp, Log, TEXT("Trigger: Timer Fired"));
-    Super::Execute(Context); // Re-propagate on timer
 }
\ No newline at end of file
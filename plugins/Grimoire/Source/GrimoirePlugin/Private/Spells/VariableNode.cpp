@@ -1,5 +1,5 @@
 #include "Spells/VariableNode.h"
-#include "SpellExecutionContext.h"
+#include "Spells/SpellExecutionContext.h"
 #include "Components/GrimoireComponent.h"
 #include "Engine/World.h"
 
@@ -85,7 +85,7 @@ void UVariableNode::OnExecute(USpellExecutionContext* Context)
         *UEnum::GetValueAsString(Operation));
     
     // Initialize variable if it doesn't exist
-    if (!Context->HasVariable(VariableName, bIsGlobal))
+    if (!HasVariableValue(Context))
     {
         InitializeVariable(Context);
     }
@@ -97,8 +97,8 @@ void UVariableNode::OnExecute(USpellExecutionContext* Context)
     }
     
     // Get current value
-    FGWTVariableValue CurrentValue = GetVariableValue(Context);
-    FGWTVariableValue PreviousValue = CurrentValue; // Store for comparison
+    FSpellValue CurrentValue = ReadVariable(Context);
+    const FSpellValue PreviousValue = CurrentValue; // Store for comparison
     
     // Perform the operation
     switch (Operation)
@@ -110,51 +110,40 @@ void UVariableNode::OnExecute(USpellExecutionContext* Context)
         case EVariableNodeOperation::Set:
         {
             // Set new value from input or default
-            FGWTVariableValue NewValue = CreateDefaultValue();
-            
-            if (Context->HasVariable(TEXT("NewValue")))
+            const FSpellValue& NewValueInput = Context->GetRegister(ESpellRegister::NewValue);
+            const FSpellValue& ValueInput = Context->GetRegister(ESpellRegister::Value);
+            if (NewValueInput.IsSet())
+            {
+                CurrentValue = NewValueInput;
+            }
+            else if (ValueInput.IsSet())
             {
-                NewValue = Context->GetVariable(TEXT("NewValue"));
+                CurrentValue = ConvertToType(ValueInput, VariableType);
             }
-            else if (Context->HasVariable(TEXT("Value")))
+            else
             {
-                FGWTVariableValue InputValue = Context->GetVariable(TEXT("Value"));
-                NewValue = ConvertToType(InputValue, VariableType);
+                CurrentValue = CreateDefaultValue();
             }
             
-            SetVariableValue(Context, NewValue);
-            CurrentValue = NewValue;
+            WriteVariable(Context, CurrentValue);
             break;
         }
         
         default:
         {
             // Math operations
-            FGWTVariableValue OperandB = CreateDefaultValue();
-            
-            if (Context->HasVariable(TEXT("OperandB")))
-            {
-                OperandB = Context->GetVariable(TEXT("OperandB"));
-            }
-            else if (Context->HasVariable(TEXT("Value")))
-            {
-                OperandB = Context->GetVariable(TEXT("Value"));
-            }
+            const FSpellValue& OperandInput = Context->GetRegister(ESpellRegister::OperandB);
+            const FSpellValue& ValueInput = Context->GetRegister(ESpellRegister::Value);
+            const FSpellValue OperandB = OperandInput.IsSet() ? OperandInput : ValueInput.IsSet() ? ValueInput : CreateDefaultValue();
             
-            FGWTVariableValue Result = PerformMathOperation(CurrentValue, OperandB, Operation);
-            SetVariableValue(Context, Result);
-            CurrentValue = Result;
+            CurrentValue = ApplyMathOperation(CurrentValue, OperandB, Operation);
+            WriteVariable(Context, CurrentValue);
             break;
         }
     }
     
     // Check if value changed
-    bool bValueChanged = (CurrentValue.Type != PreviousValue.Type) ||
-                        (CurrentValue.FloatValue != PreviousValue.FloatValue) ||
-                        (CurrentValue.IntValue != PreviousValue.IntValue) ||
-                        (CurrentValue.BoolValue != PreviousValue.BoolValue) ||
-                        (CurrentValue.StringValue != PreviousValue.StringValue) ||
-                        (CurrentValue.VectorValue != PreviousValue.VectorValue);
+    const bool bValueChanged = CurrentValue != PreviousValue;
     
     // Update history if value changed and rarity supports it
     if (bValueChanged && NodeRarity >= EItemRarity::Rare)
@@ -169,292 +158,339 @@ void UVariableNode::OnExecute(USpellExecutionContext* Context)
     }
     
     // Set output variables
-    Context->SetVariable(TEXT("CurrentValue"), CurrentValue);
-    Context->SetVariable(TEXT("PreviousValue"), PreviousValue);
-    Context->SetVariable(TEXT("ValueChanged"), FGWTVariableValue::FromBool(bValueChanged));
+    Context->SetRegister(ESpellRegister::CurrentValue, CurrentValue);
+    Context->SetRegister(ESpellRegister::PreviousValue, PreviousValue);
+    Context->SetRegister(ESpellRegister::ValueChanged, FSpellValue::FromBool(bValueChanged));
     
     // Apply rarity effects
     ApplyRarityEffects(Context);
     
     UE_LOG(LogTemp, Log, TEXT("Variable %s: %s -> %s (Changed: %s)"), 
         *VariableName.ToString(),
-        *PreviousValue.StringValue,
-        *CurrentValue.StringValue,
+        *PreviousValue.ToString(),
+        *CurrentValue.ToString(),
         bValueChanged ? TEXT("Yes") : TEXT("No"));
 }
 
 FGWTVariableValue UVariableNode::GetVariableValue(USpellExecutionContext* Context)
 {
-    if (Context->HasVariable(VariableName, bIsGlobal))
+    return Context ? ReadVariable(Context).ToVariableValue() : CreateDefaultValue().ToVariableValue();
+}
+
+void UVariableNode::SetVariableValue(USpellExecutionContext* Context, const FGWTVariableValue& Value)
+{
+    if (Context)
     {
-        return Context->GetVariable(VariableName, bIsGlobal);
+        WriteVariable(Context, FSpellValue(Value));
     }
+}
+
+FGWTVariableValue UVariableNode::PerformMathOperation(const FGWTVariableValue& A, const FGWTVariableValue& B, EVariableNodeOperation Op)
+{
+    return ApplyMathOperation(FSpellValue(A), FSpellValue(B), Op).ToVariableValue();
+}
+
+FSpellValue UVariableNode::ReadVariable(USpellExecutionContext* Context) const
+{
+    if (VariableSlot == FSpellRegisterLayout::InvalidSlot)
+    {
+        return Context->HasVariable(VariableName, bIsGlobal) ? FSpellValue(Context->GetVariable(VariableName, bIsGlobal)) : CreateDefaultValue();
+    }
+
+    const FSpellValue& Value = Context->GetRegister(VariableSlot, bIsGlobal);
     
     // Return default if variable doesn't exist
-    return CreateDefaultValue();
+    return Value.IsSet() ? Value : CreateDefaultValue();
 }
 
-void UVariableNode::SetVariableValue(USpellExecutionContext* Context, const FGWTVariableValue& Value)
+void UVariableNode::WriteVariable(USpellExecutionContext* Context, const FSpellValue& Value)
 {
-    Context->SetVariable(VariableName, Value, bIsGlobal);
+    if (VariableSlot != FSpellRegisterLayout::InvalidSlot)
+    {
+        Context->SetRegister(VariableSlot, Value, bIsGlobal);
+    }
+    else
+    {
+        Context->SetVariable(VariableName, Value.ToVariableValue(), bIsGlobal);
+    }
 }
 
-FGWTVariableValue UVariableNode::PerformMathOperation(const FGWTVariableValue& A, const FGWTVariableValue& B, EVariableNodeOperation Op)
+bool UVariableNode::HasVariableValue(USpellExecutionContext* Context) const
 {
-    FGWTVariableValue Result = A;
+    if (VariableSlot != FSpellRegisterLayout::InvalidSlot)
+    {
+        return Context->HasRegister(VariableSlot, bIsGlobal);
+    }
+    return Context->HasVariable(VariableName, bIsGlobal);
+}
+
+void UVariableNode::ResolveRegisters(FSpellRegisterLayout& Layout)
+{
+    VariableSlot = Layout.AddSlot(VariableName);
+}
+
+bool UVariableNode::GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const
+{
+    OutAccess.Read(VariableSlot);
+    OutAccess.Read(ESpellRegister::NewValue);
+    OutAccess.Read(ESpellRegister::Value);
+    OutAccess.Read(ESpellRegister::OperandB);
+
+    OutAccess.Write(VariableSlot);
+    OutAccess.Write(ESpellRegister::CurrentValue);
+    OutAccess.Write(ESpellRegister::PreviousValue);
+    OutAccess.Write(ESpellRegister::ValueChanged);
+
+    // History and persistent values are kept on the node itself and outlive the cast
+    if (NodeRarity >= EItemRarity::Rare || bPersistent)
+    {
+        OutAccess.bHasSideEffects = true;
+    }
+
+    // A second Get sees the value the first one initialized; Set and math ops change PreviousValue
+    OutAccess.bIdempotent = Operation == EVariableNodeOperation::Get;
+
+    switch (NodeRarity)
+    {
+        case EItemRarity::Uncommon:  OutAccess.Write(Layout, TEXT("AutoConvert")); break;
+        case EItemRarity::Rare:      OutAccess.Write(Layout, TEXT("HistoryCount")); break;
+        case EItemRarity::Epic:      OutAccess.Write(Layout, TEXT("VariableAverage")); break;
+        case EItemRarity::Legendary: OutAccess.Write(Layout, TEXT("HasPersistentMemory")); break;
+        default: break;
+    }
+    return true;
+}
+
+bool UVariableNode::IsTaskSafe() const
+{
+    // History and persistent values live on the node, which concurrent branches share
+    return NodeRarity < EItemRarity::Rare && !bPersistent;
+}
+
+FSpellValue UVariableNode::ApplyMathOperation(const FSpellValue& A, const FSpellValue& B, EVariableNodeOperation Op) const
+{
+    const EGWTVariableType TypeA = A.GetType();
+    const EGWTVariableType TypeB = B.GetType();
+    const bool bFloats = TypeA == EGWTVariableType::Float && TypeB == EGWTVariableType::Float;
+    const bool bInts = TypeA == EGWTVariableType::Int && TypeB == EGWTVariableType::Int;
+    const bool bVectors = TypeA == EGWTVariableType::Vector && TypeB == EGWTVariableType::Vector;
     
     switch (Op)
     {
         case EVariableNodeOperation::Add:
-            if (A.Type == EGWTVariableType::Float && B.Type == EGWTVariableType::Float)
+            if (bFloats)
             {
-                Result.FloatValue = A.FloatValue + B.FloatValue;
+                return FSpellValue::FromFloat(A.GetFloat() + B.GetFloat());
             }
-            else if (A.Type == EGWTVariableType::Int && B.Type == EGWTVariableType::Int)
+            if (bInts)
             {
-                Result.IntValue = A.IntValue + B.IntValue;
+                return FSpellValue::FromInt(A.GetInt() + B.GetInt());
             }
-            else if (A.Type == EGWTVariableType::Vector && B.Type == EGWTVariableType::Vector)
+            if (bVectors)
             {
-                Result.VectorValue = A.VectorValue + B.VectorValue;
+                return FSpellValue::FromVector(A.GetVector() + B.GetVector());
             }
             break;
             
         case EVariableNodeOperation::Subtract:
-            if (A.Type == EGWTVariableType::Float && B.Type == EGWTVariableType::Float)
+            if (bFloats)
             {
-                Result.FloatValue = A.FloatValue - B.FloatValue;
+                return FSpellValue::FromFloat(A.GetFloat() - B.GetFloat());
             }
-            else if (A.Type == EGWTVariableType::Int && B.Type == EGWTVariableType::Int)
+            if (bInts)
             {
-                Result.IntValue = A.IntValue - B.IntValue;
+                return FSpellValue::FromInt(A.GetInt() - B.GetInt());
             }
-            else if (A.Type == EGWTVariableType::Vector && B.Type == EGWTVariableType::Vector)
+            if (bVectors)
             {
-                Result.VectorValue = A.VectorValue - B.VectorValue;
+                return FSpellValue::FromVector(A.GetVector() - B.GetVector());
             }
             break;
             
         case EVariableNodeOperation::Multiply:
-            if (A.Type == EGWTVariableType::Float && B.Type == EGWTVariableType::Float)
+            if (bFloats)
             {
-                Result.FloatValue = A.FloatValue * B.FloatValue;
+                return FSpellValue::FromFloat(A.GetFloat() * B.GetFloat());
             }
-            else if (A.Type == EGWTVariableType::Int && B.Type == EGWTVariableType::Int)
+            if (bInts)
             {
-                Result.IntValue = A.IntValue * B.IntValue;
+                return FSpellValue::FromInt(A.GetInt() * B.GetInt());
             }
-            else if (A.Type == EGWTVariableType::Vector && B.Type == EGWTVariableType::Float)
+            if (TypeA == EGWTVariableType::Vector && TypeB == EGWTVariableType::Float)
             {
-                Result.VectorValue = A.VectorValue * B.FloatValue;
+                return FSpellValue::FromVector(A.GetVector() * B.GetFloat());
             }
             break;
             
         case EVariableNodeOperation::Divide:
-            if (A.Type == EGWTVariableType::Float && B.Type == EGWTVariableType::Float && B.FloatValue != 0.0f)
+            if (bFloats && B.GetFloat() != 0.0f)
             {
-                Result.FloatValue = A.FloatValue / B.FloatValue;
+                return FSpellValue::FromFloat(A.GetFloat() / B.GetFloat());
             }
-            else if (A.Type == EGWTVariableType::Int && B.Type == EGWTVariableType::Int && B.IntValue != 0)
+            if (bInts && B.GetInt() != 0)
             {
-                Result.IntValue = A.IntValue / B.IntValue;
+                return FSpellValue::FromInt(A.GetInt() / B.GetInt());
             }
             break;
             
         case EVariableNodeOperation::Min:
-            if (A.Type == EGWTVariableType::Float && B.Type == EGWTVariableType::Float)
+            if (bFloats)
             {
-                Result.FloatValue = FMath::Min(A.FloatValue, B.FloatValue);
+                return FSpellValue::FromFloat(FMath::Min(A.GetFloat(), B.GetFloat()));
             }
-            else if (A.Type == EGWTVariableType::Int && B.Type == EGWTVariableType::Int)
+            if (bInts)
             {
-                Result.IntValue = FMath::Min(A.IntValue, B.IntValue);
+                return FSpellValue::FromInt(FMath::Min(A.GetInt(), B.GetInt()));
             }
             break;
             
         case EVariableNodeOperation::Max:
-            if (A.Type == EGWTVariableType::Float && B.Type == EGWTVariableType::Float)
+            if (bFloats)
             {
-                Result.FloatValue = FMath::Max(A.FloatValue, B.FloatValue);
+                return FSpellValue::FromFloat(FMath::Max(A.GetFloat(), B.GetFloat()));
             }
-            else if (A.Type == EGWTVariableType::Int && B.Type == EGWTVariableType::Int)
+            if (bInts)
             {
-                Result.IntValue = FMath::Max(A.IntValue, B.IntValue);
+                return FSpellValue::FromInt(FMath::Max(A.GetInt(), B.GetInt()));
             }
             break;
             
         case EVariableNodeOperation::Clamp:
-            if (A.Type == EGWTVariableType::Float)
+            if (TypeA == EGWTVariableType::Float)
             {
-                Result.FloatValue = FMath::Clamp(A.FloatValue, ClampMin, ClampMax);
+                return FSpellValue::FromFloat(FMath::Clamp(A.GetFloat(), ClampMin, ClampMax));
             }
-            else if (A.Type == EGWTVariableType::Int)
+            if (TypeA == EGWTVariableType::Int)
             {
-                Result.IntValue = FMath::Clamp(A.IntValue, static_cast<int32>(ClampMin), static_cast<int32>(ClampMax));
+                return FSpellValue::FromInt(FMath::Clamp(A.GetInt(), static_cast<int32>(ClampMin), static_cast<int32>(ClampMax)));
             }
             break;
             
         case EVariableNodeOperation::Increment:
-            if (A.Type == EGWTVariableType::Float)
+            if (TypeA == EGWTVariableType::Float)
             {
-                Result.FloatValue = A.FloatValue + 1.0f;
+                return FSpellValue::FromFloat(A.GetFloat() + 1.0f);
             }
-            else if (A.Type == EGWTVariableType::Int)
+            if (TypeA == EGWTVariableType::Int)
             {
-                Result.IntValue = A.IntValue + 1;
+                return FSpellValue::FromInt(A.GetInt() + 1);
             }
             break;
             
         case EVariableNodeOperation::Decrement:
-            if (A.Type == EGWTVariableType::Float)
+            if (TypeA == EGWTVariableType::Float)
             {
-                Result.FloatValue = A.FloatValue - 1.0f;
+                return FSpellValue::FromFloat(A.GetFloat() - 1.0f);
             }
-            else if (A.Type == EGWTVariableType::Int)
+            if (TypeA == EGWTVariableType::Int)
             {
-                Result.IntValue = A.IntValue - 1;
+                return FSpellValue::FromInt(A.GetInt() - 1);
             }
             break;
+
+        default:
+            break;
     }
     
-    return Result;
+    // Unsupported type combinations leave the value unchanged
+    return A;
 }
 
-FGWTVariableValue UVariableNode::CreateDefaultValue()
+FSpellValue UVariableNode::CreateDefaultValue() const
 {
-    FGWTVariableValue DefaultValue;
-    DefaultValue.Type = VariableType;
-    
     switch (VariableType)
     {
         case EGWTVariableType::Float:
-            DefaultValue.FloatValue = DefaultFloatValue;
-            break;
+            return FSpellValue::FromFloat(DefaultFloatValue);
         case EGWTVariableType::Int:
-            DefaultValue.IntValue = DefaultIntValue;
-            break;
+            return FSpellValue::FromInt(DefaultIntValue);
         case EGWTVariableType::Bool:
-            DefaultValue.BoolValue = DefaultBoolValue;
-            break;
+            return FSpellValue::FromBool(DefaultBoolValue);
         case EGWTVariableType::String:
-            DefaultValue.StringValue = DefaultStringValue;
-            break;
+            return FSpellValue::FromString(DefaultStringValue);
         case EGWTVariableType::Vector:
-            DefaultValue.VectorValue = DefaultVectorValue;
-            break;
+            return FSpellValue::FromVector(DefaultVectorValue);
         default:
-            break;
+            return FSpellValue();
     }
-    
-    return DefaultValue;
 }
 
 void UVariableNode::InitializeVariable(USpellExecutionContext* Context)
 {
-    FGWTVariableValue InitialValue = CreateDefaultValue();
-    Context->SetVariable(VariableName, InitialValue, bIsGlobal);
+    WriteVariable(Context, CreateDefaultValue());
     
     UE_LOG(LogTemp, Log, TEXT("Initialized variable %s with default value"), *VariableName.ToString());
 }
 
-FGWTVariableValue UVariableNode::ConvertToType(const FGWTVariableValue& Value, EGWTVariableType TargetType)
+FSpellValue UVariableNode::ConvertToType(const FSpellValue& Value, EGWTVariableType TargetType) const
 {
-    FGWTVariableValue Result;
-    Result.Type = TargetType;
+    const EGWTVariableType SourceType = Value.GetType();
+    if (SourceType == TargetType)
+    {
+        return Value;
+    }
     
     switch (TargetType)
     {
         case EGWTVariableType::Float:
-            switch (Value.Type)
+            switch (SourceType)
             {
                 case EGWTVariableType::Int:
-                    Result.FloatValue = static_cast<float>(Value.IntValue);
-                    break;
+                    return FSpellValue::FromFloat(static_cast<float>(Value.GetInt()));
                 case EGWTVariableType::Bool:
-                    Result.FloatValue = Value.BoolValue ? 1.0f : 0.0f;
-                    break;
+                    return FSpellValue::FromFloat(Value.GetBool() ? 1.0f : 0.0f);
                 case EGWTVariableType::String:
-                    Result.FloatValue = FCString::Atof(*Value.StringValue);
-                    break;
+                    return FSpellValue::FromFloat(FCString::Atof(*Value.GetString()));
                 default:
-                    Result.FloatValue = Value.FloatValue;
-                    break;
+                    return FSpellValue::FromFloat(0.0f);
             }
-            break;
             
         case EGWTVariableType::Int:
-            switch (Value.Type)
+            switch (SourceType)
             {
                 case EGWTVariableType::Float:
-                    Result.IntValue = static_cast<int32>(Value.FloatValue);
-                    break;
+                    return FSpellValue::FromInt(static_cast<int32>(Value.GetFloat()));
                 case EGWTVariableType::Bool:
-                    Result.IntValue = Value.BoolValue ? 1 : 0;
-                    break;
+                    return FSpellValue::FromInt(Value.GetBool() ? 1 : 0);
                 case EGWTVariableType::String:
-                    Result.IntValue = FCString::Atoi(*Value.StringValue);
-                    break;
+                    return FSpellValue::FromInt(FCString::Atoi(*Value.GetString()));
                 default:
-                    Result.IntValue = Value.IntValue;
-                    break;
+                    return FSpellValue::FromInt(0);
             }
-            break;
             
         case EGWTVariableType::Bool:
-            switch (Value.Type)
+            switch (SourceType)
             {
                 case EGWTVariableType::Float:
-                    Result.BoolValue = Value.FloatValue != 0.0f;
-                    break;
+                    return FSpellValue::FromBool(Value.GetFloat() != 0.0f);
                 case EGWTVariableType::Int:
-                    Result.BoolValue = Value.IntValue != 0;
-                    break;
+                    return FSpellValue::FromBool(Value.GetInt() != 0);
                 case EGWTVariableType::String:
-                    Result.BoolValue = Value.StringValue.Len() > 0;
-                    break;
+                    return FSpellValue::FromBool(Value.GetString().Len() > 0);
                 default:
-                    Result.BoolValue = Value.BoolValue;
-                    break;
+                    return FSpellValue::FromBool(false);
             }
-            break;
             
         case EGWTVariableType::String:
-            switch (Value.Type)
+            switch (SourceType)
             {
                 case EGWTVariableType::Float:
-                    Result.StringValue = FString::Printf(TEXT("%.2f"), Value.FloatValue);
-                    break;
                 case EGWTVariableType::Int:
-                    Result.StringValue = FString::Printf(TEXT("%d"), Value.IntValue);
-                    break;
                 case EGWTVariableType::Bool:
-                    Result.StringValue = Value.BoolValue ? TEXT("true") : TEXT("false");
-                    break;
                 case EGWTVariableType::Vector:
-                    Result.StringValue = Value.VectorValue.ToString();
-                    break;
+                    return FSpellValue::FromString(Value.ToString());
                 default:
-                    Result.StringValue = Value.StringValue;
-                    break;
+                    return FSpellValue::FromString(FString());
             }
-            break;
             
         default:
-            Result = Value;
-            break;
+            return Value;
     }
-    
-    return Result;
 }
 
-void UVariableNode::UpdateVariableHistory(USpellExecutionContext* Context, const FGWTVariableValue& OldValue, const FGWTVariableValue& NewValue)
+void UVariableNode::UpdateVariableHistory(USpellExecutionContext* Context, const FSpellValue& OldValue, const FSpellValue& NewValue)
 {
-    if (!VariableHistories.Contains(VariableName))
-    {
-        VariableHistories.Add(VariableName, FVariableHistory());
-    }
-    
-    FVariableHistory& History = VariableHistories[VariableName];
+    FVariableHistory& History = VariableHistories.FindOrAdd(VariableName);
     
     UWorld* World = GetWorld();
     float CurrentTime = World ? World->GetTimeSeconds() : 0.0f;
@@ -470,18 +506,17 @@ void UVariableNode::UpdateVariableHistory(USpellExecutionContext* Context, const
 
 void UVariableNode::LoadPersistentValue(USpellExecutionContext* Context)
 {
-    if (PersistentValues.Contains(VariableName))
+    if (const FGWTVariableValue* PersistentValue = PersistentValues.Find(VariableName))
     {
-        FGWTVariableValue PersistentValue = PersistentValues[VariableName];
-        Context->SetVariable(VariableName, PersistentValue, bIsGlobal);
+        WriteVariable(Context, FSpellValue(*PersistentValue));
         
         UE_LOG(LogTemp, Log, TEXT("Loaded persistent value for variable %s"), *VariableName.ToString());
     }
 }
 
-void UVariableNode::SavePersistentValue(const FGWTVariableValue& Value)
+void UVariableNode::SavePersistentValue(const FSpellValue& Value)
 {
-    PersistentValues.Add(VariableName, Value);
+    PersistentValues.Add(VariableName, Value.ToVariableValue());
     
     UE_LOG(LogTemp, Log, TEXT("Saved persistent value for variable %s"), *VariableName.ToString());
 }
@@ -515,11 +550,11 @@ void UVariableNode::ApplyRarityEffects(USpellExecutionContext* Context)
                     float Sum = 0.0f;
                     int32 Count = 0;
                     
-                    for (const FGWTVariableValue& Val : History.PreviousValues)
+                    for (const FSpellValue& Val : History.PreviousValues)
                     {
-                        if (Val.Type == EGWTVariableType::Float)
+                        if (Val.GetType() == EGWTVariableType::Float)
                         {
-                            Sum += Val.FloatValue;
+                            Sum += Val.GetFloat();
                             Count++;
                         }
                     }
@@ -0,0 +1,92 @@
+#include "Subsystems/GrimoireContextSubsystem.h"
+#include "Spells/SpellExecutionContext.h"
+
+void UGrimoireContextSubsystem::Deinitialize()
+{
+    // Detach contexts that are still referenced elsewhere from the arenas being destroyed
+    for (USpellExecutionContext* Context : Contexts)
+    {
+        if (Context)
+        {
+            Context->ResetForCast(nullptr);
+        }
+    }
+
+    Contexts.Empty();
+    Casts.Empty();
+    FreeContexts = nullptr;
+    FreeCasts = nullptr;
+    NumActiveCasts = 0;
+
+    Super::Deinitialize();
+}
+
+USpellExecutionContext* UGrimoireContextSubsystem::BeginCast()
+{
+    FSpellCast* Cast = FreeCasts;
+    if (Cast)
+    {
+        FreeCasts = Cast->NextFree;
+        Cast->NextFree = nullptr;
+    }
+    else
+    {
+        Cast = Casts.Add_GetRef(MakeUnique<FSpellCast>()).Get();
+        Cast->Pool = this;
+    }
+
+    Cast->RefCount = 1;
+    ++NumActiveCasts;
+
+    return AcquireContext(*Cast);
+}
+
+USpellExecutionContext* UGrimoireContextSubsystem::AcquireContext(FSpellCast& Cast)
+{
+    USpellExecutionContext* Context = FreeContexts;
+    if (Context)
+    {
+        FreeContexts = Context->NextPooled;
+    }
+    else
+    {
+        Context = NewObject<USpellExecutionContext>(this);
+        Contexts.Add(Context);
+    }
+
+    Context->ResetForCast(&Cast);
+
+    if (Cast.LastContext)
+    {
+        Cast.LastContext->NextPooled = Context;
+    }
+    else
+    {
+        Cast.FirstContext = Context;
+    }
+    Cast.LastContext = Context;
+
+    return Context;
+}
+
+void UGrimoireContextSubsystem::RecycleCast(FSpellCast& Cast)
+{
+    // Splice the cast's whole context chain onto the free list. Contexts are reset when handed out again.
+    if (Cast.FirstContext)
+    {
+        Cast.LastContext->NextPooled = FreeContexts;
+        FreeContexts = Cast.FirstContext;
+    }
+
+    Cast.FirstContext = nullptr;
+    Cast.LastContext = nullptr;
+    Cast.Arena.Reset();
+    Cast.FuelBudget = 0;
+    Cast.FuelUsed = 0;
+    Cast.Commands.Reset();
+    Cast.OnFinished = nullptr;
+
+    Cast.NextFree = FreeCasts;
+    FreeCasts = &Cast;
+    --NumActiveCasts;
+}
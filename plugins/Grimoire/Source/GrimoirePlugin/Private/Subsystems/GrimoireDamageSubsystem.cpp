@@ -0,0 +1,90 @@
+#include "Subsystems/GrimoireDamageSubsystem.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spell Damage Hits"), STAT_GrimoireDamageHits, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spell Damage Events"), STAT_GrimoireDamageEvents, STATGROUP_Grimoire);
+
+void UGrimoireDamageSubsystem::Deinitialize()
+{
+    // The world is going away, so there is nobody left to damage
+    Pending.Empty();
+    PendingIndex.Empty();
+    NumPendingHits = 0;
+
+    Super::Deinitialize();
+}
+
+TStatId UGrimoireDamageSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrimoireDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UGrimoireDamageSubsystem::Tick(float DeltaTime)
+{
+    Flush();
+}
+
+void UGrimoireDamageSubsystem::AddHit(AActor* Target, float Amount, AActor* Instigator, ESpellElement Element)
+{
+    if (!Target || Amount == 0.0f)
+    {
+        return;
+    }
+
+    const UWorld* World = GetWorld();
+    FSpellDamageHit Hit;
+    Hit.Amount = Amount;
+    Hit.Time = World ? World->GetTimeSeconds() : 0.0f;
+
+    const TTuple<FObjectKey, FObjectKey, ESpellElement> Key(FObjectKey(Instigator), FObjectKey(Target), Element);
+    int32& Index = PendingIndex.FindOrAdd(Key, INDEX_NONE);
+    if (Index == INDEX_NONE)
+    {
+        Index = Pending.AddDefaulted();
+        FSpellDamageSummary& Summary = Pending[Index];
+        Summary.Instigator = Instigator;
+        Summary.Target = Target;
+        Summary.bHasElement = Element != ESpellElement::MAX;
+        Summary.Element = Summary.bHasElement ? Element : ESpellElement::Fire;
+    }
+
+    FSpellDamageSummary& Summary = Pending[Index];
+    Summary.TotalDamage += Amount;
+    Summary.Hits.Add(Hit);
+    ++NumPendingHits;
+    INC_DWORD_STAT(STAT_GrimoireDamageHits);
+}
+
+void UGrimoireDamageSubsystem::Flush()
+{
+    // A damage handler flushing again gets nothing new; its hits wait for the next batch
+    if (Pending.Num() == 0 || Applying.Num() > 0)
+    {
+        return;
+    }
+
+    Swap(Pending, Applying);
+    PendingIndex.Reset();
+    NumPendingHits = 0;
+
+    // Same checks as UGameplayStatics::ApplyDamage, once per aggregated event
+    for (const FSpellDamageSummary& Summary : Applying)
+    {
+        AActor* Target = Summary.Target.Get();
+        if (!Target || !Target->CanBeDamaged() || Summary.TotalDamage == 0.0f)
+        {
+            continue;
+        }
+
+        const FSpellDamageEvent DamageEvent(Summary);
+        Target->TakeDamage(Summary.TotalDamage, DamageEvent, nullptr, nullptr);
+        INC_DWORD_STAT(STAT_GrimoireDamageEvents);
+
+        UE_LOG(LogTemp, Log, TEXT("Effect: Applied %.2f Damage in %d hits"), Summary.TotalDamage, Summary.Hits.Num());
+        OnDamageApplied.Broadcast(Summary);
+    }
+
+    Applying.Reset();
+}
@@ -0,0 +1,84 @@
+#include "Subsystems/GrimoireElementSubsystem.h"
+#include "Spells/ElementInteractionMatrix.h"
+#include "GrimoireSettings.h"
+#include "Engine/DataTable.h"
+
+void UGrimoireElementSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+#if WITH_EDITOR
+    GetMutableDefault<UGrimoireSettings>()->OnSettingChanged().AddUObject(this, &UGrimoireElementSubsystem::HandleSettingsChanged);
+#endif
+
+    Rebuild();
+}
+
+void UGrimoireElementSubsystem::Deinitialize()
+{
+#if WITH_EDITOR
+    GetMutableDefault<UGrimoireSettings>()->OnSettingChanged().RemoveAll(this);
+    if (InteractionTable)
+    {
+        InteractionTable->OnDataTableChanged().RemoveAll(this);
+    }
+#endif
+    InteractionTable = nullptr;
+
+    Super::Deinitialize();
+}
+
+void UGrimoireElementSubsystem::Rebuild()
+{
+    const TSoftObjectPtr<UDataTable>& TablePath = GetDefault<UGrimoireSettings>()->ElementInteractionTable;
+    UDataTable* Table = TablePath.LoadSynchronous();
+    if (Table != InteractionTable)
+    {
+#if WITH_EDITOR
+        // Reimporting a table broadcasts its change delegate once the new rows are in
+        if (InteractionTable)
+        {
+            InteractionTable->OnDataTableChanged().RemoveAll(this);
+        }
+        if (Table)
+        {
+            Table->OnDataTableChanged().AddUObject(this, &UGrimoireElementSubsystem::Rebuild);
+        }
+#endif
+        InteractionTable = Table;
+    }
+
+    // No table configured is a valid setup in which no elements interact
+    if (TablePath.IsNull())
+    {
+        FElementInteractionMatrix::Publish(MakeShared<const FElementInteractionMatrix>());
+        return;
+    }
+
+    TArray<FString> Errors;
+    const TSharedPtr<const FElementInteractionMatrix> Matrix = FElementInteractionMatrix::Compile(Table, Errors);
+    for (const FString& Error : Errors)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Element interactions: %s"), *Error);
+    }
+
+    // A broken edit keeps the last good matrix instead of silently dropping interactions
+    if (!Matrix)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Element interaction table has %d problems, keeping the previous interactions"), Errors.Num());
+        return;
+    }
+
+    // Built off to the side, so lookups never see a half-compiled table
+    FElementInteractionMatrix::Publish(Matrix.ToSharedRef());
+}
+
+#if WITH_EDITOR
+void UGrimoireElementSubsystem::HandleSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent)
+{
+    if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UGrimoireSettings, ElementInteractionTable))
+    {
+        Rebuild();
+    }
+}
+#endif
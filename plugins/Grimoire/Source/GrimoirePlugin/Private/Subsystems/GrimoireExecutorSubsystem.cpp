@@ -0,0 +1,122 @@
+#include "Subsystems/GrimoireExecutorSubsystem.h"
+#include "Spells/SpellInterpreter.h"
+#include "GrimoireSettings.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Spells"), STAT_GrimoireQueuedSpells, STATGROUP_Grimoire);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Spell Time (ms)"), STAT_GrimoireSpellTimeMs, STATGROUP_Grimoire);
+
+void UGrimoireExecutorSubsystem::Deinitialize()
+{
+    // Queued interpreters hold their casts; the pool goes away with the world
+    for (FSpellQueue& Queue : Queues)
+    {
+        Queue.Items.Empty();
+        Queue.Head = 0;
+    }
+
+    Super::Deinitialize();
+}
+
+TStatId UGrimoireExecutorSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrimoireExecutorSubsystem, STATGROUP_Tickables);
+}
+
+void UGrimoireExecutorSubsystem::Tick(float DeltaTime)
+{
+    // Close the last window and open a new one, which work carried over from it gets first
+    LastFrameSeconds = UsedSeconds;
+    UsedSeconds = 0.0;
+    SET_FLOAT_STAT(STAT_GrimoireSpellTimeMs, GetLastFrameTimeMs());
+
+    const double BudgetSeconds = GetBudgetSeconds();
+    for (FSpellQueue& Queue : Queues)
+    {
+        while (Queue.Num() > 0 && UsedSeconds < BudgetSeconds)
+        {
+            // An interpreter that runs out of budget again goes to the back of its queue
+            const TSharedPtr<FSpellInterpreter> Interpreter = MoveTemp(Queue.Items[Queue.Head++]);
+            Interpreter->Resume();
+        }
+
+        Queue.Items.RemoveAt(0, Queue.Head, EAllowShrinking::No);
+        Queue.Head = 0;
+    }
+
+    SET_DWORD_STAT(STAT_GrimoireQueuedSpells, GetQueueDepth());
+}
+
+double UGrimoireExecutorSubsystem::BeginSlice(double StartTime)
+{
+    ++SliceDepth;
+    return StartTime + FMath::Max(GetBudgetSeconds() - UsedSeconds, 0.0);
+}
+
+void UGrimoireExecutorSubsystem::EndSlice(double StartTime)
+{
+    check(SliceDepth > 0);
+    if (--SliceDepth == 0)
+    {
+        UsedSeconds += FPlatformTime::Seconds() - StartTime;
+    }
+}
+
+void UGrimoireExecutorSubsystem::Enqueue(const TSharedRef<FSpellInterpreter>& Interpreter, const AActor* Caster)
+{
+    Queues[static_cast<int32>(GetPriority(Caster))].Items.Add(Interpreter);
+}
+
+EGrimoireSpellPriority UGrimoireExecutorSubsystem::GetPriority(const AActor* Caster) const
+{
+    const APawn* Pawn = Cast<APawn>(Caster);
+    if (Pawn && Pawn->IsPlayerControlled())
+    {
+        return EGrimoireSpellPriority::Player;
+    }
+
+    const UWorld* World = GetWorld();
+    if (Caster && World)
+    {
+        // Servers have no camera of their own, so use every player's view point
+        const double NearDistanceSquared = FMath::Square(GetDefault<UGrimoireSettings>()->NearCameraDistance);
+        for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+        {
+            const APlayerController* PlayerController = It->Get();
+            if (!PlayerController)
+            {
+                continue;
+            }
+
+            FVector ViewLocation;
+            FRotator ViewRotation;
+            PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+            if (FVector::DistSquared(ViewLocation, Caster->GetActorLocation()) <= NearDistanceSquared)
+            {
+                return EGrimoireSpellPriority::NearCamera;
+            }
+        }
+    }
+
+    return EGrimoireSpellPriority::Background;
+}
+
+int32 UGrimoireExecutorSubsystem::GetQueueDepth() const
+{
+    int32 Depth = 0;
+    for (const FSpellQueue& Queue : Queues)
+    {
+        Depth += Queue.Num();
+    }
+    return Depth;
+}
+
+double UGrimoireExecutorSubsystem::GetBudgetSeconds() const
+{
+    // A budget of 0 leaves spells unsliced
+    const float BudgetMs = GetDefault<UGrimoireSettings>()->SpellFrameBudgetMs;
+    return BudgetMs > 0.0f ? BudgetMs / 1000.0 : TNumericLimits<double>::Max();
+}
@@ -0,0 +1,213 @@
+#include "Subsystems/GrimoireProjectilePoolSubsystem.h"
+#include "GrimoireSettings.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "Components/ActorComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles Reused"), STAT_GrimoireProjectilesReused, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Pool Misses"), STAT_GrimoireProjectilePoolMisses, STATGROUP_Grimoire);
+
+void UGrimoireProjectilePoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Map load is already a hitch, so pay for the first wave of projectiles here
+    for (const TPair<TSoftClassPtr<AActor>, int32>& Entry : GetDefault<UGrimoireSettings>()->ProjectilePoolPrewarm)
+    {
+        if (UClass* ActorClass = Entry.Key.LoadSynchronous())
+        {
+            Prewarm(ActorClass, Entry.Value);
+        }
+    }
+}
+
+void UGrimoireProjectilePoolSubsystem::Deinitialize()
+{
+    // The actors belong to the level and go with it; pending expiries die with the scheduler
+    Pools.Empty();
+    ActiveProjectiles.Empty();
+
+    Super::Deinitialize();
+}
+
+AActor* UGrimoireProjectilePoolSubsystem::Acquire(TSubclassOf<AActor> ActorClass, const FVector& Location, const FRotator& Rotation, float LifeSpan)
+{
+    if (!ActorClass)
+    {
+        return nullptr;
+    }
+
+    FGrimoireProjectilePool& Pool = Pools.FindOrAdd(ActorClass.Get());
+
+    // Idle projectiles can still be destroyed by level code
+    AActor* Projectile = nullptr;
+    FGrimoirePooledProjectileState State;
+    while (!Projectile && Pool.Idle.Num() > 0)
+    {
+        AActor* Candidate = Pool.Idle.Pop(EAllowShrinking::No);
+        State = Pool.IdleStates.Pop(EAllowShrinking::No);
+        Projectile = IsValid(Candidate) ? Candidate : nullptr;
+    }
+
+    if (Projectile)
+    {
+        Projectile->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+        Activate(Projectile, State);
+        ++Pool.Stats.Reused;
+        INC_DWORD_STAT(STAT_GrimoireProjectilesReused);
+    }
+    else
+    {
+        Projectile = SpawnProjectile(ActorClass.Get(), Location, Rotation);
+        if (!Projectile)
+        {
+            return nullptr;
+        }
+        ++Pool.Stats.Misses;
+        INC_DWORD_STAT(STAT_GrimoireProjectilePoolMisses);
+    }
+
+    FGrimoireScheduleHandle Expiry;
+    if (LifeSpan > 0.0f)
+    {
+        UGrimoireSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UGrimoireSchedulerSubsystem>();
+        if (!Scheduler)
+        {
+            // Nothing would release it, so the engine destroys it and the pool stops tracking it
+            Projectile->SetLifeSpan(LifeSpan);
+            return Projectile;
+        }
+        Expiry = Scheduler->Schedule(LifeSpan, FSimpleDelegate::CreateUObject(this, &UGrimoireProjectilePoolSubsystem::HandleExpired, TObjectKey<AActor>(Projectile), ActorClass.Get()));
+    }
+
+    ++Pool.Stats.Active;
+    ActiveProjectiles.Add(Projectile, Expiry);
+
+    return Projectile;
+}
+
+bool UGrimoireProjectilePoolSubsystem::Release(AActor* Projectile)
+{
+    FGrimoireScheduleHandle Expiry;
+    if (!Projectile || !ActiveProjectiles.RemoveAndCopyValue(Projectile, Expiry))
+    {
+        return false;
+    }
+
+    if (UGrimoireSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UGrimoireSchedulerSubsystem>())
+    {
+        Scheduler->Cancel(Expiry);
+    }
+
+    FGrimoireProjectilePool& Pool = Pools.FindOrAdd(Projectile->GetClass());
+    --Pool.Stats.Active;
+
+    if (!IsValid(Projectile))
+    {
+        return true;
+    }
+
+    if (Pool.Idle.Num() >= GetDefault<UGrimoireSettings>()->MaxIdleProjectilesPerClass)
+    {
+        Projectile->Destroy();
+        return true;
+    }
+
+    AddIdle(Pool, Projectile);
+    return true;
+}
+
+void UGrimoireProjectilePoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+    if (!ActorClass)
+    {
+        return;
+    }
+
+    FGrimoireProjectilePool& Pool = Pools.FindOrAdd(ActorClass.Get());
+    while (Pool.Idle.Num() < Count)
+    {
+        AActor* Projectile = SpawnProjectile(ActorClass.Get(), FVector::ZeroVector, FRotator::ZeroRotator);
+        if (!Projectile)
+        {
+            return;
+        }
+        AddIdle(Pool, Projectile);
+    }
+}
+
+FGrimoireProjectilePoolStats UGrimoireProjectilePoolSubsystem::GetPoolStats(TSubclassOf<AActor> ActorClass) const
+{
+    const FGrimoireProjectilePool* Pool = Pools.Find(ActorClass.Get());
+    if (!Pool)
+    {
+        return FGrimoireProjectilePoolStats();
+    }
+
+    FGrimoireProjectilePoolStats Stats = Pool->Stats;
+    Stats.Idle = Pool->Idle.Num();
+    return Stats;
+}
+
+AActor* UGrimoireProjectilePoolSubsystem::SpawnProjectile(UClass* ActorClass, const FVector& Location, const FRotator& Rotation) const
+{
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    return GetWorld()->SpawnActor<AActor>(ActorClass, Location, Rotation, SpawnParams);
+}
+
+void UGrimoireProjectilePoolSubsystem::AddIdle(FGrimoireProjectilePool& Pool, AActor* Projectile)
+{
+    Pool.IdleStates.Add(Deactivate(Projectile));
+    Pool.Idle.Add(Projectile);
+}
+
+void UGrimoireProjectilePoolSubsystem::Activate(AActor* Projectile, const FGrimoirePooledProjectileState& State)
+{
+    Projectile->SetActorHiddenInGame(State.bHidden);
+    Projectile->SetActorEnableCollision(State.bCollisionEnabled);
+    Projectile->SetActorTickEnabled(State.bTickEnabled);
+
+    // Resetting activation puts movement and effect components back to their initial state.
+    // Components that were off when pooled stay off.
+    for (const FGrimoirePooledProjectileState::FComponentState& ComponentState : State.Components)
+    {
+        UActorComponent* Component = ComponentState.Component.Get();
+        if (Component && ComponentState.bActive)
+        {
+            Component->Activate(true);
+            Component->SetComponentTickEnabled(ComponentState.bTickEnabled);
+        }
+    }
+}
+
+FGrimoirePooledProjectileState UGrimoireProjectilePoolSubsystem::Deactivate(AActor* Projectile)
+{
+    FGrimoirePooledProjectileState State;
+    State.bHidden = Projectile->IsHidden();
+    State.bCollisionEnabled = Projectile->GetActorEnableCollision();
+    State.bTickEnabled = Projectile->IsActorTickEnabled();
+
+    Projectile->ForEachComponent(false, [&State](UActorComponent* Component)
+    {
+        State.Components.Add({ Component, Component->IsActive(), Component->IsComponentTickEnabled() });
+        Component->Deactivate();
+    });
+
+    Projectile->SetActorHiddenInGame(true);
+    Projectile->SetActorEnableCollision(false);
+    Projectile->SetActorTickEnabled(false);
+    return State;
+}
+
+void UGrimoireProjectilePoolSubsystem::HandleExpired(TObjectKey<AActor> ProjectileKey, UClass* ActorClass)
+{
+    if (AActor* Projectile = ProjectileKey.ResolveObjectPtr())
+    {
+        Release(Projectile);
+    }
+    else if (ActiveProjectiles.Remove(ProjectileKey) > 0)
+    {
+        --Pools.FindOrAdd(ActorClass).Stats.Active;
+    }
+}
@@ -0,0 +1,278 @@
+#include "Subsystems/GrimoireProjectileSubsystem.h"
+#include "Components/GrimoireComponent.h"
+#include "Spells/ElementInteractionMatrix.h"
+#include "Subsystems/GrimoireVFXSubsystem.h"
+#include "GrimoireSettings.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Simulation"), STAT_GrimoireProjectileTick, STATGROUP_Grimoire);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Projectiles"), STAT_GrimoireSimulatedProjectiles, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Hits"), STAT_GrimoireProjectileHits, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Broadphase Pairs"), STAT_GrimoireBroadphasePairs, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Elemental Collisions"), STAT_GrimoireElementalCollisions, STATGROUP_Grimoire);
+
+void UGrimoireProjectileSubsystem::Deinitialize()
+{
+    DEC_DWORD_STAT_BY(STAT_GrimoireSimulatedProjectiles, Elements.Num());
+
+    PositionX.Empty();
+    PositionY.Empty();
+    PositionZ.Empty();
+    VelocityX.Empty();
+    VelocityY.Empty();
+    VelocityZ.Empty();
+    Speeds.Empty();
+    RangeRemaining.Empty();
+    Elements.Empty();
+    Owners.Empty();
+    Grimoires.Empty();
+    SpellNames.Empty();
+    PendingSweeps.Empty();
+    CandidatePairs.Empty();
+
+    Super::Deinitialize();
+}
+
+TStatId UGrimoireProjectileSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrimoireProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UGrimoireProjectileSubsystem::Launch(const FVector& Location, const FVector& Velocity, ESpellElement Element, float Range, AActor* Owner, UGrimoireComponent* Grimoire, FName SpellName)
+{
+    const float Speed = Velocity.Size();
+    if (Range <= 0.0f || Speed <= 0.0f)
+    {
+        return;
+    }
+
+    PositionX.Add(Location.X);
+    PositionY.Add(Location.Y);
+    PositionZ.Add(Location.Z);
+    VelocityX.Add(Velocity.X);
+    VelocityY.Add(Velocity.Y);
+    VelocityZ.Add(Velocity.Z);
+    Speeds.Add(Speed);
+    RangeRemaining.Add(Range);
+    Elements.Add(Element);
+    Owners.Add(Owner);
+    Grimoires.Add(Grimoire);
+    SpellNames.Add(SpellName);
+
+    INC_DWORD_STAT(STAT_GrimoireSimulatedProjectiles);
+}
+
+void UGrimoireProjectileSubsystem::GetLocations(TArray<FVector>& OutLocations) const
+{
+    OutLocations.SetNumUninitialized(Elements.Num());
+    for (int32 Index = 0; Index < Elements.Num(); ++Index)
+    {
+        OutLocations[Index] = GetLocation(Index);
+    }
+}
+
+void UGrimoireProjectileSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_GrimoireProjectileTick);
+
+    TArray<FProjectileHit> Hits;
+    ResolveHits(Hits);
+
+    TArray<FGrimoireElementalCollision> Collisions;
+    if (Elements.Num() > 0)
+    {
+        Integrate(DeltaTime);
+        ResolveElementalCollisions(Collisions);
+        SweepMoved(DeltaTime);
+    }
+
+    UWorld* World = GetWorld();
+    UGrimoireVFXSubsystem* Effects = Collisions.Num() > 0 && World ? World->GetSubsystem<UGrimoireVFXSubsystem>() : nullptr;
+    for (const FGrimoireElementalCollision& Collision : Collisions)
+    {
+        if (Effects && Collision.Interaction.bCreatesSustainedEffect)
+        {
+            Effects->RequestEffect(Effects->GetElementalCollisionEffect(), Collision.Location);
+        }
+        OnElementalCollision.Broadcast(Collision);
+    }
+
+    // Last, since OnHit triggers can launch more projectiles
+    for (const FProjectileHit& Hit : Hits)
+    {
+        if (UGrimoireComponent* Grimoire = Hit.Grimoire.Get())
+        {
+            Grimoire->TriggerSpellEvent(Hit.SpellName, ETriggerEventType::OnHit, Hit.HitActor.Get());
+        }
+    }
+}
+
+void UGrimoireProjectileSubsystem::ResolveHits(TArray<FProjectileHit>& OutHits)
+{
+    UWorld* World = GetWorld();
+    const int32 NumProjectiles = Elements.Num();
+
+    // First blocking hit per projectile, by its index when the sweep was issued
+    TArray<TWeakObjectPtr<AActor>> HitActors;
+    TBitArray<> bHit(false, NumProjectiles);
+    if (PendingSweeps.Num() > 0)
+    {
+        HitActors.SetNum(NumProjectiles);
+    }
+
+    for (const FTraceHandle& Handle : PendingSweeps)
+    {
+        FTraceDatum Datum;
+        if (!World || !World->QueryTraceData(Handle, Datum))
+        {
+            continue;
+        }
+
+        const int32 Index = static_cast<int32>(Datum.UserData);
+        if (Index < NumProjectiles && Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit)
+        {
+            bHit[Index] = true;
+            HitActors[Index] = Datum.OutHits[0].GetActor();
+        }
+    }
+    PendingSweeps.Reset();
+
+    // Backwards, so each swap moves in a projectile that has already been checked
+    for (int32 Index = NumProjectiles - 1; Index >= 0; --Index)
+    {
+        if (bHit[Index])
+        {
+            FProjectileHit& Hit = OutHits.AddDefaulted_GetRef();
+            Hit.Grimoire = Grimoires[Index];
+            Hit.SpellName = SpellNames[Index];
+            Hit.HitActor = HitActors[Index];
+            RemoveAtSwap(Index);
+        }
+        else if (RangeRemaining[Index] <= 0.0f)
+        {
+            RemoveAtSwap(Index);
+        }
+    }
+
+    INC_DWORD_STAT_BY(STAT_GrimoireProjectileHits, OutHits.Num());
+}
+
+void UGrimoireProjectileSubsystem::Integrate(float DeltaTime)
+{
+    const int32 NumProjectiles = Elements.Num();
+    const VectorRegister4Float DeltaTimes = VectorSetFloat1(DeltaTime);
+
+    int32 Index = 0;
+    for (; Index + 4 <= NumProjectiles; Index += 4)
+    {
+        VectorStore(VectorMultiplyAdd(VectorLoad(&VelocityX[Index]), DeltaTimes, VectorLoad(&PositionX[Index])), &PositionX[Index]);
+        VectorStore(VectorMultiplyAdd(VectorLoad(&VelocityY[Index]), DeltaTimes, VectorLoad(&PositionY[Index])), &PositionY[Index]);
+        VectorStore(VectorMultiplyAdd(VectorLoad(&VelocityZ[Index]), DeltaTimes, VectorLoad(&PositionZ[Index])), &PositionZ[Index]);
+        VectorStore(VectorNegateMultiplyAdd(VectorLoad(&Speeds[Index]), DeltaTimes, VectorLoad(&RangeRemaining[Index])), &RangeRemaining[Index]);
+    }
+
+    for (; Index < NumProjectiles; ++Index)
+    {
+        PositionX[Index] += VelocityX[Index] * DeltaTime;
+        PositionY[Index] += VelocityY[Index] * DeltaTime;
+        PositionZ[Index] += VelocityZ[Index] * DeltaTime;
+        RangeRemaining[Index] -= Speeds[Index] * DeltaTime;
+    }
+}
+
+void UGrimoireProjectileSubsystem::ResolveElementalCollisions(TArray<FGrimoireElementalCollision>& OutCollisions)
+{
+    const int32 NumProjectiles = Elements.Num();
+    if (NumProjectiles < 2)
+    {
+        return;
+    }
+
+    Broadphase.Build(PositionX, PositionY, PositionZ, 2.0f * GetDefault<UGrimoireSettings>()->ProjectileRadius);
+    CandidatePairs.Reset();
+    Broadphase.FindPairs(CandidatePairs);
+    INC_DWORD_STAT_BY(STAT_GrimoireBroadphasePairs, CandidatePairs.Num());
+
+    // A projectile cancels at most once per tick, with the first cancelling partner found. Other pairs pass through each other.
+    const FElementInteractionMatrix& Interactions = FElementInteractionMatrix::Get();
+    TBitArray<> bConsumed(false, NumProjectiles);
+    for (const TPair<int32, int32>& Pair : CandidatePairs)
+    {
+        const int32 A = Pair.Key;
+        const int32 B = Pair.Value;
+        if (bConsumed[A] || bConsumed[B] || Elements[A] == Elements[B])
+        {
+            continue;
+        }
+
+        if (!Interactions.Find(Elements[A], Elements[B]).bCancelsProjectiles)
+        {
+            continue;
+        }
+
+        bConsumed[A] = true;
+        bConsumed[B] = true;
+
+        FGrimoireElementalCollision& Collision = OutCollisions.AddDefaulted_GetRef();
+        Collision.Location = (GetLocation(A) + GetLocation(B)) * 0.5f;
+        Collision.Interaction = Interactions.GetInteraction(Elements[A], Elements[B]);
+    }
+
+    if (OutCollisions.Num() == 0)
+    {
+        return;
+    }
+
+    for (int32 Index = NumProjectiles - 1; Index >= 0; --Index)
+    {
+        if (bConsumed[Index])
+        {
+            RemoveAtSwap(Index);
+        }
+    }
+
+    INC_DWORD_STAT_BY(STAT_GrimoireElementalCollisions, OutCollisions.Num());
+}
+
+void UGrimoireProjectileSubsystem::SweepMoved(float DeltaTime)
+{
+    UWorld* World = GetWorld();
+    if (!World)
+    {
+        return;
+    }
+
+    const UGrimoireSettings* Settings = GetDefault<UGrimoireSettings>();
+    const FCollisionShape Shape = FCollisionShape::MakeSphere(Settings->ProjectileRadius);
+
+    PendingSweeps.Reserve(Elements.Num());
+    for (int32 Index = 0; Index < Elements.Num(); ++Index)
+    {
+        const FVector End = GetLocation(Index);
+        const FVector Start = End - GetVelocity(Index) * DeltaTime;
+
+        FCollisionQueryParams Params(SCENE_QUERY_STAT(GrimoireProjectile), false, Owners[Index].Get());
+        PendingSweeps.Add(World->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, FQuat::Identity, Settings->ProjectileCollisionChannel,
+            Shape, Params, FCollisionResponseParams::DefaultResponseParam, nullptr, static_cast<uint32>(Index)));
+    }
+}
+
+void UGrimoireProjectileSubsystem::RemoveAtSwap(int32 Index)
+{
+    PositionX.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    PositionY.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    PositionZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    VelocityX.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    VelocityY.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    VelocityZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Speeds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    RangeRemaining.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Elements.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Owners.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Grimoires.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    SpellNames.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    DEC_DWORD_STAT(STAT_GrimoireSimulatedProjectiles);
+}
@@ -0,0 +1,213 @@
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
+#include "Engine/World.h"
+
+void UGrimoireSchedulerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    for (int32& Head : SlotHeads)
+    {
+        Head = INDEX_NONE;
+    }
+    CurrentTick = GetCurrentWorldTick();
+}
+
+void UGrimoireSchedulerSubsystem::Deinitialize()
+{
+    // Dropping the delegates releases whatever the continuations captured
+    Entries.Empty();
+    DueBatch.Empty();
+    FirstFree = INDEX_NONE;
+    NumPending = 0;
+
+    Super::Deinitialize();
+}
+
+TStatId UGrimoireSchedulerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrimoireSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+uint64 UGrimoireSchedulerSubsystem::GetCurrentWorldTick() const
+{
+    const UWorld* World = GetWorld();
+    return World ? static_cast<uint64>(World->GetTimeSeconds() / TickSeconds) : 0;
+}
+
+FGrimoireScheduleHandle UGrimoireSchedulerSubsystem::Schedule(float Delay, FSimpleDelegate&& Continuation)
+{
+    const uint64 NowTick = GetCurrentWorldTick();
+    if (NumPending == 0)
+    {
+        // Nothing is waiting, so there is nothing to cascade on the way to now
+        CurrentTick = FMath::Max(CurrentTick, NowTick);
+    }
+
+    int32 EntryIndex = FirstFree;
+    if (EntryIndex != INDEX_NONE)
+    {
+        FirstFree = Entries[EntryIndex].Next;
+    }
+    else
+    {
+        EntryIndex = Entries.AddDefaulted();
+    }
+
+    FEntry& Entry = Entries[EntryIndex];
+    Entry.Continuation = MoveTemp(Continuation);
+
+    // Never due before the next tick, so a continuation cannot run inside the call that scheduled it
+    const uint64 DelayTicks = static_cast<uint64>(FMath::CeilToDouble(FMath::Max(Delay, 0.0f) / TickSeconds));
+    const uint64 MaxDelta = (uint64(1) << (SlotBits * NumLevels)) - 1;
+    Entry.DueTick = FMath::Clamp(NowTick + DelayTicks, CurrentTick + 1, CurrentTick + MaxDelta);
+
+    Link(EntryIndex);
+    ++NumPending;
+
+    FGrimoireScheduleHandle Handle;
+    Handle.Index = EntryIndex;
+    Handle.Serial = Entry.Serial;
+    return Handle;
+}
+
+bool UGrimoireSchedulerSubsystem::Cancel(FGrimoireScheduleHandle& Handle)
+{
+    const int32 EntryIndex = Handle.Index;
+    Handle.Invalidate();
+
+    if (!Entries.IsValidIndex(EntryIndex) || Entries[EntryIndex].Serial != Handle.Serial || !Entries[EntryIndex].Continuation.IsBound())
+    {
+        return false;
+    }
+
+    // Entries in the current batch are skipped by their serial
+    if (Entries[EntryIndex].Slot != NoSlot)
+    {
+        Unlink(EntryIndex);
+        --NumPending;
+    }
+    Release(EntryIndex);
+    return true;
+}
+
+void UGrimoireSchedulerSubsystem::Link(int32 EntryIndex)
+{
+    FEntry& Entry = Entries[EntryIndex];
+    const uint64 Delta = Entry.DueTick - CurrentTick;
+
+    // The level is the coarsest one whose slot width still fits inside the remaining delay
+    int32 Level = 0;
+    while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+    {
+        ++Level;
+    }
+
+    const int32 Slot = Level * SlotsPerLevel + static_cast<int32>((Entry.DueTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+
+    Entry.Slot = Slot;
+    Entry.Prev = INDEX_NONE;
+    Entry.Next = SlotHeads[Slot];
+    if (Entry.Next != INDEX_NONE)
+    {
+        Entries[Entry.Next].Prev = EntryIndex;
+    }
+    SlotHeads[Slot] = EntryIndex;
+}
+
+void UGrimoireSchedulerSubsystem::Unlink(int32 EntryIndex)
+{
+    FEntry& Entry = Entries[EntryIndex];
+    if (Entry.Prev != INDEX_NONE)
+    {
+        Entries[Entry.Prev].Next = Entry.Next;
+    }
+    else
+    {
+        SlotHeads[Entry.Slot] = Entry.Next;
+    }
+    if (Entry.Next != INDEX_NONE)
+    {
+        Entries[Entry.Next].Prev = Entry.Prev;
+    }
+
+    Entry.Prev = INDEX_NONE;
+    Entry.Next = INDEX_NONE;
+    Entry.Slot = NoSlot;
+}
+
+void UGrimoireSchedulerSubsystem::Release(int32 EntryIndex)
+{
+    FEntry& Entry = Entries[EntryIndex];
+    Entry.Continuation.Unbind();
+    Entry.Slot = NoSlot;
+    ++Entry.Serial;
+
+    Entry.Next = FirstFree;
+    FirstFree = EntryIndex;
+}
+
+void UGrimoireSchedulerSubsystem::Advance(uint64 TargetTick)
+{
+    while (CurrentTick < TargetTick && NumPending > 0)
+    {
+        ++CurrentTick;
+
+        // When a level wraps, spread the next slot of the level above over the finer levels
+        for (int32 Level = 1; Level < NumLevels; ++Level)
+        {
+            const uint64 LevelMask = (uint64(1) << (SlotBits * Level)) - 1;
+            if ((CurrentTick & LevelMask) != 0)
+            {
+                break;
+            }
+
+            const int32 Slot = Level * SlotsPerLevel + static_cast<int32>((CurrentTick >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+            int32 EntryIndex = SlotHeads[Slot];
+            SlotHeads[Slot] = INDEX_NONE;
+            while (EntryIndex != INDEX_NONE)
+            {
+                const int32 Next = Entries[EntryIndex].Next;
+                Link(EntryIndex);
+                EntryIndex = Next;
+            }
+        }
+
+        const int32 Slot = static_cast<int32>(CurrentTick & (SlotsPerLevel - 1));
+        int32 EntryIndex = SlotHeads[Slot];
+        SlotHeads[Slot] = INDEX_NONE;
+        while (EntryIndex != INDEX_NONE)
+        {
+            FEntry& Entry = Entries[EntryIndex];
+            const int32 Next = Entry.Next;
+            Entry.Prev = INDEX_NONE;
+            Entry.Next = INDEX_NONE;
+            Entry.Slot = NoSlot;
+            DueBatch.Emplace(EntryIndex, Entry.Serial);
+            --NumPending;
+            EntryIndex = Next;
+        }
+    }
+
+    // An empty wheel has nothing to cascade, so skip straight to the target
+    CurrentTick = FMath::Max(CurrentTick, TargetTick);
+}
+
+void UGrimoireSchedulerSubsystem::Tick(float DeltaTime)
+{
+    Advance(GetCurrentWorldTick());
+
+    // Continuations may schedule or cancel others; new ones land in the wheel, not this batch
+    for (int32 BatchIndex = 0; BatchIndex < DueBatch.Num(); ++BatchIndex)
+    {
+        const int32 EntryIndex = DueBatch[BatchIndex].Key;
+        if (Entries[EntryIndex].Serial != DueBatch[BatchIndex].Value)
+        {
+            continue;
+        }
+
+        FSimpleDelegate Continuation = MoveTemp(Entries[EntryIndex].Continuation);
+        Release(EntryIndex);
+        Continuation.ExecuteIfBound();
+    }
+    DueBatch.Reset();
+}
@@ -0,0 +1,228 @@
+#include "Subsystems/GrimoireStatusSubsystem.h"
+#include "Subsystems/GrimoireDamageSubsystem.h"
+#include "GrimoireSettings.h"
+#include "GrimoireStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Statuses"), STAT_GrimoireActiveStatuses, STATGROUP_Grimoire);
+
+namespace GrimoireStatus
+{
+    // Element the damage of each damaging status is dealt as
+    static ESpellElement GetDamageElement(EStatusEffectType Status)
+    {
+        switch (Status)
+        {
+            case EStatusEffectType::Burning:
+                return ESpellElement::Fire;
+            case EStatusEffectType::Poisoned:
+                return ESpellElement::Poison;
+            default:
+                return ESpellElement::MAX;
+        }
+    }
+}
+
+void UGrimoireStatusSubsystem::Deinitialize()
+{
+    // Pending expiries die with the scheduler
+    DEC_DWORD_STAT_BY(STAT_GrimoireActiveStatuses, Statuses.Num());
+
+    Targets.Empty();
+    Statuses.Empty();
+    Instigators.Empty();
+    DamagePerSecond.Empty();
+    ExpiresAt.Empty();
+    LastCharged.Empty();
+    ExpiryHandles.Empty();
+    StatusIndex.Empty();
+    StatusMasks.Empty();
+    DamageThisTick.Empty();
+
+    Super::Deinitialize();
+}
+
+TStatId UGrimoireStatusSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrimoireStatusSubsystem, STATGROUP_Tickables);
+}
+
+void UGrimoireStatusSubsystem::ApplyStatus(AActor* Target, EStatusEffectType Status, float Duration, AActor* Instigator)
+{
+    UGrimoireSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UGrimoireSchedulerSubsystem>();
+    if (!Target || Duration <= 0.0f || Status >= EStatusEffectType::MAX || !Scheduler)
+    {
+        return;
+    }
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    const TObjectKey<AActor> TargetKey(Target);
+    const FStatusKey Key(TargetKey, Status);
+
+    int32 Index = INDEX_NONE;
+    bool bAdded = false;
+    if (const int32* Existing = StatusIndex.Find(Key))
+    {
+        Index = *Existing;
+        Instigators[Index] = Instigator;
+        if (Now + Duration <= ExpiresAt[Index])
+        {
+            return;
+        }
+        Scheduler->Cancel(ExpiryHandles[Index]);
+    }
+    else
+    {
+        const float* Damage = GetDefault<UGrimoireSettings>()->StatusDamagePerSecond.Find(Status);
+
+        Index = Targets.Add(TargetKey);
+        Statuses.Add(Status);
+        Instigators.Add(Instigator);
+        DamagePerSecond.Add(Damage ? *Damage : 0.0f);
+        ExpiresAt.AddZeroed();
+        LastCharged.Add(Now);
+        ExpiryHandles.AddDefaulted();
+        StatusIndex.Add(Key, Index);
+        StatusMasks.FindOrAdd(TargetKey) |= 1 << static_cast<uint8>(Status);
+
+        INC_DWORD_STAT(STAT_GrimoireActiveStatuses);
+        bAdded = true;
+    }
+
+    ExpiresAt[Index] = Now + Duration;
+    ExpiryHandles[Index] = Scheduler->Schedule(Duration, FSimpleDelegate::CreateUObject(this, &UGrimoireStatusSubsystem::HandleExpired, TargetKey, Status));
+
+    // Last, since listeners may change statuses themselves
+    if (bAdded)
+    {
+        OnStatusChanged.Broadcast(Target, Status, true);
+    }
+}
+
+bool UGrimoireStatusSubsystem::RemoveStatus(AActor* Target, EStatusEffectType Status)
+{
+    const int32* Index = StatusIndex.Find(FStatusKey(TObjectKey<AActor>(Target), Status));
+    if (!Index)
+    {
+        return false;
+    }
+
+    if (UGrimoireSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UGrimoireSchedulerSubsystem>())
+    {
+        Scheduler->Cancel(ExpiryHandles[*Index]);
+    }
+    ChargeFinal(*Index, GetWorld()->GetTimeSeconds());
+    RemoveAt(*Index);
+    return true;
+}
+
+void UGrimoireStatusSubsystem::HandleExpired(TObjectKey<AActor> TargetKey, EStatusEffectType Status)
+{
+    if (const int32* Index = StatusIndex.Find(FStatusKey(TargetKey, Status)))
+    {
+        ExpiryHandles[*Index].Invalidate();
+        ChargeFinal(*Index, GetWorld()->GetTimeSeconds());
+        RemoveAt(*Index);
+    }
+}
+
+void UGrimoireStatusSubsystem::RemoveAt(int32 Index)
+{
+    const TObjectKey<AActor> TargetKey = Targets[Index];
+    const EStatusEffectType Status = Statuses[Index];
+
+    StatusIndex.Remove(FStatusKey(TargetKey, Status));
+    uint8& Mask = StatusMasks.FindChecked(TargetKey);
+    Mask &= ~(1 << static_cast<uint8>(Status));
+    if (Mask == 0)
+    {
+        StatusMasks.Remove(TargetKey);
+    }
+
+    Targets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Statuses.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Instigators.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    DamagePerSecond.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    ExpiresAt.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    LastCharged.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    ExpiryHandles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    // The last status moved into the hole
+    if (Index < Targets.Num())
+    {
+        StatusIndex[FStatusKey(Targets[Index], Statuses[Index])] = Index;
+    }
+
+    DEC_DWORD_STAT(STAT_GrimoireActiveStatuses);
+    OnStatusChanged.Broadcast(TargetKey.ResolveObjectPtr(), Status, false);
+}
+
+void UGrimoireStatusSubsystem::Tick(float DeltaTime)
+{
+    const float Interval = GetDefault<UGrimoireSettings>()->StatusDamageInterval;
+    TimeSinceDamage += DeltaTime;
+    if (TimeSinceDamage < Interval)
+    {
+        return;
+    }
+
+    TimeSinceDamage = 0.0f;
+    if (Statuses.Num() > 0)
+    {
+        ApplyDamageOverTime(GetWorld()->GetTimeSeconds());
+    }
+}
+
+void UGrimoireStatusSubsystem::ApplyDamageOverTime(double Now)
+{
+    const int32 NumStatuses = Statuses.Num();
+    DamageThisTick.SetNumUninitialized(NumStatuses, EAllowShrinking::No);
+
+    // A status that expired since the last pass is only charged up to its expiry; HandleExpired charges nothing more
+    for (int32 Index = 0; Index < NumStatuses; ++Index)
+    {
+        const double ChargedTo = FMath::Min(Now, ExpiresAt[Index]);
+        DamageThisTick[Index] = static_cast<float>(FMath::Max(0.0, ChargedTo - LastCharged[Index]));
+        LastCharged[Index] = FMath::Max(LastCharged[Index], ChargedTo);
+    }
+
+    int32 Index = 0;
+    for (; Index + 4 <= NumStatuses; Index += 4)
+    {
+        VectorStore(VectorMultiply(VectorLoad(&DamagePerSecond[Index]), VectorLoad(&DamageThisTick[Index])), &DamageThisTick[Index]);
+    }
+    for (; Index < NumStatuses; ++Index)
+    {
+        DamageThisTick[Index] *= DamagePerSecond[Index];
+    }
+
+    UGrimoireDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UGrimoireDamageSubsystem>();
+    for (Index = 0; Index < NumStatuses; ++Index)
+    {
+        SendDamage(DamageSubsystem, Index, DamageThisTick[Index]);
+    }
+}
+
+void UGrimoireStatusSubsystem::ChargeFinal(int32 Index, double Now)
+{
+    const double ChargedTo = FMath::Min(Now, ExpiresAt[Index]);
+    const float Seconds = static_cast<float>(FMath::Max(0.0, ChargedTo - LastCharged[Index]));
+    LastCharged[Index] = FMath::Max(LastCharged[Index], ChargedTo);
+    SendDamage(GetWorld()->GetSubsystem<UGrimoireDamageSubsystem>(), Index, DamagePerSecond[Index] * Seconds);
+}
+
+void UGrimoireStatusSubsystem::SendDamage(UGrimoireDamageSubsystem* DamageSubsystem, int32 Index, float Damage)
+{
+    if (Damage <= 0.0f)
+    {
+        return;
+    }
+
+    // Aggregated with the frame's other spell damage, so a target takes one event per instigator and element
+    AActor* Target = Targets[Index].ResolveObjectPtr();
+    if (DamageSubsystem && Target)
+    {
+        DamageSubsystem->AddHit(Target, Damage, Instigators[Index].Get(), GrimoireStatus::GetDamageElement(Statuses[Index]));
+    }
+}
@@ -0,0 +1,107 @@
+#include "Subsystems/GrimoireVFXSubsystem.h"
+#include "GrimoireSettings.h"
+#include "GrimoireStats.h"
+#include "Algo/StableSort.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "NiagaraFunctionLibrary.h"
+#include "NiagaraSystem.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("VFX Requests"), STAT_GrimoireVFXRequests, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VFX Spawned"), STAT_GrimoireVFXSpawned, STATGROUP_Grimoire);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VFX Dropped"), STAT_GrimoireVFXDropped, STATGROUP_Grimoire);
+
+bool UGrimoireVFXSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_SERVER
+    return false;
+#else
+    // Dedicated servers and -nullrhi runs have nobody to show effects to
+    if (IsRunningDedicatedServer() || !FApp::CanEverRender())
+    {
+        return false;
+    }
+    return Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+void UGrimoireVFXSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // Loaded once here instead of on every collision
+    ElementalCollisionEffect = GetDefault<UGrimoireSettings>()->ElementalCollisionEffect.LoadSynchronous();
+}
+
+void UGrimoireVFXSubsystem::Deinitialize()
+{
+    Pending.Empty();
+    PendingIndex.Empty();
+    ElementalCollisionEffect = nullptr;
+
+    Super::Deinitialize();
+}
+
+TStatId UGrimoireVFXSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrimoireVFXSubsystem, STATGROUP_Tickables);
+}
+
+void UGrimoireVFXSubsystem::RequestEffect(UNiagaraSystem* System, const FVector& Location, EGrimoireVFXPriority Priority)
+{
+    if (!System)
+    {
+        return;
+    }
+
+    INC_DWORD_STAT(STAT_GrimoireVFXRequests);
+
+    const float MergeDistance = FMath::Max(GetDefault<UGrimoireSettings>()->EffectMergeDistance, 1.0f);
+    const FIntVector Cell(
+        FMath::FloorToInt32(Location.X / MergeDistance),
+        FMath::FloorToInt32(Location.Y / MergeDistance),
+        FMath::FloorToInt32(Location.Z / MergeDistance));
+
+    int32& Index = PendingIndex.FindOrAdd(TTuple<FObjectKey, FIntVector>(FObjectKey(System), Cell), INDEX_NONE);
+    if (Index == INDEX_NONE)
+    {
+        Index = Pending.AddDefaulted();
+        Pending[Index].System = System;
+    }
+
+    FVFXRequest& Request = Pending[Index];
+    Request.LocationSum += Location;
+    ++Request.Count;
+    Request.Priority = FMath::Max(Request.Priority, Priority);
+}
+
+void UGrimoireVFXSubsystem::Tick(float DeltaTime)
+{
+    if (Pending.Num() == 0)
+    {
+        return;
+    }
+
+    const int32 Budget = GetDefault<UGrimoireSettings>()->MaxEffectsPerFrame;
+    if (Pending.Num() > Budget)
+    {
+        Algo::StableSortBy(Pending, [](const FVFXRequest& Request) { return Request.Priority; }, TGreater<>());
+    }
+
+    UWorld* World = GetWorld();
+    const int32 NumSpawned = FMath::Min(Pending.Num(), Budget);
+    for (int32 Index = 0; Index < NumSpawned; ++Index)
+    {
+        const FVFXRequest& Request = Pending[Index];
+        if (UNiagaraSystem* System = Request.System.Get())
+        {
+            UNiagaraFunctionLibrary::SpawnSystemAtLocation(World, System, Request.LocationSum / Request.Count);
+        }
+    }
+
+    INC_DWORD_STAT_BY(STAT_GrimoireVFXSpawned, NumSpawned);
+    INC_DWORD_STAT_BY(STAT_GrimoireVFXDropped, Pending.Num() - NumSpawned);
+
+    Pending.Reset();
+    PendingIndex.Reset();
+}
@@ -0,0 +1,105 @@
+#include "Misc/AutomationTest.h"
+#include "Spells/ElementInteractionMatrix.h"
+#include "Subsystems/GrimoireProjectileSubsystem.h"
+#include "Engine/DataTable.h"
+#include "UObject/Package.h"
+#include "Misc/ScopeExit.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ElementalCollisionTest
+{
+    // Every pair listed and neutral, except Fire and Water, which cancel
+    static UDataTable* MakeInteractionTable()
+    {
+        UDataTable* Table = NewObject<UDataTable>(GetTransientPackage());
+        Table->RowStruct = FElementInteractionRow::StaticStruct();
+
+        for (int32 Source = 0; Source < FElementInteractionMatrix::NumElements; ++Source)
+        {
+            FElementInteractionRow Row;
+            for (int32 Target = 0; Target < FElementInteractionMatrix::NumElements; ++Target)
+            {
+                FElementInteraction& Interaction = Row.Interactions.AddDefaulted_GetRef();
+                Interaction.SourceElement = static_cast<ESpellElement>(Source);
+                Interaction.TargetElement = static_cast<ESpellElement>(Target);
+
+                const bool bFireWater = (Interaction.SourceElement == ESpellElement::Fire && Interaction.TargetElement == ESpellElement::Water)
+                    || (Interaction.SourceElement == ESpellElement::Water && Interaction.TargetElement == ESpellElement::Fire);
+                Interaction.bCancelsProjectiles = bFireWater;
+                Interaction.DamageMultiplier = bFireWater ? 0.5f : 1.0f;
+            }
+            Table->AddRow(*FString::Printf(TEXT("Row%d"), Source), Row);
+        }
+        return Table;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FElementalCollisionCancelTest, "Grimoire.Projectile.OnlyCancellingPairsCollide",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FElementalCollisionCancelTest::RunTest(const FString& Parameters)
+{
+    TArray<FString> Errors;
+    const TSharedPtr<const FElementInteractionMatrix> Matrix = FElementInteractionMatrix::Compile(ElementalCollisionTest::MakeInteractionTable(), Errors);
+    if (!TestTrue(TEXT("The test table compiles cleanly"), Matrix.IsValid()))
+    {
+        return false;
+    }
+
+    // The matrix is process-wide, so put back exactly what was in use however the test exits
+    const TSharedRef<const FElementInteractionMatrix> Previous = FElementInteractionMatrix::GetShared();
+    ON_SCOPE_EXIT
+    {
+        FElementInteractionMatrix::Publish(Previous);
+    };
+    FElementInteractionMatrix::Publish(Matrix.ToSharedRef());
+
+    UGrimoireProjectileSubsystem* Projectiles = NewObject<UGrimoireProjectileSubsystem>(GetTransientPackage());
+    const FVector Velocity(1.0f, 0.0f, 0.0f);
+
+    // Overlapping pairs, far enough apart that they never meet each other
+    Projectiles->Launch(FVector(0.0f, 0.0f, 0.0f), Velocity, ESpellElement::Fire, 1000.0f, nullptr, nullptr, NAME_None);
+    Projectiles->Launch(FVector(5.0f, 0.0f, 0.0f), Velocity, ESpellElement::Water, 1000.0f, nullptr, nullptr, NAME_None);
+    Projectiles->Launch(FVector(0.0f, 5000.0f, 0.0f), Velocity, ESpellElement::Earth, 1000.0f, nullptr, nullptr, NAME_None);
+    Projectiles->Launch(FVector(5.0f, 5000.0f, 0.0f), Velocity, ESpellElement::Plant, 1000.0f, nullptr, nullptr, NAME_None);
+
+    Projectiles->Tick(0.01f);
+
+    TestEqual(TEXT("Only the cancelling pair is removed"), Projectiles->GetNumProjectiles(), 2);
+    TSet<ESpellElement> Remaining;
+    for (int32 Index = 0; Index < Projectiles->GetNumProjectiles(); ++Index)
+    {
+        Remaining.Add(Projectiles->GetElement(Index));
+    }
+    TestTrue(TEXT("A pair that does not cancel passes through each other"),
+        Remaining.Contains(ESpellElement::Earth) && Remaining.Contains(ESpellElement::Plant));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FElementInteractionCompileTest, "Grimoire.Elements.CompileRejectsIncompleteTables",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FElementInteractionCompileTest::RunTest(const FString& Parameters)
+{
+    UDataTable* Table = ElementalCollisionTest::MakeInteractionTable();
+
+    TArray<FString> Errors;
+    const TSharedPtr<const FElementInteractionMatrix> Matrix = FElementInteractionMatrix::Compile(Table, Errors);
+    if (!TestTrue(TEXT("A complete table compiles"), Matrix.IsValid()))
+    {
+        return false;
+    }
+    TestTrue(TEXT("A pair with an outcome reacts"), Matrix->Find(ESpellElement::Fire, ESpellElement::Water).bReacts);
+    TestFalse(TEXT("A listed but neutral pair does not react"), Matrix->Find(ESpellElement::Earth, ESpellElement::Plant).bReacts);
+
+    Table->RemoveRow(TEXT("Row0"));
+    Errors.Reset();
+    TestFalse(TEXT("A table missing pairs is not compiled"), FElementInteractionMatrix::Compile(Table, Errors).IsValid());
+    TestTrue(TEXT("The missing pairs are reported"), Errors.Num() > 0);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "Misc/AutomationTest.h"
+#include "Spells/SpellExecutionContext.h"
+#include "Subsystems/GrimoireContextSubsystem.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpellCastSettlesAfterYieldTest, "Grimoire.Cast.SettlesAfterYield",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpellCastSettlesAfterYieldTest::RunTest(const FString& Parameters)
+{
+    UGrimoireContextSubsystem* Pool = NewObject<UGrimoireContextSubsystem>(GetTransientPackage());
+    USpellExecutionContext* Context = Pool->BeginCast();
+
+    int32 NumSettled = 0;
+    int32 SettledFuel = 0;
+    bool bSettledOutOfFuel = false;
+    Context->SetFuelBudget(10);
+    Context->SetOnCastFinished([&](const FSpellCast& Cast)
+    {
+        ++NumSettled;
+        SettledFuel = Cast.FuelUsed;
+        bSettledOutOfFuel = Cast.IsOutOfFuel();
+    });
+
+    // First slice runs out of frame budget and parks on the executor, as FSpellInterpreter::Park does
+    Context->ConsumeFuel(4);
+    Context->RetainCast();
+
+    // The caster releases its reference once the synchronous run returns
+    Context->ReleaseCast();
+    TestEqual(TEXT("A yielded cast is not settled when the caster releases it"), NumSettled, 0);
+
+    // The resumed slice runs dry, then the interpreter drops its reference
+    Context->ConsumeFuel(8);
+    Context->ReleaseCast();
+    TestEqual(TEXT("The cast is settled once"), NumSettled, 1);
+    TestEqual(TEXT("Fuel from every slice is settled"), SettledFuel, 12);
+    TestTrue(TEXT("Running dry after a yield is seen by the settlement"), bSettledOutOfFuel);
+    TestEqual(TEXT("The cast is back in the pool"), Pool->GetNumActiveCasts(), 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpellCastUnpooledSettlesTest, "Grimoire.Cast.UnpooledSettlesOnRelease",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpellCastUnpooledSettlesTest::RunTest(const FString& Parameters)
+{
+    USpellExecutionContext* Context = NewObject<USpellExecutionContext>(GetTransientPackage());
+
+    int32 NumSettled = 0;
+    Context->SetFuelBudget(10);
+    Context->SetOnCastFinished([&NumSettled](const FSpellCast& Cast) { ++NumSettled; });
+
+    // A delay node retains the cast until its continuation runs
+    Context->RetainCast();
+    Context->ReleaseCast();
+    TestEqual(TEXT("A cast with a pending delay is not settled"), NumSettled, 0);
+
+    Context->ReleaseCast();
+    TestEqual(TEXT("The cast is settled when the delay releases it"), NumSettled, 1);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,398 @@
+#include "Misc/AutomationTest.h"
+#include "Spells/SpellOptimizer.h"
+#include "Spells/SpellInterpreter.h"
+#include "Spells/SpellExecutionContext.h"
+#include "Spells/ConditionNode.h"
+#include "Spells/EffectNode.h"
+#include "Spells/FlowNode.h"
+#include "Spells/VariableNode.h"
+#include "Subsystems/GrimoireDamageSubsystem.h"
+#include "Model/HeartGraph.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SpellOptimizerTest
+{
+    struct FTestInstruction
+    {
+        USpellNode* Node = nullptr;
+        ESpellOpCode OpCode = ESpellOpCode::Action;
+        TArray<USpellNode*> Exits[2];
+    };
+
+    // Spell lowered by hand, one instruction per node, since nothing in the plugin connects graph pins yet.
+    // The first node added is the OnCast entry.
+    struct FTestSpell
+    {
+        UHeartGraph* Graph = NewObject<UHeartGraph>(GetTransientPackage());
+        TArray<FTestInstruction> Instructions;
+
+        template <typename NodeType>
+        NodeType* Add(ESpellOpCode OpCode)
+        {
+            NodeType* Node = NewObject<NodeType>(Graph);
+            Graph->AddNode(Node);
+
+            FTestInstruction& Instruction = Instructions.AddDefaulted_GetRef();
+            Instruction.Node = Node;
+            Instruction.OpCode = OpCode;
+            return Node;
+        }
+
+        UFlowNode* AddFlow(EFlowNodeType FlowType, ESpellOpCode OpCode)
+        {
+            UFlowNode* Flow = Add<UFlowNode>(OpCode);
+            Flow->FlowType = FlowType;
+
+            // Paced loops keep their timing, so the optimizer leaves them alone
+            Flow->IterationDelay = 0.0f;
+            return Flow;
+        }
+
+        UEffectNode* AddDamage(float Intensity)
+        {
+            UEffectNode* Effect = Add<UEffectNode>(ESpellOpCode::Action);
+            Effect->EffectType = EEffectType::Damage;
+            Effect->Intensity = Intensity;
+            return Effect;
+        }
+
+        UFlowNode* AddForLoop(int32 MaxIterations)
+        {
+            UFlowNode* Loop = AddFlow(EFlowNodeType::ForLoop, ESpellOpCode::ForLoop);
+            Loop->MaxIterations = MaxIterations;
+            return Loop;
+        }
+
+        UVariableNode* AddVariable(FName VariableName, EVariableNodeOperation Operation)
+        {
+            UVariableNode* Variable = Add<UVariableNode>(ESpellOpCode::Action);
+            Variable->VariableName = VariableName;
+            Variable->Operation = Operation;
+            return Variable;
+        }
+
+        // Runs Then when VariableName holds a positive value, which makes the variable something the spell reads
+        UConditionNode* AddReader(FName VariableName, USpellNode* Then)
+        {
+            UConditionNode* Reader = Add<UConditionNode>(ESpellOpCode::Condition);
+            Reader->ConditionType = EConditionType::IfThen;
+            Reader->VariableName = VariableName;
+            Link(Reader, 0, { Then });
+            return Reader;
+        }
+
+        void Link(const USpellNode* From, int32 ExitIndex, std::initializer_list<USpellNode*> To)
+        {
+            Instructions.FindByPredicate([From](const FTestInstruction& Item) { return Item.Node == From; })->Exits[ExitIndex].Append(To);
+        }
+
+        TSharedRef<FCompiledSpell> Lower() const
+        {
+            // Resolves every node's register slots against the finished graph
+            FSpellGraphIndex::Invalidate(Graph);
+
+            TSharedRef<FCompiledSpell> Program = MakeShared<FCompiledSpell>();
+            Program->SourceIndex = FSpellGraphIndex::Get(Graph);
+
+            for (const FTestInstruction& Item : Instructions)
+            {
+                FSpellInstruction& Instruction = Program->Instructions.AddDefaulted_GetRef();
+                Instruction.OpCode = Item.OpCode;
+                Instruction.NodeIndex = static_cast<uint16>(Program->Nodes.Add(Item.Node));
+                Program->Rarity = FMath::Max(Program->Rarity, Item.Node->NodeRarity);
+            }
+
+            for (int32 Index = 0; Index < Instructions.Num(); ++Index)
+            {
+                for (int32 ExitIndex = 0; ExitIndex < 2; ++ExitIndex)
+                {
+                    const TArray<USpellNode*>& Exit = Instructions[Index].Exits[ExitIndex];
+                    FSpellExitRange& Range = Program->Instructions[Index].Exits[ExitIndex];
+                    Range.Start = static_cast<uint16>(Program->Successors.Num());
+                    Range.Num = static_cast<uint16>(Exit.Num());
+
+                    for (const USpellNode* Successor : Exit)
+                    {
+                        Program->Successors.Add(static_cast<uint16>(Instructions.IndexOfByPredicate(
+                            [Successor](const FTestInstruction& Item) { return Item.Node == Successor; })));
+                    }
+                }
+            }
+
+            Program->EntryPoints.Add(0);
+            for (int32 Kind = static_cast<int32>(ETriggerEventType::OnCast) + 1; Kind <= FSpellGraphIndex::EntryKindCount; ++Kind)
+            {
+                Program->EntryOffsets[Kind] = 1;
+            }
+            Program->EntryPoint = 0;
+            Program->MaxDepth = Program->ComputeMaxDepth();
+            return Program;
+        }
+    };
+
+    // Instruction running Node, or null once the optimizer has removed it
+    static const FSpellInstruction* FindInstruction(const FCompiledSpell& Program, const USpellNode* Node)
+    {
+        return Program.Instructions.FindByPredicate([&Program, Node](const FSpellInstruction& Instruction)
+        {
+            return Program.Nodes[Instruction.NodeIndex] == Node;
+        });
+    }
+
+    // What a cast leaves behind that the optimizer has to preserve
+    struct FOutcome
+    {
+        TArray<FSpellValue> Registers;
+        TArray<float> Hits;
+    };
+
+    // Counters the optimizer stops writing once it has proved nothing in the spell reads them
+    static bool IsElidedCounter(int32 Slot)
+    {
+        if (Slot >= FSpellRegisterLayout::BuiltinCount)
+        {
+            return false;
+        }
+
+        switch (static_cast<ESpellRegister>(Slot))
+        {
+            case ESpellRegister::SequenceIndex:
+            case ESpellRegister::SequenceTotal:
+            case ESpellRegister::LoopIndex:
+            case ESpellRegister::LoopTotal:
+            case ESpellRegister::WhileIndex:
+            case ESpellRegister::ForIndex:
+            case ESpellRegister::ForTotal:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static FOutcome Run(const TSharedRef<const FCompiledSpell>& Program, AActor* Target, UGrimoireDamageSubsystem* Damage)
+    {
+        USpellExecutionContext* Context = NewObject<USpellExecutionContext>(GetTransientPackage());
+        Context->SetTarget(Target);
+        FSpellInterpreter::Execute(Program, Context);
+
+        FOutcome Outcome;
+        for (int32 Slot = 0; Slot < Context->GetRegisterLayout().Num(); ++Slot)
+        {
+            Outcome.Registers.Add(IsElidedCounter(Slot) ? FSpellValue() : Context->GetRegister(Slot));
+        }
+
+        // Every hit shares an instigator, target and element, so one summary lists them in recording order
+        for (const FSpellDamageSummary& Summary : Damage->GetPendingDamage())
+        {
+            for (const FSpellDamageHit& Hit : Summary.Hits)
+            {
+                Outcome.Hits.Add(Hit.Amount);
+            }
+        }
+        Damage->Flush();
+
+        Context->ReleaseCast();
+        return Outcome;
+    }
+
+    // Runs Program as lowered and optimized, each on a fresh context, checks both leave the same
+    // registers and damage, and returns the optimized program
+    static TSharedRef<const FCompiledSpell> TestOptimizedRunMatches(FAutomationTestBase& Test, const TCHAR* What,
+        const TSharedRef<FCompiledSpell>& Program, AActor* Target, UGrimoireDamageSubsystem* Damage)
+    {
+        const TSharedRef<FCompiledSpell> Optimized = MakeShared<FCompiledSpell>(*Program);
+        FSpellOptimizer::Optimize(*Optimized);
+
+        const FOutcome Expected = Run(Program, Target, Damage);
+        const FOutcome Actual = Run(Optimized, Target, Damage);
+
+        if (Test.TestEqual(FString::Printf(TEXT("%s: the optimized spell deals as many hits"), What), Actual.Hits.Num(), Expected.Hits.Num()))
+        {
+            for (int32 Index = 0; Index < Expected.Hits.Num(); ++Index)
+            {
+                Test.TestEqual(FString::Printf(TEXT("%s: hit %d"), What, Index), Actual.Hits[Index], Expected.Hits[Index]);
+            }
+        }
+
+        const FSpellRegisterLayout& Layout = *Program->SourceIndex->GetRegisterLayout();
+        for (int32 Slot = 0; Slot < Expected.Registers.Num() && Slot < Actual.Registers.Num(); ++Slot)
+        {
+            Test.TestTrue(FString::Printf(TEXT("%s: %s is %s, not %s"), What, *Layout.GetSlotName(Slot).ToString(),
+                *Actual.Registers[Slot].ToString(), *Expected.Registers[Slot].ToString()), Actual.Registers[Slot] == Expected.Registers[Slot]);
+        }
+        return Optimized;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpellOptimizerBranchTest, "Grimoire.Optimizer.FoldedBranchesRunTheSame",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpellOptimizerBranchTest::RunTest(const FString& Parameters)
+{
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+
+    UGrimoireDamageSubsystem* Damage = World->GetSubsystem<UGrimoireDamageSubsystem>();
+    ACharacter* Target = World->SpawnActor<ACharacter>();
+
+    SpellOptimizerTest::FTestSpell Spell;
+    UFlowNode* Root = Spell.AddFlow(EFlowNodeType::Sequence, ESpellOpCode::Sequence);
+
+    // Unset inputs compare as 0 > -1 on every cast, so False never runs
+    UConditionNode* AlwaysTrue = Spell.Add<UConditionNode>(ESpellOpCode::Condition);
+    AlwaysTrue->ConditionType = EConditionType::Compare;
+    AlwaysTrue->ComparisonValue = -1.0f;
+    UEffectNode* AlwaysTrueThen = Spell.AddDamage(1.0f);
+    UEffectNode* AlwaysTrueElse = Spell.AddDamage(2.0f);
+    Spell.Link(AlwaysTrue, 0, { AlwaysTrueThen });
+    Spell.Link(AlwaysTrue, 1, { AlwaysTrueElse });
+
+    // 0 > 1 never holds, so True never runs
+    UConditionNode* AlwaysFalse = Spell.Add<UConditionNode>(ESpellOpCode::Condition);
+    AlwaysFalse->ConditionType = EConditionType::Compare;
+    AlwaysFalse->ComparisonValue = 1.0f;
+    UEffectNode* AlwaysFalseThen = Spell.AddDamage(3.0f);
+    Spell.Link(AlwaysFalse, 0, { AlwaysFalseThen });
+    Spell.Link(AlwaysFalse, 1, { Spell.AddDamage(4.0f) });
+
+    // Spell power 1 is not above 2, so the else branch runs
+    UConditionNode* WithElse = Spell.Add<UConditionNode>(ESpellOpCode::Condition);
+    WithElse->ConditionType = EConditionType::IfThenElse;
+    WithElse->ComparisonValue = 2.0f;
+    UEffectNode* WithElseElse = Spell.AddDamage(6.0f);
+    Spell.Link(WithElse, 0, { Spell.AddDamage(5.0f) });
+    Spell.Link(WithElse, 1, { WithElseElse });
+
+    // Without an else branch, False is wired but never taken
+    UConditionNode* WithoutElse = Spell.Add<UConditionNode>(ESpellOpCode::Condition);
+    WithoutElse->ConditionType = EConditionType::IfThen;
+    UEffectNode* WithoutElseElse = Spell.AddDamage(8.0f);
+    Spell.Link(WithoutElse, 0, { Spell.AddDamage(7.0f) });
+    Spell.Link(WithoutElse, 1, { WithoutElseElse });
+
+    // Always true, but Legendary also runs False on a weakened child context
+    UConditionNode* Legendary = Spell.Add<UConditionNode>(ESpellOpCode::Condition);
+    Legendary->ConditionType = EConditionType::Compare;
+    Legendary->ComparisonValue = -1.0f;
+    Legendary->NodeRarity = EItemRarity::Legendary;
+    UEffectNode* LegendaryElse = Spell.AddDamage(10.0f);
+    Spell.Link(Legendary, 0, { Spell.AddDamage(9.0f) });
+    Spell.Link(Legendary, 1, { LegendaryElse });
+
+    // Nothing writes GateOpen, so the gate stays open
+    UFlowNode* Gate = Spell.AddFlow(EFlowNodeType::Gate, ESpellOpCode::Gate);
+    UEffectNode* GateClosed = Spell.AddDamage(12.0f);
+    Spell.Link(Gate, 0, { Spell.AddDamage(11.0f) });
+    Spell.Link(Gate, 1, { GateClosed });
+
+    Spell.Link(Root, 0, { AlwaysTrue, AlwaysFalse, WithElse, WithoutElse, Legendary, Gate });
+
+    const TSharedRef<const FCompiledSpell> Optimized = SpellOptimizerTest::TestOptimizedRunMatches(*this, TEXT("Branches"), Spell.Lower(), Target, Damage);
+
+    TestNull(TEXT("False is dropped from a condition that always passes"), SpellOptimizerTest::FindInstruction(*Optimized, AlwaysTrueElse));
+    TestNull(TEXT("True is dropped from a condition that always fails"), SpellOptimizerTest::FindInstruction(*Optimized, AlwaysFalseThen));
+    TestNotNull(TEXT("An else branch is kept"), SpellOptimizerTest::FindInstruction(*Optimized, WithElseElse));
+    TestNull(TEXT("False is dropped from a condition without an else branch"), SpellOptimizerTest::FindInstruction(*Optimized, WithoutElseElse));
+    TestNotNull(TEXT("The Legendary second path is kept"), SpellOptimizerTest::FindInstruction(*Optimized, LegendaryElse));
+    TestNull(TEXT("Closed is dropped from a gate nobody closes"), SpellOptimizerTest::FindInstruction(*Optimized, GateClosed));
+    TestNull(TEXT("The open gate is spliced out"), SpellOptimizerTest::FindInstruction(*Optimized, Gate));
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpellOptimizerLoopTest, "Grimoire.Optimizer.OptimizedLoopsRunTheSame",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpellOptimizerLoopTest::RunTest(const FString& Parameters)
+{
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+
+    UGrimoireDamageSubsystem* Damage = World->GetSubsystem<UGrimoireDamageSubsystem>();
+    ACharacter* Target = World->SpawnActor<ACharacter>();
+
+    // Same count, only the first body acts on the world and neither reads what the other writes
+    {
+        SpellOptimizerTest::FTestSpell Spell;
+        UFlowNode* Root = Spell.AddFlow(EFlowNodeType::Sequence, ESpellOpCode::Sequence);
+        UFlowNode* First = Spell.AddForLoop(3);
+        UFlowNode* Second = Spell.AddForLoop(3);
+        Spell.Link(First, 0, { Spell.AddDamage(1.0f) });
+        Spell.Link(Second, 0, { Spell.AddVariable(TEXT("Charge"), EVariableNodeOperation::Increment) });
+        Spell.Link(Root, 0, { First, Second, Spell.AddReader(TEXT("Charge"), Spell.AddDamage(2.0f)) });
+
+        const TSharedRef<const FCompiledSpell> Optimized = SpellOptimizerTest::TestOptimizedRunMatches(*this, TEXT("Fused loops"), Spell.Lower(), Target, Damage);
+        TestNotNull(TEXT("The first loop runs both bodies"), SpellOptimizerTest::FindInstruction(*Optimized, First));
+        TestNull(TEXT("The second loop is fused into the first"), SpellOptimizerTest::FindInstruction(*Optimized, Second));
+    }
+
+    // The second body compares what the first one counts, so interleaving them would change how often it passes
+    {
+        SpellOptimizerTest::FTestSpell Spell;
+        UFlowNode* Root = Spell.AddFlow(EFlowNodeType::Sequence, ESpellOpCode::Sequence);
+        UFlowNode* First = Spell.AddForLoop(3);
+        UFlowNode* Second = Spell.AddForLoop(3);
+        Spell.Link(First, 0, { Spell.AddVariable(FSpellRegisterLayout::GetRegisterName(ESpellRegister::ConditionValue), EVariableNodeOperation::Increment) });
+
+        UConditionNode* Counted = Spell.Add<UConditionNode>(ESpellOpCode::Condition);
+        Counted->ConditionType = EConditionType::Compare;
+        Counted->ComparisonOperator = EComparisonOperator::GreaterEqual;
+        Counted->ComparisonValue = 3.0f;
+        Spell.Link(Counted, 0, { Spell.AddDamage(1.0f) });
+        Spell.Link(Second, 0, { Counted });
+        Spell.Link(Root, 0, { First, Second });
+
+        const TSharedRef<const FCompiledSpell> Optimized = SpellOptimizerTest::TestOptimizedRunMatches(*this, TEXT("Conflicting loops"), Spell.Lower(), Target, Damage);
+        TestNotNull(TEXT("A loop reading what its neighbour writes is not fused"), SpellOptimizerTest::FindInstruction(*Optimized, Second));
+    }
+
+    // A Get reads the same value on every iteration, so it can run once before the loop
+    {
+        SpellOptimizerTest::FTestSpell Spell;
+        UFlowNode* Root = Spell.AddFlow(EFlowNodeType::Sequence, ESpellOpCode::Sequence);
+        UFlowNode* Loop = Spell.AddForLoop(3);
+        UVariableNode* Get = Spell.AddVariable(TEXT("Stored"), EVariableNodeOperation::Get);
+        Get->DefaultFloatValue = 1.0f;
+        Spell.Link(Loop, 0, { Get, Spell.AddVariable(TEXT("Counter"), EVariableNodeOperation::Increment) });
+        Spell.Link(Root, 0, { Loop, Spell.AddReader(TEXT("Stored"), Spell.AddDamage(1.0f)), Spell.AddReader(TEXT("Counter"), Spell.AddDamage(2.0f)) });
+
+        const TSharedRef<const FCompiledSpell> Optimized = SpellOptimizerTest::TestOptimizedRunMatches(*this, TEXT("Hoisted Get"), Spell.Lower(), Target, Damage);
+        const FSpellInstruction* OptimizedLoop = SpellOptimizerTest::FindInstruction(*Optimized, Loop);
+        const FSpellInstruction* OptimizedRoot = SpellOptimizerTest::FindInstruction(*Optimized, Root);
+        if (TestNotNull(TEXT("The loop is kept"), OptimizedLoop) && TestNotNull(TEXT("The entry is kept"), OptimizedRoot))
+        {
+            const auto RunsGet = [&Optimized, Get](uint16 Successor) { return Optimized->Nodes[Optimized->Instructions[Successor].NodeIndex] == Get; };
+            TestFalse(TEXT("The Get has left the loop body"), Optimized->GetExit(*OptimizedLoop, 0).ContainsByPredicate(RunsGet));
+            TestTrue(TEXT("The Get runs before the loop"), Optimized->GetExit(*OptimizedRoot, 0).ContainsByPredicate(RunsGet));
+        }
+    }
+
+    // Legendary raises the iteration cap to 50, past what unrolling may lay out for a two node body
+    {
+        SpellOptimizerTest::FTestSpell Spell;
+        UFlowNode* Root = Spell.AddFlow(EFlowNodeType::Sequence, ESpellOpCode::Sequence);
+        UFlowNode* Loop = Spell.AddForLoop(20);
+        Loop->NodeRarity = EItemRarity::Legendary;
+        Spell.Link(Loop, 0, { Spell.AddDamage(1.0f), Spell.AddDamage(2.0f) });
+        Spell.Link(Root, 0, { Loop });
+
+        const TSharedRef<const FCompiledSpell> Optimized = SpellOptimizerTest::TestOptimizedRunMatches(*this, TEXT("Legendary loop"), Spell.Lower(), Target, Damage);
+        const FSpellInstruction* OptimizedLoop = SpellOptimizerTest::FindInstruction(*Optimized, Loop);
+        TestTrue(TEXT("The Legendary loop stays rolled"), OptimizedLoop && OptimizedLoop->OpCode == ESpellOpCode::ForLoop);
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    return true;
+}
+
+#endif
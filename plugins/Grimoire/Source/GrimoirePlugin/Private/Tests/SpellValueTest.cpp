@@ -0,0 +1,22 @@
+#include "Misc/AutomationTest.h"
+#include "Spells/SpellValue.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpellValueStringCaseTest, "Grimoire.Value.StringsKeepCase",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSpellValueStringCaseTest::RunTest(const FString& Parameters)
+{
+    const FSpellValue Lower = FSpellValue::FromString(TEXT("fireball"));
+    const FSpellValue Upper = FSpellValue::FromString(TEXT("FireBall"));
+
+    TestTrue(TEXT("Strings differing only in case intern separately"), Lower != Upper);
+    TestEqual(TEXT("The first spelling round-trips"), Lower.GetString(), FString(TEXT("fireball")));
+    TestEqual(TEXT("The second spelling round-trips"), Upper.GetString(), FString(TEXT("FireBall")));
+    TestTrue(TEXT("The same spelling shares a handle"), FSpellValue::FromString(TEXT("FireBall")) == Upper);
+
+    return true;
+}
+
+#endif
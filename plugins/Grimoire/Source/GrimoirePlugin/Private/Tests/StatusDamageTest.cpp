@@ -0,0 +1,74 @@
+#include "Misc/AutomationTest.h"
+#include "Subsystems/GrimoireStatusSubsystem.h"
+#include "Subsystems/GrimoireDamageSubsystem.h"
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
+#include "GrimoireSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StatusDamageTest
+{
+    static float GetPendingDamage(const UGrimoireDamageSubsystem* Damage, const AActor* Target)
+    {
+        float Total = 0.0f;
+        for (const FSpellDamageSummary& Summary : Damage->GetPendingDamage())
+        {
+            Total += Summary.Target.Get() == Target ? Summary.TotalDamage : 0.0f;
+        }
+        return Total;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStatusDamageMidIntervalTest, "Grimoire.Status.ChargesOnlyActiveTime",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FStatusDamageMidIntervalTest::RunTest(const FString& Parameters)
+{
+    const UGrimoireSettings* Settings = GetDefault<UGrimoireSettings>();
+    const float DamagePerSecond = Settings->StatusDamagePerSecond.FindRef(EStatusEffectType::Burning);
+    const float Interval = Settings->StatusDamageInterval;
+    if (DamagePerSecond <= 0.0f || Interval <= 0.0f)
+    {
+        AddInfo(TEXT("Burning deals no damage over time in this configuration"));
+        return true;
+    }
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+
+    UGrimoireStatusSubsystem* Statuses = World->GetSubsystem<UGrimoireStatusSubsystem>();
+    UGrimoireDamageSubsystem* Damage = World->GetSubsystem<UGrimoireDamageSubsystem>();
+    UGrimoireSchedulerSubsystem* Scheduler = World->GetSubsystem<UGrimoireSchedulerSubsystem>();
+    AActor* Target = World->SpawnActor<AActor>();
+
+    // Applied 40% into the first interval, for less than one interval, so it expires during the second
+    const double AppliedAt = Interval * 0.4;
+    const double Duration = Interval * 0.9;
+    World->TimeSeconds = AppliedAt;
+    Statuses->ApplyStatus(Target, EStatusEffectType::Burning, Duration, nullptr);
+
+    World->TimeSeconds = Interval;
+    Statuses->Tick(Interval);
+    TestEqual(TEXT("The first pass charges only the time since the status was applied"),
+        StatusDamageTest::GetPendingDamage(Damage, Target), DamagePerSecond * static_cast<float>(Interval - AppliedAt), 0.001f);
+
+    World->TimeSeconds = Interval * 2.0;
+    Scheduler->Tick(Interval);
+    TestFalse(TEXT("The status has expired"), Statuses->HasStatus(Target, EStatusEffectType::Burning));
+    TestEqual(TEXT("Expiry charges up to the expiry time, so the total is exactly the duration"),
+        StatusDamageTest::GetPendingDamage(Damage, Target), DamagePerSecond * static_cast<float>(Duration), 0.001f);
+
+    Statuses->Tick(Interval);
+    TestEqual(TEXT("Nothing is charged after expiry"),
+        StatusDamageTest::GetPendingDamage(Damage, Target), DamagePerSecond * static_cast<float>(Duration), 0.001f);
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    return true;
+}
+
+#endif
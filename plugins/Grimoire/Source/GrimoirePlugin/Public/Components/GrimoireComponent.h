@@ -7,8 +7,59 @@
 #include "AbilitySystemComponent.h"
 #include "EnhancedInputComponent.h"
 #include "Model/HeartGraph.h"
+#include "Spells/SpellCompiler.h"
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
 #include "GrimoireComponent.generated.h"
 
+class USpellExecutionContext;
+struct FSpellCast;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSpellCooldownExpired, FName, SpellName);
+
+USTRUCT(BlueprintType)
+struct FSpellDefinition
+{
+    GENERATED_BODY()
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Spell")
+    FName SpellName;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Spell")
+    UHeartGraph* SpellGraph = nullptr;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spell")
+    float ManaCost = 0.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spell")
+    float Cooldown = 1.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spell")
+    EGWTAbilityInputID InputBinding = EGWTAbilityInputID::None;
+
+    // Lowered form of SpellGraph with every entry point grouped by trigger kind, built on first cast
+    TSharedPtr<const FCompiledSpell> CompiledSpell;
+};
+
+/** Fuel burned by the casts of one spell, measured when each cast finishes, including its yielded and delayed runs */
+USTRUCT(BlueprintType)
+struct FSpellFuelStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Fuel")
+    int32 Casts = 0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Fuel")
+    int64 TotalFuel = 0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Fuel")
+    int32 PeakFuel = 0;
+
+    // Casts aborted because they ran out of fuel
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Fuel")
+    int32 OutOfFuelCasts = 0;
+};
+
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class GRIMOIREPLUGIN_API UGrimoireComponent : public UActorComponent
 {
@@ -19,7 +70,6 @@ public:
 
 protected:
     virtual void BeginPlay() override;
-    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 public:
     // Spell management
@@ -32,6 +82,10 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grimoire")
     void ExecuteSpell(FName SpellName);
 
+    // Runs the spell's entry points for Event, such as its OnHit triggers. Costs no mana and starts no cooldown.
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    void TriggerSpellEvent(FName SpellName, ETriggerEventType Event, AActor* Target);
+
     // Compile and grant GAS ability
     UFUNCTION(BlueprintCallable, Category = "GAS")
     void CompileAndGrantSpellAbility(FName SpellName, int32 InputID);
@@ -48,10 +102,11 @@ public:
 
     // Active spells
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grimoire", replicated)
-    TMap<FName, USpellNode*> ActiveSpells;
+    TMap<FName, FSpellDefinition> ActiveSpells;
 
-    // Mana management
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grimoire", ReplicatedUsing=OnRep_CurrentMana)
+    // Mana management. CurrentMana is the value at ManaTimestamp; regen since then is applied on read, see GetCurrentMana.
+    // Read-only so every write goes through SetCurrentMana and moves the timestamp with it.
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grimoire", Replicated)
     float CurrentMana;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grimoire")
@@ -64,7 +119,28 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grimoire")
     float BaseDamage;
 	
-    // Replication callbacks
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    float GetCurrentMana() const;
+
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    void SetCurrentMana(float NewMana);
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    bool IsSpellOnCooldown(FName SpellName) const;
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    float GetSpellCooldownRemaining(FName SpellName) const;
+
+    UPROPERTY(BlueprintAssignable, Category = "Grimoire")
+    FOnSpellCooldownExpired OnSpellCooldownExpired;
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    FSpellFuelStats GetSpellFuelStats(FName SpellName) const;
+
+    /** Timer chain the latest cast of SpellName started. Timer triggers from earlier casts stop firing. */
+    int32 GetTimerChain(FName SpellName) const;
+
+    // Replication callbacks. OnRep_CurrentMana fires on ManaTimestamp, which every server write moves, so it runs even when the value is unchanged.
     UFUNCTION()
     void OnRep_CurrentMana();
 
@@ -75,10 +151,45 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input")
     UInputMappingContext* InputContext;  // For Enhanced Input
 
-    USpellNode* FindRootNode(UHeartGraph* Graph) const;
-
 private:
+    struct FSpellCooldown
+    {
+        double ExpiresAt = 0.0;
+        FGrimoireScheduleHandle ExpiryHandle;
+    };
+
+    // Local world time, which cooldowns use since they are not replicated
+    double GetWorldTime() const;
+
+    // Server world time, so ManaTimestamp means the same on every machine
+    double GetManaTime() const;
+    void StartCooldown(FName SpellName, float Duration);
+    void ClearCooldown(FName SpellName);
+    void HandleCooldownExpired(FName SpellName);
+
+    // Server world time CurrentMana was last written at, replicated with it so clients regen from the server's anchor
+    UPROPERTY(ReplicatedUsing=OnRep_CurrentMana)
+    double ManaTimestamp = 0.0;
+
+    // Expiry time per spell. Entries are removed by the scheduler when they run out.
+    TMap<FName, FSpellCooldown> SpellCooldowns;
+
+    TMap<FName, FSpellFuelStats> FuelStats;
+
+    // Bumped per cast, so each spell has one live chain of timer triggers like the old per-component TimerHandle
+    TMap<FName, int32> TimerChains;
+
+    // Gives Context the fuel budget for Spell and this caster, and settles the cast when it finishes
+    void BeginMetering(USpellExecutionContext* Context, const FCompiledSpell& Spell, float ManaCost);
+
+    // Records the finished cast's fuel and refunds ManaCost if it ran dry and policy says so
+    void SettleCast(FName SpellName, float ManaCost, const FSpellCast& Cast);
+
     bool CanCastSpell(const USpellNode* SpellNode) const;
     void ConsumeMana(float Amount);
     float CalculateSpellManaCost(UHeartGraph* Graph) const;
+    float CalculateSpellPower(FName SpellName) const;
+
+    void ExecuteSpellInternal(FName SpellName, USpellExecutionContext* Context);
+    TSharedPtr<const FCompiledSpell> GetCompiledSpell(FSpellDefinition& SpellDef) const;
 };
\ No newline at end of file
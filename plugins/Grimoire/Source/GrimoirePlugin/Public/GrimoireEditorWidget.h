@@ -19,6 +19,9 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Grimoire Editor")
     void AddNode(TSubclassOf<USpellNode> NodeClass);
 
+    UFUNCTION(BlueprintCallable, Category = "Grimoire Editor")
+    void RemoveNode(USpellNode* Node);
+
     UFUNCTION(BlueprintCallable, Category = "Grimoire Editor")
     void ConnectNodes(USpellNode* Source, USpellNode* Target);
 
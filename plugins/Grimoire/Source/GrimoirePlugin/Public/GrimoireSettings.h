@@ -0,0 +1,134 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/DataTable.h"
+#include "GrimoireTypes.h"
+#include "Spells/EffectNode.h"
+#include "GrimoireSettings.generated.h"
+
+class USpellNode;
+class UNiagaraSystem;
+
+/** What happens to a cast's mana when it runs out of fuel */
+UENUM(BlueprintType)
+enum class EGrimoireFuelPolicy : uint8
+{
+    RefundMana  UMETA(DisplayName = "Refund Mana"),
+    ChargeMana  UMETA(DisplayName = "Charge Mana")
+};
+
+/** Most work one activation of a spell may do, see FSpellCostAnalyzer */
+USTRUCT(BlueprintType)
+struct FSpellCostBudget
+{
+    GENERATED_BODY()
+
+    FSpellCostBudget() = default;
+    FSpellCostBudget(int32 InMaxNodeExecutions, int32 InMaxForks, int32 InMaxSideEffects)
+        : MaxNodeExecutions(InMaxNodeExecutions), MaxForks(InMaxForks), MaxSideEffects(InMaxSideEffects)
+    {
+    }
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Budget", meta = (ClampMin = "1"))
+    int32 MaxNodeExecutions = 256;
+
+    // Parallel branches and quantum condition branches, each of which creates a child context
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Budget", meta = (ClampMin = "0"))
+    int32 MaxForks = 8;
+
+    // Nodes that act on the world, such as spawning projectiles or applying damage
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Budget", meta = (ClampMin = "0"))
+    int32 MaxSideEffects = 32;
+};
+
+/** Project-wide Grimoire settings, stored in DefaultGrimoirePlugin.ini */
+UCLASS(config = GrimoirePlugin, defaultconfig, meta = (DisplayName = "Grimoire"))
+class GRIMOIREPLUGIN_API UGrimoireSettings : public UDeveloperSettings
+{
+    GENERATED_BODY()
+
+public:
+    UGrimoireSettings();
+
+    /** Budget for a spell whose rarest node has the given rarity. Spells over budget are not compiled. */
+    UPROPERTY(config, EditAnywhere, Category = "Spell Cost")
+    TMap<EItemRarity, FSpellCostBudget> CostBudgets;
+
+    /** Fuel one cast may burn, by the spell's rarest node. Tiers at 0 are not metered. */
+    UPROPERTY(config, EditAnywhere, Category = "Fuel")
+    TMap<EItemRarity, int32> FuelBudgets;
+
+    /** Scales the fuel budget for casters of a class or its subclasses. The most derived match wins. */
+    UPROPERTY(config, EditAnywhere, Category = "Fuel")
+    TMap<TSoftClassPtr<AActor>, float> CasterFuelMultipliers;
+
+    /** Fuel burned each time a node of each type runs */
+    UPROPERTY(config, EditAnywhere, Category = "Fuel", meta = (ArraySizeEnum = "ESpellNodeType", ClampMin = "0"))
+    int32 NodeFuelCosts[(uint8)ESpellNodeType::MAX];
+
+    /** Fuel burned by node classes from outside this plugin, such as modded nodes, instead of their type's cost */
+    UPROPERTY(config, EditAnywhere, Category = "Fuel", meta = (ClampMin = "0"))
+    int32 ExternalNodeFuelCost = 8;
+
+    /** Applies to casts that run dry at any point, including yielded and delayed runs. Settled when the cast finishes. */
+    UPROPERTY(config, EditAnywhere, Category = "Fuel")
+    EGrimoireFuelPolicy OutOfFuelPolicy = EGrimoireFuelPolicy::RefundMana;
+
+    /** Milliseconds per frame spell interpreters may run before yielding to the next frame. 0 disables slicing. */
+    UPROPERTY(config, EditAnywhere, Category = "Execution", meta = (ClampMin = "0.0", Units = "ms"))
+    float SpellFrameBudgetMs = 4.0f;
+
+    /** Casters this close to a player's view point run ahead of other background spells */
+    UPROPERTY(config, EditAnywhere, Category = "Execution", meta = (ClampMin = "0.0", Units = "cm"))
+    float NearCameraDistance = 3000.0f;
+
+    /** Spells at least this rare run Parallel branches that only read the world on worker threads */
+    UPROPERTY(config, EditAnywhere, Category = "Execution")
+    EItemRarity MinConcurrentRarity = EItemRarity::Epic;
+
+    /** Projectiles of each class to spawn, deactivated, when a map begins play */
+    UPROPERTY(config, EditAnywhere, Category = "Projectiles")
+    TMap<TSoftClassPtr<AActor>, int32> ProjectilePoolPrewarm;
+
+    /** Released projectiles beyond this many idle ones of a class are destroyed instead of pooled */
+    UPROPERTY(config, EditAnywhere, Category = "Projectiles", meta = (ClampMin = "0"))
+    int32 MaxIdleProjectilesPerClass = 256;
+
+    /** Collision radius of projectiles simulated without an actor, see UGrimoireProjectileSubsystem */
+    UPROPERTY(config, EditAnywhere, Category = "Projectiles", meta = (ClampMin = "0.0", Units = "cm"))
+    float ProjectileRadius = 10.0f;
+
+    /** Channel simulated projectiles sweep on */
+    UPROPERTY(config, EditAnywhere, Category = "Projectiles")
+    TEnumAsByte<ECollisionChannel> ProjectileCollisionChannel = ECC_WorldDynamic;
+
+    /** Cosmetic spell effects spawned per frame at most; lower priority requests beyond this are dropped */
+    UPROPERTY(config, EditAnywhere, Category = "Effects", meta = (ClampMin = "0"))
+    int32 MaxEffectsPerFrame = 16;
+
+    /** Requests for the same effect within a cell this wide in one frame spawn once */
+    UPROPERTY(config, EditAnywhere, Category = "Effects", meta = (ClampMin = "1.0", Units = "cm"))
+    float EffectMergeDistance = 200.0f;
+
+    /** Spawned where spells react with a sustained effect. Unset, nothing is spawned. */
+    UPROPERTY(config, EditAnywhere, Category = "Effects")
+    TSoftObjectPtr<UNiagaraSystem> ElementalCollisionEffect;
+
+    /** Damage each second a target takes from a status, for the statuses that deal any */
+    UPROPERTY(config, EditAnywhere, Category = "Status Effects")
+    TMap<EStatusEffectType, float> StatusDamagePerSecond;
+
+    /** Seconds between damage-over-time batches */
+    UPROPERTY(config, EditAnywhere, Category = "Status Effects", meta = (ClampMin = "0.0", Units = "s"))
+    float StatusDamageInterval = 0.5f;
+
+    /** FElementInteractionRow table describing how colliding spells react, compiled when the engine starts. Unset, no elements interact. */
+    UPROPERTY(config, EditAnywhere, Category = "Elements", meta = (RequiredAssetDataTags = "RowStructure=/Script/GrimoirePlugin.ElementInteractionRow"))
+    TSoftObjectPtr<UDataTable> ElementInteractionTable;
+
+    const FSpellCostBudget& GetCostBudget(EItemRarity Rarity) const;
+    int32 GetFuelBudget(EItemRarity Rarity, AActor* Caster) const;
+    int32 GetFuelCost(const USpellNode* Node) const;
+};
@@ -5,6 +5,7 @@
 #include "Engine/DataAsset.h"
 #include "Engine/DataTable.h"
 #include "InputAction.h"
+#include "GameFramework/Actor.h"
 #include "GrimoireTypes.generated.h"
 
 UENUM(BlueprintType)
@@ -54,6 +55,17 @@ enum class ETriggerType : uint8
     MAX           UMETA(Hidden)
 };
 
+// Event that starts a trigger node. Spell entry points are grouped by it.
+UENUM(BlueprintType)
+enum class ETriggerEventType : uint8
+{
+    OnCast,
+    OnHit,
+    OnEnemyEnter,
+    OnTimer,
+    MAX UMETA(Hidden)
+};
+
 UENUM(BlueprintType)
 enum class EGWTAbilityInputID : uint8
 {
@@ -66,6 +78,56 @@ enum class EGWTAbilityInputID : uint8
     MAX UMETA(Hidden)
 };
 
+UENUM(BlueprintType)
+enum class EGWTVariableType : uint8
+{
+    None,
+    Float,
+    Int,
+    Bool,
+    String,
+    Vector,
+    Object,
+    MAX UMETA(Hidden)
+};
+
+/** Blueprint-facing spell variable value. The runtime stores variables as FSpellValue. */
+USTRUCT(BlueprintType)
+struct FGWTVariableValue
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    EGWTVariableType Type = EGWTVariableType::None;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    float FloatValue = 0.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    int32 IntValue = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    bool BoolValue = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    FString StringValue;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    FVector VectorValue = FVector::ZeroVector;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Variable")
+    TWeakObjectPtr<UObject> ObjectValue;
+
+    bool IsSet() const { return Type != EGWTVariableType::None; }
+
+    static FGWTVariableValue FromFloat(float In) { FGWTVariableValue V; V.Type = EGWTVariableType::Float; V.FloatValue = In; return V; }
+    static FGWTVariableValue FromInt(int32 In) { FGWTVariableValue V; V.Type = EGWTVariableType::Int; V.IntValue = In; return V; }
+    static FGWTVariableValue FromBool(bool In) { FGWTVariableValue V; V.Type = EGWTVariableType::Bool; V.BoolValue = In; return V; }
+    static FGWTVariableValue FromString(const FString& In) { FGWTVariableValue V; V.Type = EGWTVariableType::String; V.StringValue = In; return V; }
+    static FGWTVariableValue FromVector(const FVector& In) { FGWTVariableValue V; V.Type = EGWTVariableType::Vector; V.VectorValue = In; return V; }
+    static FGWTVariableValue FromActor(AActor* In) { FGWTVariableValue V; V.Type = EGWTVariableType::Object; V.ObjectValue = In; return V; }
+};
+
 USTRUCT(BlueprintType)
 struct FNodeDefinition : public FTableRowBase  // For modding: DataTable of node templates
 {
@@ -118,6 +180,10 @@ struct FElementInteraction
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
     bool bCreatesSustainedEffect = false;
+
+    // Projectiles of these elements destroy each other when they meet
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+    bool bCancelsProjectiles = false;
 };
 
 USTRUCT(BlueprintType)
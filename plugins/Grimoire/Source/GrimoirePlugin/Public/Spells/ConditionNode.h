@@ -2,16 +2,34 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "SpellNode.h"
+#include "Spells/SpellNode.h"
+#include "Spells/EffectNode.h"
 #include "ConditionNode.generated.h"
 
 UENUM(BlueprintType)
 enum class EConditionType : uint8
 {
-    IfThen,
-    Threshold,
-    Random,
-    MAX UMETA(Hidden)
+    IfThen          UMETA(DisplayName = "If Then"),
+    IfThenElse      UMETA(DisplayName = "If Then Else"),
+    Compare         UMETA(DisplayName = "Compare"),
+    HealthCheck     UMETA(DisplayName = "Health Check"),
+    DistanceCheck   UMETA(DisplayName = "Distance Check"),
+    RandomChance    UMETA(DisplayName = "Random Chance"),
+    HasStatus       UMETA(DisplayName = "Has Status"),
+    TimeBased       UMETA(DisplayName = "Time Based"),
+    MAX             UMETA(Hidden)
+};
+
+UENUM(BlueprintType)
+enum class EComparisonOperator : uint8
+{
+    Equal           UMETA(DisplayName = "=="),
+    NotEqual        UMETA(DisplayName = "!="),
+    Greater         UMETA(DisplayName = ">"),
+    GreaterEqual    UMETA(DisplayName = ">="),
+    Less            UMETA(DisplayName = "<"),
+    LessEqual       UMETA(DisplayName = "<="),
+    MAX             UMETA(Hidden)
 };
 
 UCLASS(Blueprintable, meta = (DisplayName = "Condition Node"))
@@ -20,15 +38,78 @@ class GRIMOIREPLUGIN_API UConditionNode : public USpellNode
     GENERATED_BODY()
 
 public:
+    UConditionNode();
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition")
     EConditionType ConditionType = EConditionType::IfThen;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition")
-    float Threshold = 0.5f; // For Threshold/Random
+    EComparisonOperator ComparisonOperator = EComparisonOperator::Greater;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition")
+    float ComparisonValue = 0.5f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float RandomChance = 0.5f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition")
+    FName VariableName = TEXT("Health");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition")
+    EStatusEffectType StatusType = EStatusEffectType::Burning; // If ConditionType = HasStatus
 
-    virtual void Execute(UObject* Context) override;
+    // Execution
+    virtual void OnExecute(USpellExecutionContext* Context) override;
     virtual float GetBasePower() const override;
 
+    // Pin system override for condition-specific pins
+    virtual TArray<FHeartGraphPinDesc> GetInputPinDescs() const override;
+    virtual TArray<FHeartGraphPinDesc> GetOutputPinDescs() const override;
+
 protected:
-    bool EvaluateCondition(UObject* Context);
-};
\ No newline at end of file
+    // Evaluates the condition, publishes the result to the context and applies non-branching rarity effects
+    bool EvaluateBranch(USpellExecutionContext* Context);
+
+    // Legendary conditions also run the false branch on a weakened child context
+    bool RunsBothBranches(bool bConditionResult) const { return NodeRarity == EItemRarity::Legendary && bConditionResult; }
+    bool HasElseBranch() const { return ConditionType == EConditionType::IfThenElse; }
+
+    // Condition evaluation
+    bool EvaluateCondition(USpellExecutionContext* Context);
+    bool EvaluateIfThen(USpellExecutionContext* Context);
+    bool EvaluateComparison(USpellExecutionContext* Context);
+    bool EvaluateHealthCheck(USpellExecutionContext* Context);
+    bool EvaluateDistanceCheck(USpellExecutionContext* Context);
+    bool EvaluateRandomChance(USpellExecutionContext* Context);
+    bool EvaluateHasStatus(USpellExecutionContext* Context);
+    bool EvaluateTimeBased(USpellExecutionContext* Context);
+
+    // Chance of EvaluateRandomChance succeeding after rarity bonuses
+    float GetAdjustedChance() const;
+
+    // True if the condition has the same result on every cast, given the registers some node in the spell may write
+    bool GetConstantResult(const TBitArray<>& WrittenSlots, bool& bOutResult) const;
+
+    // Helpers
+    float GetVariableValue(USpellExecutionContext* Context, int32 Slot);
+    static bool CompareValues(float A, float B, EComparisonOperator Operator);
+
+    // Branch execution
+    void ExecuteTrueBranch(USpellExecutionContext* Context);
+    void ExecuteFalseBranch(USpellExecutionContext* Context);
+
+    // Rarity effects
+    void ApplyRarityEffects(USpellExecutionContext* Context, bool bConditionResult);
+
+    virtual void ResolveRegisters(FSpellRegisterLayout& Layout) override;
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const override;
+    virtual bool IsTaskSafe() const override;
+
+private:
+    friend class FSpellInterpreter;
+    friend class FSpellOptimizer;
+    friend class FSpellCostAnalyzer;
+
+    // Register slot of VariableName in the owning graph's layout
+    int32 VariableSlot = FSpellRegisterLayout::InvalidSlot;
+};
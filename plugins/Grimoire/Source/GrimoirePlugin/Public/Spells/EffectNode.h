@@ -5,6 +5,8 @@
 #include "SpellNode.h"
 #include "EffectNode.generated.h"
 
+class ACharacter;
+
 UENUM(BlueprintType)
 enum class EEffectType : uint8
 {
@@ -44,13 +46,17 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect")
     float StatusDuration = 5.0f;
 
-    virtual void Execute(UObject* Context) override;
+    virtual void OnExecute(USpellExecutionContext* Context) override;
     virtual float GetBasePower() const override;
 
 protected:
-    void ApplyDamage(UObject* Context, float DamageAmount);
-    void ApplyTeleport(UObject* Context);
-    void ApplyKnockback(UObject* Context);
-    void ApplyHeal(UObject* Context, float HealAmount);
-    void ApplyStatusEffect(UObject* Context);
+    // Record the effect on the cast's command buffer; the world changes when the buffer is applied
+    void ApplyDamage(USpellExecutionContext* Context, ACharacter* Target, float DamageAmount);
+    void ApplyTeleport(USpellExecutionContext* Context, ACharacter* Target);
+    void ApplyKnockback(USpellExecutionContext* Context, ACharacter* Target);
+    void ApplyHeal(USpellExecutionContext* Context, ACharacter* Target, float HealAmount);
+    void ApplyStatusEffect(USpellExecutionContext* Context, ACharacter* Target);
+
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const override;
+    virtual bool IsTaskSafe() const override { return true; }
 };
\ No newline at end of file
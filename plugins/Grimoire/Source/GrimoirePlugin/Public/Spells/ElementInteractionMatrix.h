@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrimoireTypes.h"
+
+class UDataTable;
+
+/**
+ * Every ESpellElement pair's interaction, compiled once from the element interaction
+ * table into a dense array so a lookup is a single indexed load.
+ * Compiled matrices are immutable. A rebuild publishes a whole new matrix, so readers
+ * see either the old table or the new one, never a mix.
+ */
+class GRIMOIREPLUGIN_API FElementInteractionMatrix
+{
+public:
+    static constexpr int32 NumElements = static_cast<int32>(ESpellElement::MAX);
+
+    /** The hot part of an FElementInteraction */
+    struct FEntry
+    {
+        float DamageMultiplier = 1.0f;
+        float Duration = 0.0f;
+
+        // Whether any value differs from no interaction at all
+        bool bReacts = false;
+        bool bCreatesSustainedEffect = false;
+        bool bCancelsProjectiles = false;
+    };
+
+    /**
+     * Compiles Table, whose rows must list every element pair exactly once, symmetrically, as FElementInteractionRow.
+     * Problems are appended to OutErrors, and any problem returns null rather than a partial matrix.
+     */
+    static TSharedPtr<const FElementInteractionMatrix> Compile(const UDataTable* Table, TArray<FString>& OutErrors);
+
+    /** Matrix in use. Game thread only; it is replaced when the table is rebuilt. */
+    static const FElementInteractionMatrix& Get() { return *Current; }
+    static TSharedRef<const FElementInteractionMatrix> GetShared() { return Current; }
+    static void Publish(const TSharedRef<const FElementInteractionMatrix>& Matrix);
+
+    const FEntry& Find(ESpellElement Source, ESpellElement Target) const
+    {
+        return Entries[static_cast<uint8>(Source) * NumElements + static_cast<uint8>(Target)];
+    }
+
+    /** Full interaction, including its description. Elements out of range have no interaction. */
+    FElementInteraction GetInteraction(ESpellElement Source, ESpellElement Target) const;
+
+private:
+    static TSharedRef<const FElementInteractionMatrix> Current;
+
+    FEntry Entries[NumElements * NumElements];
+
+    // Cold, only read when an interaction is reported
+    FText Descriptions[NumElements * NumElements];
+};
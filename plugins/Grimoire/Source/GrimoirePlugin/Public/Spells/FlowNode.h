@@ -2,7 +2,6 @@
 
 #include "CoreMinimal.h"
 #include "Spells/SpellNode.h"
-#include "Engine/TimerHandle.h"
 #include "FlowNode.generated.h"
 
 UENUM(BlueprintType)
@@ -104,46 +103,43 @@ protected:
     bool ShouldContinueLoop(USpellExecutionContext* Context);
     void UpdateLoopState(USpellExecutionContext* Context);
 
-    // Timer callbacks
-    UFUNCTION()
-    void HandleDelayComplete();
+    // Iteration cap for Loop/WhileLoop/ForLoop after input overrides and rarity scaling
+    int32 ResolveIterationLimit(USpellExecutionContext* Context) const;
+    int32 GetIterationLimit(int32 RequestedCount) const;
+    int32 GetMaxIterationsByRarity() const;
 
-    UFUNCTION()
-    void HandleIterationTimer();
+    // Wait times after input overrides and rarity scaling
+    float ResolveDelayTime(USpellExecutionContext* Context) const;
+    float ResolveIterationDelay() const;
+
+    // Scheduler continuation for ExecuteDelay
+    void HandleDelayComplete(TWeakObjectPtr<USpellExecutionContext> WeakContext);
 
     // Utility functions
-    TArray<USpellNode*> GetLoopBodyNodes() const;
-    TArray<USpellNode*> GetParallelNodes() const;
+    TConstArrayView<USpellNode*> GetLoopBodyNodes() const;
+    TConstArrayView<USpellNode*> GetParallelNodes() const;
+    TConstArrayView<USpellNode*> GetConnectedOutputNodes() const;
     bool EvaluateBreakCondition(USpellExecutionContext* Context);
 
     // Rarity effects
     void ApplyRarityEffects(USpellExecutionContext* Context);
 
-    // Recursion protection
-    bool CheckRecursionLimit(USpellExecutionContext* Context);
+    virtual void ResolveRegisters(FSpellRegisterLayout& Layout) override;
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const override;
+    virtual bool IsTaskSafe() const override;
 
 private:
-    // Flow state
-    UPROPERTY()
-    FLoopState CurrentLoopState;
-
-    UPROPERTY()
-    USpellExecutionContext* CachedContext;
+    // The compiled spell interpreter runs flow control itself and only calls into the helpers above
+    friend class FSpellInterpreter;
 
-    // Timer handles
-    UPROPERTY()
-    FTimerHandle DelayTimerHandle;
-
-    UPROPERTY()
-    FTimerHandle IterationTimerHandle;
+    // Read the same helpers to prove and bound loop limits at compile time
+    friend class FSpellOptimizer;
+    friend class FSpellCostAnalyzer;
 
-    // Recursion tracking
-    int32 RecursionDepth = 0;
-    static const int32 MaxRecursionDepth = 50;
+    // Register slot of BreakConditionVariable in the owning graph's layout
+    int32 BreakConditionSlot = FSpellRegisterLayout::InvalidSlot;
 
-    // Parallel execution tracking
+    // Flow state
     UPROPERTY()
-    TArray<USpellNode*> ActiveParallelNodes;
-
-    int32 CompletedParallelNodes = 0;
+    FLoopState CurrentLoopState;
 };
\ No newline at end of file
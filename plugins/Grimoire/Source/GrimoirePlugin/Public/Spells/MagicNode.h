@@ -5,6 +5,8 @@
 #include "GrimoireTypes.h"
 #include "MagicNode.generated.h"
 
+class UHeartGraphPin;
+
 UCLASS(Blueprintable, meta = (DisplayName = "Magic Node"))
 class GRIMOIREPLUGIN_API UMagicNode : public USpellNode
 {
@@ -23,6 +25,13 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Magic", meta = (ClampMin = "0.0"))
     float Range = 500.0f;
 
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Magic", meta = (ClampMin = "0.0"))
+    float ProjectileSpeed = 2000.0f;
+
+    // Actor to fire, taken from the projectile pool. Unset projectiles are simulated without an actor.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Magic")
+    TSubclassOf<AActor> ProjectileClass;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Magic")
     float ManaCost = 20.0f;
     
@@ -33,12 +42,16 @@ public:
     float CastTime = 1.0f;
 
     // Execution
-    virtual void OnExecute(UGrimoireComponent* Grimoire, AActor* ContextActor) override;
+    virtual void OnExecute(USpellExecutionContext* Context) override;
     virtual float GetBasePower() const override;
 
     virtual TArray<FHeartGraphPinDesc> GetInputPinDescs() const override;
     virtual TArray<FHeartGraphPinDesc> GetOutputPinDescs() const override;
 
+    // Element interactions between colliding spells
+    void OnPinCollision(UHeartGraphPin* OtherPin, UObject* Context);
+    static FElementInteraction GetElementInteraction(ESpellElement Source, ESpellElement Target);
+
 protected:
     // Magic-specific functionality
     void ApplyDamage(USpellExecutionContext* Context, float DamageAmount);
@@ -51,4 +64,9 @@ protected:
     
     // Rarity-based enhancements
     void ApplyRarityEffects(USpellExecutionContext* Context);
+
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const override;
+
+    // Projectiles are recorded on the cast's command buffer, not spawned inline
+    virtual bool IsTaskSafe() const override { return true; }
 };
\ No newline at end of file
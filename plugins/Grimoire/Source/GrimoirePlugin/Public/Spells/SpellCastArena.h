@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spells/SpellCommandBuffer.h"
+
+class USpellExecutionContext;
+class UGrimoireContextSubsystem;
+
+/**
+ * Linear allocator for the data of one spell cast.
+ * Allocation bumps a pointer; everything is released at once by Reset, which
+ * keeps the blocks for the next cast. Only trivially destructible types may
+ * live here since destructors are never run.
+ */
+class GRIMOIREPLUGIN_API FSpellCastArena
+{
+public:
+    static constexpr SIZE_T DefaultBlockSize = 4 * 1024;
+
+    explicit FSpellCastArena(SIZE_T InBlockSize = DefaultBlockSize)
+        : BlockSize(InBlockSize)
+    {
+    }
+
+    ~FSpellCastArena();
+
+    FSpellCastArena(const FSpellCastArena&) = delete;
+    FSpellCastArena& operator=(const FSpellCastArena&) = delete;
+
+    void* Allocate(SIZE_T Size, SIZE_T Alignment);
+
+    /** Allocates Num default constructed elements */
+    template <typename T>
+    TArrayView<T> AllocateArray(int32 Num)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena memory is released without running destructors");
+
+        if (Num <= 0)
+        {
+            return TArrayView<T>();
+        }
+
+        T* Data = static_cast<T*>(Allocate(sizeof(T) * Num, alignof(T)));
+        for (int32 Index = 0; Index < Num; ++Index)
+        {
+            new (Data + Index) T();
+        }
+        return TArrayView<T>(Data, Num);
+    }
+
+    /** Releases every allocation. O(1), blocks are kept. */
+    void Reset()
+    {
+        CurrentBlock = INDEX_NONE;
+        Cursor = nullptr;
+        End = nullptr;
+        BytesUsed = 0;
+    }
+
+    SIZE_T GetBytesUsed() const { return BytesUsed; }
+
+private:
+    struct FBlock
+    {
+        uint8* Data = nullptr;
+        SIZE_T Size = 0;
+    };
+
+    TArray<FBlock> Blocks;
+    int32 CurrentBlock = INDEX_NONE;
+    uint8* Cursor = nullptr;
+    uint8* End = nullptr;
+    SIZE_T BlockSize;
+    SIZE_T BytesUsed = 0;
+};
+
+/** Bookkeeping for one cast: its arena, the pooled contexts handed out for it and its pending world changes */
+struct FSpellCast
+{
+    FSpellCastArena Arena;
+
+    // Null for contexts created outside a pool
+    UGrimoireContextSubsystem* Pool = nullptr;
+
+    // Contexts of this cast, chained through USpellExecutionContext::NextPooled
+    USpellExecutionContext* FirstContext = nullptr;
+    USpellExecutionContext* LastContext = nullptr;
+
+    // The caster's reference plus one per pending timer continuation
+    int32 RefCount = 0;
+
+    // Fuel metering, see USpellExecutionContext::ConsumeFuel. A budget of 0 is unmetered.
+    int32 FuelBudget = 0;
+    int32 FuelUsed = 0;
+
+    // Run once the last reference is released, after every continuation, e.g. to settle mana and fuel stats
+    TFunction<void(const FSpellCast&)> OnFinished;
+
+    bool IsOutOfFuel() const { return FuelBudget > 0 && FuelUsed > FuelBudget; }
+
+    // World changes recorded by the cast's nodes, applied when an interpreter run returns
+    FSpellCommandBuffer Commands;
+
+    FSpellCast* NextFree = nullptr;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "UObject/ObjectKey.h"
+#include "Templates/SubclassOf.h"
+#include "GrimoireTypes.h"
+
+class AActor;
+class UGrimoireComponent;
+enum class EStatusEffectType : uint8;
+
+/** World changes a spell node can ask for */
+enum class ESpellCommandType : uint8
+{
+    Damage,
+    Heal,
+    Launch,
+    Teleport,
+    Spawn,
+    ApplyStatus,
+    Projectile,
+};
+
+/** One deferred world change recorded by a spell node */
+struct FSpellCommand
+{
+    ESpellCommandType Type = ESpellCommandType::Damage;
+
+    // Element for Damage, ESpellElement::MAX if untyped, or Projectile. Status type for ApplyStatus.
+    uint8 Subtype = 0;
+
+    TWeakObjectPtr<AActor> Target;
+    TWeakObjectPtr<AActor> Instigator;
+
+    // Damage or heal amount, spawn life span, status duration or projectile range
+    float Magnitude = 0.0f;
+
+    // Launch velocity, teleport offset, or spawn or projectile location
+    FVector Vector = FVector::ZeroVector;
+    FRotator Rotation = FRotator::ZeroRotator;
+
+    // Spawn only
+    TWeakObjectPtr<UClass> ActorClass;
+
+    // Projectile only. The spell whose OnHit triggers run when it hits.
+    FVector Velocity = FVector::ZeroVector;
+    TWeakObjectPtr<UGrimoireComponent> Grimoire;
+    FName SpellName;
+};
+
+/**
+ * World changes recorded while a spell graph runs, applied together on the game thread.
+ * Nodes record commands instead of touching the world, so evaluation can run anywhere and
+ * the interpreter applies the batch when its run returns. Commands apply in recording order;
+ * a heal, launch, teleport or status on a target that already has one pending is folded into
+ * the pending command instead of being applied twice.
+ */
+class GRIMOIREPLUGIN_API FSpellCommandBuffer
+{
+public:
+    void Damage(AActor* Target, float Amount, AActor* Instigator, ESpellElement Element = ESpellElement::MAX);
+    void Heal(AActor* Target, float Amount, AActor* Instigator);
+    void Launch(AActor* Target, const FVector& Velocity, AActor* Instigator);
+    void Teleport(AActor* Target, const FVector& Offset, AActor* Instigator);
+    void Spawn(TSubclassOf<AActor> ActorClass, const FVector& Location, const FRotator& Rotation, float LifeSpan, AActor* Instigator);
+    void ApplyStatus(AActor* Target, EStatusEffectType Status, float Duration, AActor* Instigator);
+    void Projectile(const FVector& Location, const FVector& Velocity, ESpellElement Element, float Range, AActor* Instigator, UGrimoireComponent* Grimoire, FName SpellName);
+
+    void Add(const FSpellCommand& Command);
+
+    /** Records Other's commands after this buffer's, in order, and empties Other */
+    void Append(FSpellCommandBuffer& Other);
+
+    /** Applies and clears every command. Game thread only. */
+    void Apply();
+
+    void Reset();
+
+    int32 Num() const { return Commands.Num(); }
+    bool IsEmpty() const { return Commands.Num() == 0; }
+
+private:
+    static void ApplyCommand(const FSpellCommand& Command);
+
+    TArray<FSpellCommand> Commands;
+
+    // Pending command per target for the command types that fold
+    TMap<TTuple<FObjectKey, ESpellCommandType, uint8>, int32> FoldTargets;
+
+    // Commands recorded while applying, e.g. by a damage handler casting a spell, join the running batch
+    bool bApplying = false;
+};
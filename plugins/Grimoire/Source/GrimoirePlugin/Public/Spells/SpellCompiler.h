@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spells/SpellGraphIndex.h"
+
+class UHeartGraph;
+class USpellNode;
+
+/** What the interpreter does when it reaches an instruction */
+enum class ESpellOpCode : uint8
+{
+    Action,     // Magic, Trigger, Effect, Variable and custom nodes: run the node, then Exits[0]
+    Sequence,   // Exits[0] in order, with SequenceIndex/SequenceTotal
+    Loop,       // Exits[0] = LoopBody, Exits[1] = OnComplete
+    WhileLoop,  // Exits[0] = LoopBody
+    ForLoop,    // Exits[0] = LoopBody
+    Delay,      // Suspends for the node's delay, then Exits[0]
+    Parallel,   // Exits[0] = Branch1..3, Exits[1] = OnAllComplete
+    Branch,     // Exits[0] = True, Exits[1] = False
+    Gate,       // Exits[0] = Open, Exits[1] = Closed
+    Condition,  // Exits[0] = True, Exits[1] = False
+    Trigger,    // Timer trigger: runs the node and Exits[0], then again after every interval
+    Unrolled,   // Optimized Flow loop: Exits[0] = the body once per iteration, Exits[1] = OnComplete
+    MAX
+};
+
+/** A contiguous run of instruction indices in FCompiledSpell::Successors */
+struct FSpellExitRange
+{
+    uint16 Start = 0;
+    uint16 Num = 0;
+};
+
+/** Facts the optimizer proved about an instruction, so the interpreter can skip work */
+enum class ESpellInstructionFlags : uint8
+{
+    None = 0,
+
+    // Nothing reads the loop's index and total registers, so they are not written
+    NoLoopRegisters = 1 << 0,
+
+    // Nothing writes the loop's break, while or continue registers, so only the limit ends it
+    NoLoopChecks = 1 << 1,
+
+    // Every branch of the Parallel only reads the world and writes its own scope, so the branches may run on worker threads
+    ConcurrentBranches = 1 << 2,
+};
+ENUM_CLASS_FLAGS(ESpellInstructionFlags);
+
+struct FSpellInstruction
+{
+    ESpellOpCode OpCode = ESpellOpCode::Action;
+    ESpellInstructionFlags Flags = ESpellInstructionFlags::None;
+
+    // Index into FCompiledSpell::Nodes
+    uint16 NodeIndex = 0;
+
+    // Meaning depends on OpCode, see ESpellOpCode
+    FSpellExitRange Exits[2];
+};
+
+/**
+ * A spell graph lowered into a flat instruction array.
+ * Instructions are laid out in depth-first order from the entry point so that
+ * a cast walks memory mostly forwards.
+ */
+struct GRIMOIREPLUGIN_API FCompiledSpell
+{
+    TArray<FSpellInstruction> Instructions;
+
+    // Successor instruction indices referenced by FSpellExitRange
+    TArray<uint16> Successors;
+
+    // Node backing each instruction. Owned by the spell graph.
+    TArray<USpellNode*> Nodes;
+
+    // First OnCast entry instruction
+    uint16 EntryPoint = 0;
+
+    // Entry instructions of kind K are [EntryOffsets[K], EntryOffsets[K + 1])
+    TArray<uint16> EntryPoints;
+    int32 EntryOffsets[FSpellGraphIndex::EntryKindCount + 1] = {};
+
+    // Hard cap on interpreter frames for one cast
+    static constexpr uint16 DepthLimit = 256;
+
+    // Deepest frame stack a cast can need. DepthLimit when the graph has a cycle, which would nest forever.
+    uint16 MaxDepth = DepthLimit;
+
+    // Rarest node in the program, which picks the spell's cost and fuel budget tiers
+    EItemRarity Rarity = EItemRarity::Common;
+
+    // Graph index this program was built from. The program is stale once the graph is edited.
+    TSharedPtr<const FSpellGraphIndex> SourceIndex;
+
+    bool IsEmpty() const { return Instructions.Num() == 0; }
+
+    /** Longest chain of frames from any entry point, or DepthLimit if the program has a cycle */
+    uint16 ComputeMaxDepth() const;
+    bool IsStale() const { return !SourceIndex.IsValid() || SourceIndex->IsStale(); }
+
+    /** Instructions a cast or event of the given kind starts from */
+    TConstArrayView<uint16> GetEntryPoints(ETriggerEventType Kind) const
+    {
+        const int32 KindIndex = static_cast<int32>(Kind);
+        return TConstArrayView<uint16>(EntryPoints.GetData() + EntryOffsets[KindIndex], EntryOffsets[KindIndex + 1] - EntryOffsets[KindIndex]);
+    }
+
+    TConstArrayView<uint16> GetExit(const FSpellInstruction& Instruction, int32 ExitIndex) const
+    {
+        const FSpellExitRange& Range = Instruction.Exits[ExitIndex];
+        return TConstArrayView<uint16>(Successors.GetData() + Range.Start, Range.Num);
+    }
+};
+
+/** Lowers a HeartGraph spell into an FCompiledSpell */
+class GRIMOIREPLUGIN_API FSpellCompiler
+{
+public:
+    /** Compiles every node reachable from EntryNode. Returns null if the graph cannot be compiled. */
+    static TSharedPtr<FCompiledSpell> Compile(UHeartGraph* Graph, USpellNode* EntryNode);
+
+    /** Compiles every entry point of Graph into one program, keeping them grouped by trigger kind */
+    static TSharedPtr<FCompiledSpell> Compile(UHeartGraph* Graph);
+
+private:
+    FSpellCompiler(const FSpellGraphIndex& InIndex, FCompiledSpell& InProgram);
+
+    // EntryNodes of kind K are [EntryNodeOffsets[K], EntryNodeOffsets[K + 1])
+    static TSharedPtr<FCompiledSpell> Compile(const UHeartGraph* Graph, const TSharedRef<const FSpellGraphIndex>& SharedIndex,
+        TConstArrayView<uint16> EntryNodes, const int32* EntryNodeOffsets);
+
+    uint16 EmitNode(uint16 NodeIndex);
+    void LinkExits(uint16 InstructionIndex);
+    FSpellExitRange EmitExit(TConstArrayView<ESpellPin> Pins, uint16 NodeIndex);
+
+    const FSpellGraphIndex& GraphIndex;
+    FCompiledSpell& Program;
+
+    // Instruction emitted for each dense graph node index
+    TArray<uint16> NodeToInstruction;
+    TArray<uint16> InstructionToNode;
+    bool bOverflow = false;
+};
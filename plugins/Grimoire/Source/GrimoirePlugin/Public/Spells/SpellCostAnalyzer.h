@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrimoireTypes.h"
+#include "Spells/SpellCompiler.h"
+
+/** Upper bound on the work one activation of a compiled spell can do */
+struct FSpellCost
+{
+    // Counts saturate here, and a spell with a cycle is Unbounded in every count
+    static constexpr int64 Unbounded = MAX_int64;
+
+    int64 NodeExecutions = 0;
+
+    // Child contexts created by Parallel branches and quantum conditions
+    int64 Forks = 0;
+
+    // Executions of nodes that act on the world
+    int64 SideEffects = 0;
+
+    // Rarest node in the spell, which picks the budget tier
+    EItemRarity Rarity = EItemRarity::Common;
+
+    bool bHasCycle = false;
+};
+
+/**
+ * Bounds what a compiled spell can cost without running it, so expensive spells are turned
+ * away before they reach a server frame. Both exits of every branching node count as taken,
+ * loops run their rarity cap unless nothing can override their count, and timer triggers
+ * fire their MaxFirings.
+ */
+class GRIMOIREPLUGIN_API FSpellCostAnalyzer
+{
+public:
+    static FSpellCost Analyze(const FCompiledSpell& Spell);
+
+    /** Compares Cost with its tier in UGrimoireSettings. Returns false and describes the overrun if it is over. */
+    static bool IsWithinBudget(const FSpellCost& Cost, FString& OutReason);
+
+private:
+    static int64 GetIterationBound(const USpellNode* Node, bool bCountCanChange);
+    static int64 GetFiringBound(const USpellNode* Node);
+    static int64 GetForks(const FSpellInstruction& Instruction, const USpellNode* Node);
+};
@@ -1,78 +1,246 @@
-﻿#pragma once
+#pragma once
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "GameFramework/Actor.h"
+#include "Engine/HitResult.h"
+#include "GrimoireTypes.h"
+#include "Spells/SpellRegisters.h"
+#include "Spells/SpellValue.h"
+#include "Spells/SpellCastArena.h"
 #include "SpellExecutionContext.generated.h"
 
-/** Lightweight variable container for nodes */
-UENUM(BlueprintType)
-enum class ESpellVariableType : uint8
-{
-    None,
-    Float,
-    Int,
-    Bool,
-    Vector,
-    Actor
-};
-
-USTRUCT(BlueprintType)
-struct FSpellVariableValue
+class UGrimoireComponent;
+class UGrimoireContextSubsystem;
+
+/**
+ * State shared by the nodes of one spell cast.
+ * Variables live in flat register files laid out by the spell graph's
+ * FSpellRegisterLayout. Runtime code addresses them by slot; the name-based
+ * functions are the Blueprint-facing slow path.
+ * Child contexts are scopes over their parent: global reads fall through to
+ * the parent until the child writes a slot, and only written slots are merged
+ * back, so forking is O(1) regardless of how many variables are set.
+ * Contexts handed out by UGrimoireContextSubsystem are pooled and keep their
+ * register files in the cast's arena; they are only valid until ReleaseCast.
+ */
+UCLASS(BlueprintType)
+class GRIMOIREPLUGIN_API USpellExecutionContext : public UObject
 {
     GENERATED_BODY()
 
-    UPROPERTY()
-    ESpellVariableType Type = ESpellVariableType::None;
+public:
+    USpellExecutionContext();
 
-    UPROPERTY()
-    float FloatValue = 0.0f;
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    AActor* Caster = nullptr;
 
-    UPROPERTY()
-    int32 IntValue = 0;
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    AActor* Target = nullptr;
 
-    UPROPERTY()
-    bool BoolValue = false;
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    TWeakObjectPtr<UGrimoireComponent> Grimoire;
 
-    UPROPERTY()
-    FVector VectorValue = FVector::ZeroVector;
+    // Spell being cast, so deferred work such as projectiles can run its later triggers
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    FName SpellName;
 
-    UPROPERTY()
-    TWeakObjectPtr<AActor> ActorValue = nullptr;
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    FVector TargetLocation = FVector::ZeroVector;
 
-    static FSpellVariableValue FromFloat(float In) { FSpellVariableValue V; V.Type = ESpellVariableType::Float; V.FloatValue = In; return V; }
-    static FSpellVariableValue FromInt(int32 In) { FSpellVariableValue V; V.Type = ESpellVariableType::Int; V.IntValue = In; return V; }
-    static FSpellVariableValue FromBool(bool In) { FSpellVariableValue V; V.Type = ESpellVariableType::Bool; V.BoolValue = In; return V; }
-    static FSpellVariableValue FromVector(const FVector& In) { FSpellVariableValue V; V.Type = ESpellVariableType::Vector; V.VectorValue = In; return V; }
-    static FSpellVariableValue FromActor(AActor* In) { FSpellVariableValue V; V.Type = ESpellVariableType::Actor; V.ActorValue = In; return V; }
-};
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    FHitResult HitResult;
 
-UCLASS(BlueprintType)
-class GRIMOIREPLUGIN_API USpellExecutionContext : public UObject
-{
-    GENERATED_BODY()
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    float ExecutionTime = 0.0f;
 
-public:
-    USpellExecutionContext();
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    int32 ExecutionDepth = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    float SpellPower = 1.0f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Spell")
+    float ManaCost = 0.0f;
+
+    void Initialize(AActor* InCaster, UGrimoireComponent* InGrimoire);
+    void SetTarget(AActor* InTarget);
+    void SetTargetLocation(const FVector& InLocation);
+
+    UFUNCTION(BlueprintCallable, Category = "Spell")
+    void ModifySpellPower(float Multiplier) { SpellPower *= Multiplier; }
+
+    virtual UWorld* GetWorld() const override;
+
+    // Registers
+
+    /** Switches to InLayout, keeping built-in registers and moving name-only variables into their new slots */
+    void BindRegisterLayout(const TSharedRef<const FSpellRegisterLayout>& InLayout);
+    const FSpellRegisterLayout& GetRegisterLayout() const { return *Layout; }
+
+    /** Reads a register. Local reads fall back to the global register file. Unknown slots read as unset. */
+    const FSpellValue& GetRegister(int32 Slot, bool bGlobal = false) const
+    {
+        if (!bGlobal && LocalRegisters.IsValidIndex(Slot) && LocalRegisters[Slot].IsSet())
+        {
+            return LocalRegisters[Slot];
+        }
+        if (Parent)
+        {
+            return FindScopedGlobal(Slot);
+        }
+        return GlobalRegisters.IsValidIndex(Slot) ? GlobalRegisters[Slot] : EmptyValue;
+    }
+
+    bool HasRegister(int32 Slot, bool bGlobal = false) const { return GetRegister(Slot, bGlobal).IsSet(); }
+
+    void SetRegister(int32 Slot, const FSpellValue& Value, bool bGlobal = false)
+    {
+        TArrayView<FSpellValue>& Registers = bGlobal ? GlobalRegisters : LocalRegisters;
+        if (!Registers.IsValidIndex(Slot))
+        {
+            checkf(Slot >= 0, TEXT("Invalid spell register slot"));
+            GrowRegisters(Registers, Slot + 1);
+        }
+        Registers[Slot] = Value;
+
+        if (bGlobal && Parent)
+        {
+            GlobalWritten[Slot] = true;
+        }
+    }
+
+    const FSpellValue& GetRegister(ESpellRegister Register, bool bGlobal = false) const { return GetRegister(static_cast<int32>(Register), bGlobal); }
+    bool HasRegister(ESpellRegister Register, bool bGlobal = false) const { return HasRegister(static_cast<int32>(Register), bGlobal); }
+    void SetRegister(ESpellRegister Register, const FSpellValue& Value, bool bGlobal = false) { SetRegister(static_cast<int32>(Register), Value, bGlobal); }
+
+    // Name-based access, converting to and from the Blueprint value struct
+
+    UFUNCTION(BlueprintCallable, Category = "Spell|Variables")
+    void SetVariable(FName Name, const FGWTVariableValue& Value, bool bGlobal = false);
+
+    UFUNCTION(BlueprintCallable, Category = "Spell|Variables")
+    FGWTVariableValue GetVariable(FName Name, bool bGlobal = false) const;
 
+    UFUNCTION(BlueprintCallable, Category = "Spell|Variables")
+    bool HasVariable(FName Name, bool bGlobal = false) const;
+
+    UFUNCTION(BlueprintCallable, Category = "Spell|Variables")
+    void ClearVariables(bool bGlobal = false);
+
+    UFUNCTION(BlueprintCallable, Category = "Spell")
+    USpellExecutionContext* CreateChildContext() const;
+
+    /** Applies the global writes of ChildContext to this context */
+    UFUNCTION(BlueprintCallable, Category = "Spell")
+    void MergeChildContext(const USpellExecutionContext* ChildContext);
+
+    /** Creates a child scope that JoinChildContexts will merge back */
+    USpellExecutionContext* ForkChildContext();
+
+    /** Merges every forked child in creation order, so later siblings win conflicting writes */
+    void JoinChildContexts();
+
+    USpellExecutionContext* GetParentContext() const { return Parent; }
+
+    /** Allocates both register files for the whole layout, so writing a laid-out slot never touches the cast's arena */
+    void ReserveRegisters();
+
+    UFUNCTION(BlueprintCallable, Category = "Spell")
+    FString GetDebugString() const;
+
+    // Cast lifetime
+
+    /** Keeps the cast's contexts alive past the synchronous run, e.g. for a pending timer */
+    void RetainCast();
+
+    /** Drops a reference taken by BeginCast or RetainCast. The last release finishes the cast and returns its contexts to the pool. */
+    void ReleaseCast();
+
+    /** Runs Callback when the cast finishes, once it has been released and every yielded or suspended run has ended */
+    void SetOnCastFinished(TFunction<void(const FSpellCast&)>&& Callback);
+
+    /** Whether this context belongs to a pooled cast and can be kept alive with RetainCast */
+    bool IsPooled() const { return Cast && Cast->Pool; }
+
+    // Fuel metering. Every context of a cast draws on the root context's budget.
+
+    void SetFuelBudget(int32 Budget);
+
+    /** Burns Amount fuel. Returns false once the budget is spent, after which the cast should stop. */
+    bool ConsumeFuel(int32 Amount);
+
+    int32 GetFuelUsed() const;
+
+    /** Fuel left before the cast runs dry, or MAX_int32 if it is not metered */
+    int32 GetFuelRemaining() const;
+    bool IsOutOfFuel() const;
+
+    // Deferred world changes
+
+    /** Buffer nodes record world changes into: the nearest override up the scope chain, else the root context's cast's */
+    FSpellCommandBuffer& GetCommandBuffer();
+
+    /** Redirects this scope's commands, e.g. into a private buffer for a branch on a worker thread. Null restores the default. */
+    void SetCommandBuffer(FSpellCommandBuffer* InCommandBuffer) { CommandBuffer = InCommandBuffer; }
+
+private:
+    friend class UGrimoireContextSubsystem;
+
+    static const FSpellValue EmptyValue;
+
+    /** Clears all state so a pooled context can serve InCast */
+    void ResetForCast(FSpellCast* InCast);
+
+    /** Cast this context belongs to. Contexts created outside a pool get their own. */
+    FSpellCast& GetCast();
+    FSpellCastArena& GetArena() { return GetCast().Arena; }
+
+    /** Cast whose fuel this context burns: the root context's, which children outside a pool do not share */
+    FSpellCast& GetMeteredCast();
+    const FSpellCast* FindMeteredCast() const;
+
+    void GrowRegisters(TArrayView<FSpellValue>& Registers, int32 MinNum);
+
+    // Scope chain lookups for child contexts
+    const FSpellValue& FindScopedGlobal(int32 Slot) const;
+    const FSpellValue* FindScopedVariable(FName Name) const;
+    bool IsGlobalWritten(int32 Slot) const;
+
+    // Never null after construction
+    TSharedPtr<const FSpellRegisterLayout> Layout;
+
+    // Arena-backed. Object values are held weakly, so the register files need no GC references
+    TArrayView<FSpellValue> LocalRegisters;
+    TArrayView<FSpellValue> GlobalRegisters;
+
+    // Variables whose names are not in the layout, e.g. set from Blueprint
+    TMap<FName, FSpellValue> LocalVariables;
+    TMap<FName, FSpellValue> GlobalVariables;
+
+    // Enclosing scope. Children own only the globals they wrote; unset entries in GlobalVariables mark removals.
     UPROPERTY()
-    TWeakObjectPtr<AActor> Caster;
+    USpellExecutionContext* Parent = nullptr;
 
+    // Parallel to GlobalRegisters, only maintained for child contexts
+    TArrayView<bool> GlobalWritten;
+
+    // Children awaiting JoinChildContexts, chained in creation order
     UPROPERTY()
-    TWeakObjectPtr<AActor> Target;
+    USpellExecutionContext* FirstForked = nullptr;
 
     UPROPERTY()
-    TMap<FName, FSpellVariableValue> Variables;
+    USpellExecutionContext* LastForked = nullptr;
 
-    UFUNCTION(BlueprintCallable)
-    void SetVariable(FName Key, const FSpellVariableValue& Value);
+    UPROPERTY()
+    USpellExecutionContext* NextForked = nullptr;
 
-    UFUNCTION(BlueprintCallable)
-    bool HasVariable(FName Key) const;
+    FSpellCast* Cast = nullptr;
+    TUniquePtr<FSpellCast> OwnedCast;
 
-    UFUNCTION(BlueprintCallable)
-    FSpellVariableValue GetVariable(FName Key) const;
+    // Not owned, see SetCommandBuffer
+    FSpellCommandBuffer* CommandBuffer = nullptr;
 
-    UFUNCTION(BlueprintCallable)
-    USpellExecutionContext* DuplicateContext() const;
+    // Next context in the owning cast's chain, or in the pool's free list
+    USpellExecutionContext* NextPooled = nullptr;
 };
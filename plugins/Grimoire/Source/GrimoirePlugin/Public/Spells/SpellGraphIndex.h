@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "Spells/SpellRegisters.h"
+#include "GrimoireTypes.h"
+
+class UHeartGraph;
+class USpellNode;
+
+/** Execution output pins known to the spell runtime. Pins that are read together are kept adjacent. */
+enum class ESpellPin : uint8
+{
+    ExecOut,
+    Next,
+    LoopBody,
+    OnComplete,
+    Branch1,
+    Branch2,
+    Branch3,
+    OnAllComplete,
+    True,
+    False,
+    Open,
+    Closed,
+    MAX
+};
+
+/**
+ * Adjacency of a spell graph keyed by dense node indices and ESpellPin.
+ * Built once per graph and shared until the graph is edited, so traversals are
+ * plain array reads with no GUID lookups and no allocation. Building the index
+ * also resolves the graph's variable names to register slots.
+ */
+class GRIMOIREPLUGIN_API FSpellGraphIndex
+{
+public:
+    static constexpr uint16 InvalidNodeIndex = MAX_uint16;
+    static constexpr int32 PinCount = static_cast<int32>(ESpellPin::MAX);
+    static constexpr int32 EntryKindCount = static_cast<int32>(ETriggerEventType::MAX);
+
+    /** Returns the cached index for Graph, building it if the graph changed since the last call */
+    static TSharedRef<const FSpellGraphIndex> Get(const UHeartGraph* Graph);
+
+    /** Drops the cached index for Graph. Call after adding, removing or reconnecting nodes. */
+    static void Invalidate(const UHeartGraph* Graph);
+
+    static FName GetPinName(ESpellPin Pin);
+
+    int32 Num() const { return Nodes.Num(); }
+    bool IsStale() const { return bStale; }
+
+    USpellNode* GetNode(uint16 NodeIndex) const { return Nodes[NodeIndex]; }
+    TConstArrayView<USpellNode*> GetNodes() const { return Nodes; }
+
+    /** Register slots for every variable name the graph's nodes use */
+    TSharedRef<const FSpellRegisterLayout> GetRegisterLayout() const { return RegisterLayout; }
+
+    /**
+     * Nodes with no incoming execution connection, grouped by the event that starts them.
+     * Trigger nodes use their EventType; any other root starts on cast.
+     */
+    TConstArrayView<uint16> GetEntryPoints(ETriggerEventType Kind) const
+    {
+        const int32 KindIndex = static_cast<int32>(Kind);
+        return TConstArrayView<uint16>(EntryPoints.GetData() + EntryOffsets[KindIndex], EntryOffsets[KindIndex + 1] - EntryOffsets[KindIndex]);
+    }
+
+    /** Dense index of Node in this graph, or InvalidNodeIndex */
+    uint16 GetNodeIndex(const USpellNode* Node) const;
+
+    TConstArrayView<uint16> GetSuccessors(uint16 NodeIndex, ESpellPin Pin) const
+    {
+        return GetSuccessors(NodeIndex, Pin, Pin);
+    }
+
+    /** Successors of every pin in [FirstPin, LastPin], in pin order */
+    TConstArrayView<uint16> GetSuccessors(uint16 NodeIndex, ESpellPin FirstPin, ESpellPin LastPin) const
+    {
+        const int32 Begin = Offsets[NodeIndex * PinCount + static_cast<int32>(FirstPin)];
+        const int32 End = Offsets[NodeIndex * PinCount + static_cast<int32>(LastPin) + 1];
+        return TConstArrayView<uint16>(SuccessorIndices.GetData() + Begin, End - Begin);
+    }
+
+    TConstArrayView<USpellNode*> GetSuccessorNodes(uint16 NodeIndex, ESpellPin Pin) const
+    {
+        return GetSuccessorNodes(NodeIndex, Pin, Pin);
+    }
+
+    TConstArrayView<USpellNode*> GetSuccessorNodes(uint16 NodeIndex, ESpellPin FirstPin, ESpellPin LastPin) const
+    {
+        const int32 Begin = Offsets[NodeIndex * PinCount + static_cast<int32>(FirstPin)];
+        const int32 End = Offsets[NodeIndex * PinCount + static_cast<int32>(LastPin) + 1];
+        return TConstArrayView<USpellNode*>(SuccessorNodes.GetData() + Begin, End - Begin);
+    }
+
+private:
+    void Build(const UHeartGraph* Graph);
+    void BuildEntryPoints();
+
+    TArray<USpellNode*> Nodes;
+
+    // CSR layout: successors of (Node, Pin) are [Offsets[Node * PinCount + Pin], Offsets[Node * PinCount + Pin + 1])
+    TArray<int32> Offsets;
+    TArray<uint16> SuccessorIndices;
+    TArray<USpellNode*> SuccessorNodes;
+
+    // Entry points of kind K are [EntryOffsets[K], EntryOffsets[K + 1])
+    TArray<uint16> EntryPoints;
+    int32 EntryOffsets[EntryKindCount + 1] = {};
+
+    TSharedRef<FSpellRegisterLayout> RegisterLayout = MakeShared<FSpellRegisterLayout>();
+
+    bool bStale = false;
+
+    static TMap<FObjectKey, TSharedRef<FSpellGraphIndex>> Cache;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include "Spells/SpellCompiler.h"
+
+class USpellExecutionContext;
+class UGrimoireExecutorSubsystem;
+
+/** One active instruction on the interpreter stack */
+struct FSpellFrame
+{
+    USpellExecutionContext* Context = nullptr;
+
+    // Context handed to the successors currently being walked
+    USpellExecutionContext* BranchContext = nullptr;
+
+    // Successors currently being walked and the next one to push
+    FSpellExitRange Walk;
+    uint16 Cursor = 0;
+
+    uint16 Instruction = 0;
+    uint8 Phase = 0;
+
+    // Loop bookkeeping, also used as scratch by branching opcodes
+    int32 Iteration = 0;
+    int32 Limit = 0;
+};
+
+/**
+ * Runs an FCompiledSpell with an explicit frame stack instead of recursing
+ * through USpellNode::Execute.
+ * Delays, loop iteration delays and timer triggers suspend the interpreter:
+ * its frames move to the heap and the world scheduler resumes the top frame later, so a
+ * waiting spell holds no native stack.
+ * Spells that outrun the world's per-frame budget yield the same way and are resumed by
+ * UGrimoireExecutorSubsystem on a later frame.
+ * Parallel nodes the optimizer marked with ConcurrentBranches run each branch on its own
+ * interpreter, on worker threads, while the game thread runs one itself and waits for the rest.
+ * Every node run burns fuel from the cast's budget, and a cast that runs dry is aborted.
+ */
+class GRIMOIREPLUGIN_API FSpellInterpreter : public TSharedFromThis<FSpellInterpreter>
+{
+public:
+    /** Runs Program from its entry point until every frame has completed or the spell suspends */
+    static void Execute(const TSharedRef<const FCompiledSpell>& Program, USpellExecutionContext* Context);
+    static void Execute(const TSharedRef<const FCompiledSpell>& Program, USpellExecutionContext* Context, uint16 EntryInstruction);
+
+    /** Runs every entry point of the given kind on Context, in graph order */
+    static void ExecuteEntryPoints(const TSharedRef<const FCompiledSpell>& Program, USpellExecutionContext* Context, ETriggerEventType Kind);
+
+private:
+    // Resumes interpreters that yielded to the frame budget
+    friend class UGrimoireExecutorSubsystem;
+
+    FSpellInterpreter(const TSharedRef<const FCompiledSpell>& InProgram, USpellExecutionContext* InRootContext);
+    FSpellInterpreter(FSpellInterpreter&& Other) = default;
+
+    void Run();
+    void Step(int32 FrameIndex);
+
+    // Null if the spell cannot be parked, and so must run to completion
+    UGrimoireExecutorSubsystem* GetExecutor() const;
+
+    /**
+     * Requests that the interpreter stop after the current step and step the top frame again after Seconds.
+     * Returns false if the spell cannot be parked, in which case the caller carries on immediately.
+     */
+    bool Suspend(float Seconds);
+
+    /** Hands a suspended interpreter to the world's UGrimoireSchedulerSubsystem, or to its executor if it yielded */
+    static void Park(const TSharedRef<FSpellInterpreter>& Interpreter);
+    void Resume();
+
+    /** Burns Node's fuel cost from the cast's budget. Aborts the spell and returns false if the budget is spent. */
+    bool ChargeFuel(USpellExecutionContext* Context, const USpellNode* Node);
+    bool BurnFuel(USpellExecutionContext* Context, int32 Amount, const USpellNode* Node);
+
+    bool CanRunConcurrently(const FSpellInstruction& Instruction) const;
+
+    /**
+     * Runs every branch of the Parallel at FrameIndex to completion, concurrently, and bills their fuel in graph order.
+     * The branch contexts are left forked for the frame to join. Returns false if the cast ran out of fuel.
+     */
+    bool RunConcurrentBranches(int32 FrameIndex);
+
+    void PushInstruction(uint16 InstructionIndex, USpellExecutionContext* Context);
+    bool PushNextSuccessor(int32 FrameIndex);
+    void BeginWalk(int32 FrameIndex, const FSpellExitRange& Range, USpellExecutionContext* Context);
+    void PopFrame();
+
+    void StepAction(int32 FrameIndex, USpellNode* Node);
+    void StepSequence(int32 FrameIndex, USpellNode* Node);
+    void StepLoop(int32 FrameIndex, USpellNode* Node);
+    void StepUnrolled(int32 FrameIndex, USpellNode* Node);
+    void StepDelay(int32 FrameIndex, USpellNode* Node);
+    void StepParallel(int32 FrameIndex, USpellNode* Node);
+    void StepBranch(int32 FrameIndex, USpellNode* Node);
+    void StepCondition(int32 FrameIndex, USpellNode* Node);
+    void StepTrigger(int32 FrameIndex, USpellNode* Node);
+
+    // Keeps the program alive while suspended
+    TSharedRef<const FCompiledSpell> ProgramRef;
+    const FCompiledSpell& Program;
+
+    // Context passed to Execute. Its cast is retained while the interpreter is parked.
+    USpellExecutionContext* RootContext = nullptr;
+
+    // Pre-sized to the program's MaxDepth
+    TArray<FSpellFrame, TInlineAllocator<16>> Frames;
+
+    // Frames this interpreter may push, less than MaxDepth for a branch started partway down
+    int32 DepthLimit = 0;
+
+    // Concurrent branches never touch the cast's fuel or the world's subsystems; the fuel they burn is billed at the join.
+    // Sibling branches draw from one shared pool of what the cast had left at the fork, null if the cast is unmetered.
+    bool bTask = false;
+    std::atomic<int32>* TaskFuel = nullptr;
+    int32 TaskFuelUsed = 0;
+
+    float ResumeDelay = 0.0f;
+    bool bSuspended = false;
+
+    // Suspended because the frame budget ran out rather than to wait
+    bool bYielded = false;
+    bool bRetainedCast = false;
+};
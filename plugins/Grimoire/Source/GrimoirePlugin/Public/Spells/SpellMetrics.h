@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UHeartGraph;
+class USpellNode;
+
+/** What one node adds to its spell's metrics */
+struct FSpellNodeMetrics
+{
+    float ManaCost = 0.0f;
+
+    // Base power of Magic nodes. Other nodes only shape the spell.
+    float Power = 0.0f;
+
+    int32 RarityLevel = 0;
+
+    static FSpellNodeMetrics Of(const USpellNode* Node);
+};
+
+/**
+ * Running totals of mana cost, power and rarity for one spell graph.
+ * Built once per graph and then kept current by applying per-node deltas as
+ * nodes are added, removed or edited, so cost and power queries never walk the graph.
+ */
+class GRIMOIREPLUGIN_API FSpellMetrics
+{
+public:
+    // Spells with more nodes than this lose power, see GetComplexityFactor
+    static constexpr int32 ComplexityThreshold = 5;
+
+    /** Returns the aggregate for Graph, building it on first use */
+    static const FSpellMetrics& Get(const UHeartGraph* Graph);
+
+    /** Incremental updates. Graphs whose aggregate has not been built yet are left alone. */
+    static void AddNode(const UHeartGraph* Graph, const USpellNode* Node);
+    static void RemoveNode(const UHeartGraph* Graph, const USpellNode* Node);
+
+    /** Replaces Node's previous contribution after its rarity, cost or damage changed */
+    static void RefreshNode(const UHeartGraph* Graph, const USpellNode* Node);
+
+    /** Drops the aggregate so the next Get rebuilds it */
+    static void Invalidate(const UHeartGraph* Graph);
+
+    int32 GetNumNodes() const { return Contributions.Num(); }
+    float GetManaCost() const { return static_cast<float>(ManaCost); }
+    float GetBasePower() const { return static_cast<float>(Power); }
+    float GetAverageRarity() const;
+
+    /** 1 up to ComplexityThreshold nodes, then 5% less per node down to 0.5 */
+    float GetComplexityFactor() const;
+
+    /** Base power scaled by complexity and average rarity */
+    float GetSpellPower() const;
+
+private:
+    void Build(const UHeartGraph* Graph);
+    void Add(const FSpellNodeMetrics& Metrics, double Sign);
+
+    // Last contribution applied for each node, so edits and removals subtract exactly what was added
+    TMap<FObjectKey, FSpellNodeMetrics> Contributions;
+
+    double ManaCost = 0.0;
+    double Power = 0.0;
+    int32 RaritySum = 0;
+
+    static TMap<FObjectKey, FSpellMetrics> Cache;
+};
@@ -6,12 +6,15 @@
 #include "Model/HeartGraphPinDesc.h"
 #include "Model/HeartGraphPinReference.h"
 #include "GrimoireTypes.h"
+#include "Spells/SpellGraphIndex.h"
 #include "GameplayAbilitySpec.h"
 #include "Abilities/GameplayAbility.h"
 #include "SpellNode.generated.h"
 
 class UGrimoireComponent;
+class USpellExecutionContext;
 class UGameplayAbility;
+struct FCompiledSpell;
 class UInputAction;
 
 UCLASS(Abstract, Blueprintable)
@@ -58,7 +61,7 @@ public:
 
     // Execution methods
     UFUNCTION(BlueprintCallable, Category = "Execution")
-    virtual void Execute(UGrimoireComponent* Grimoire, AActor* ContextActor);
+    virtual void Execute(USpellExecutionContext* Context);
 
     UFUNCTION(BlueprintCallable, Category = "Execution")
     virtual float GetBasePower() const;
@@ -67,10 +70,18 @@ public:
     virtual void PostInitProperties() override;
     virtual TArray<FHeartGraphPinDesc> GetPins(EHeartPinDirection Direction) const override;
 
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
     // Rarity system
     UFUNCTION(BlueprintCallable, Category = "Rarity")
     float GetRarityScaleFactor() const;
 
+    // Changes rarity and updates the owning spell's cost and power
+    UFUNCTION(BlueprintCallable, Category = "Rarity")
+    void SetNodeRarity(EItemRarity NewRarity);
+
     UFUNCTION(BlueprintCallable, Category = "Rarity")
     int32 GetMaxInputConnections() const;
 
@@ -87,13 +98,40 @@ protected:
     virtual void InitializeDefaultPins();
     
     // Execution helpers
-    virtual void OnExecute(UGrimoireComponent* Grimoire, AActor* ContextActor);
-    virtual void OnExecutionComplete(AActor* ContextActor);
+    virtual void OnExecute(USpellExecutionContext* Context);
+    virtual void OnExecutionComplete(USpellExecutionContext* Context);
     
-    // Connection helpers
-    TArray<USpellNode*> GetConnectedSpellNodes() const;
+    // Connection helpers. Views stay valid until the owning graph is edited.
+    const FSpellGraphIndex* GetGraphIndex() const;
+    TConstArrayView<USpellNode*> GetConnectedSpellNodes(ESpellPin Pin = ESpellPin::ExecOut) const;
+    TConstArrayView<USpellNode*> GetConnectedSpellNodes(ESpellPin FirstPin, ESpellPin LastPin) const;
+
+    // Called when the graph index is built. Nodes that read or write named variables cache their register slots here.
+    virtual void ResolveRegisters(FSpellRegisterLayout& Layout) {}
+
+    // Registers OnExecute may touch, for the spell optimizer. Returns false if unknown, which keeps the optimizer away from the spell.
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const { return false; }
+
+    // True if running this node only reads the world and writes its context, so it can run on a worker thread
+    // while the game thread waits. World changes must go through the context's command buffer; nodes that touch
+    // the world directly, their own state, the random stream or the context pool must return false.
+    virtual bool IsTaskSafe() const { return false; }
 
 private:
+    // The compiled spell interpreter drives OnExecute directly
+    friend class FSpellInterpreter;
+    friend class FSpellGraphIndex;
+    friend class FSpellOptimizer;
+    friend class FSpellCostAnalyzer;
+
+    // Dense index in the owning graph's FSpellGraphIndex, assigned when the index is built
+    uint16 SpellGraphIndex = FSpellGraphIndex::InvalidNodeIndex;
+
+    mutable TSharedPtr<const FSpellGraphIndex> CachedGraphIndex;
+
+    // Program rooted at this node, used when Execute is called on it directly
+    TSharedPtr<const FCompiledSpell> CachedProgram;
+
     // Blood data integration for spell parameters
     TArray<FHeartGraphPinReference> InputPins;
     TArray<FHeartGraphPinReference> OutputPins;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spells/SpellCompiler.h"
+
+/**
+ * Rewrites a compiled spell into a cheaper program with the same observable effects.
+ * Branches whose outcome is decided before the cast lose their dead exit, Flow nodes
+ * that only pass control through are spliced out, nodes whose register writes nobody
+ * reads are dropped, and instructions that become unreachable are removed.
+ * Flow loops with a limit known before the cast are then fused with a matching neighbour,
+ * lose loop-invariant reads from the front of their body, and are unrolled when small.
+ * Parallel nodes whose branches only read the world are marked to run them concurrently.
+ *
+ * Register analysis assumes every register starts unset, so only optimize programs
+ * that run on fresh cast contexts.
+ */
+class GRIMOIREPLUGIN_API FSpellOptimizer
+{
+public:
+    static void Optimize(FCompiledSpell& Spell);
+
+private:
+    struct FWorkInstruction
+    {
+        ESpellOpCode OpCode = ESpellOpCode::Action;
+        ESpellInstructionFlags Flags = ESpellInstructionFlags::None;
+        uint16 NodeIndex = 0;
+        TArray<uint16, TInlineAllocator<4>> Exits[2];
+        FSpellRegisterAccess Access;
+        bool bEntry = false;
+        bool bRemoved = false;
+    };
+
+    // Everything reachable from a loop body or a set of parallel branches
+    struct FLoopRegion
+    {
+        FSpellRegisterAccess Access;
+        TBitArray<> Instructions;
+
+        // Something in the region can suspend the cast, letting other work touch the registers
+        bool bSuspends = false;
+    };
+
+    // Largest number of successors, over all iterations, a loop body is unrolled into
+    static constexpr int32 MaxUnrolledSuccessors = 64;
+
+    explicit FSpellOptimizer(FCompiledSpell& InProgram);
+
+    bool Analyze();
+    bool FoldBranches();
+    bool RemoveUnreachable();
+    bool CollapsePassThrough();
+    void Rebuild();
+
+    // Loop passes, run once the rest of the program has stopped shrinking
+    void OptimizeLoops();
+    bool FuseLoops();
+    bool HoistInvariant(int32 Index);
+    bool UnrollLoop(int32 Index);
+    void SetLoopFlags(int32 Index);
+
+    void MarkConcurrentBranches();
+    bool IsTaskSafe(const FLoopRegion& Region) const;
+
+    // Returns the instructions that can take Index's place, or false if it must stay
+    bool GetPassThrough(int32 Index, TArray<uint16, TInlineAllocator<4>>& OutReplacement) const;
+    bool CanSplice(const FWorkInstruction& Predecessor, int32 ExitIndex, int32 ReplacementNum) const;
+    bool CanFuse(uint16 First, uint16 Second) const;
+
+    // Iterations a loop runs when only its limit can end it and the limit is fixed at compile time, or INDEX_NONE
+    int32 GetFixedIterationCount(const FWorkInstruction& Item) const;
+    bool HasLoopChecks(const FWorkInstruction& Item) const;
+    bool ReadsLoopRegisters(ESpellOpCode OpCode) const;
+    bool CanSuspend(const FWorkInstruction& Item) const;
+
+    void GetRegion(TConstArrayView<uint16> Roots, FLoopRegion& OutRegion) const;
+    int32 CountReferences(uint16 Index) const;
+
+    // True if a slot set in both Writes and Other is read anywhere in the program
+    bool Conflicts(const TBitArray<>& Writes, const TBitArray<>& Other) const;
+
+    void CountAccess(const FSpellRegisterAccess& Access, int32 Delta);
+    bool IsWritten(ESpellRegister Register) const { return WriteCounts[static_cast<int32>(Register)] > 0; }
+    bool IsRead(ESpellRegister Register) const { return ReadCounts[static_cast<int32>(Register)] > 0; }
+    bool IsWritten(int32 Slot) const { return Slot != FSpellRegisterLayout::InvalidSlot && WriteCounts[Slot] > 0; }
+
+    FCompiledSpell& Program;
+    TArray<FWorkInstruction> Work;
+
+    // Live instructions reading and writing each register slot
+    TArray<int32> ReadCounts;
+    TArray<int32> WriteCounts;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Variables the built-in nodes read and write on every cast.
+ * Their slots are fixed, so runtime code addresses them without a name lookup.
+ */
+enum class ESpellRegister : uint8
+{
+    Condition,
+    ConditionResult,
+    LastConditionNode,
+    BoolCondition,
+    ConditionValue,
+    CompareValue,
+    GateOpen,
+    ShouldContinue,
+    DelayTime,
+    IterationCount,
+    SequenceIndex,
+    SequenceTotal,
+    LoopIndex,
+    LoopTotal,
+    WhileIndex,
+    ForIndex,
+    ForTotal,
+    Value,
+    NewValue,
+    OperandB,
+    CurrentValue,
+    PreviousValue,
+    ValueChanged,
+    MAX
+};
+
+/**
+ * Assigns register slots to variable names.
+ * Built-in registers always occupy the first slots, followed by the names a
+ * spell graph's nodes use, so every layout is an extension of the default one.
+ */
+class GRIMOIREPLUGIN_API FSpellRegisterLayout
+{
+public:
+    static constexpr int32 InvalidSlot = INDEX_NONE;
+    static constexpr int32 BuiltinCount = static_cast<int32>(ESpellRegister::MAX);
+
+    FSpellRegisterLayout();
+
+    /** Layout with only the built-in registers */
+    static const TSharedRef<const FSpellRegisterLayout>& GetDefault();
+
+    static FName GetRegisterName(ESpellRegister Register);
+
+    /** Returns the slot for Name, adding one if needed */
+    int32 AddSlot(FName Name);
+
+    int32 FindSlot(FName Name) const
+    {
+        const int32* Slot = NameToSlot.Find(Name);
+        return Slot ? *Slot : InvalidSlot;
+    }
+
+    FName GetSlotName(int32 Slot) const { return SlotNames[Slot]; }
+    int32 Num() const { return SlotNames.Num(); }
+
+private:
+    TArray<FName> SlotNames;
+    TMap<FName, int32> NameToSlot;
+};
+
+/**
+ * Register slots a node may read or write when it runs, reported to the spell optimizer.
+ * Local and global banks are not told apart.
+ */
+struct FSpellRegisterAccess
+{
+    TBitArray<> Reads;
+    TBitArray<> Writes;
+
+    // Effects beyond the cast's registers, such as spawning actors, dealing damage or changing node state
+    bool bHasSideEffects = false;
+
+    // Running the node twice in a row leaves the registers as running it once would
+    bool bIdempotent = false;
+
+    void Read(int32 Slot) { Mark(Reads, Slot); }
+    void Write(int32 Slot) { Mark(Writes, Slot); }
+    void Read(ESpellRegister Register) { Read(static_cast<int32>(Register)); }
+    void Write(ESpellRegister Register) { Write(static_cast<int32>(Register)); }
+
+    // Named variables outside the layout cannot alias a register
+    void Read(const FSpellRegisterLayout& Layout, FName Name) { Read(Layout.FindSlot(Name)); }
+
+    // Named variables outside the layout live in the context's overflow maps, which are not tracked
+    void Write(const FSpellRegisterLayout& Layout, FName Name)
+    {
+        const int32 Slot = Layout.FindSlot(Name);
+        if (Slot == FSpellRegisterLayout::InvalidSlot)
+        {
+            bHasSideEffects = true;
+        }
+        Write(Slot);
+    }
+
+private:
+    static void Mark(TBitArray<>& Bits, int32 Slot)
+    {
+        if (Slot == FSpellRegisterLayout::InvalidSlot)
+        {
+            return;
+        }
+        if (Slot >= Bits.Num())
+        {
+            Bits.Add(false, Slot + 1 - Bits.Num());
+        }
+        Bits[Slot] = true;
+    }
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid broadphase for spell objects, rebuilt from scratch each tick.
+ * Points are bucketed by hashed cell with a counting sort, so building and
+ * finding pairs are both linear in the number of points for bounded density.
+ * Cells are as wide as the contact distance, so a point can only touch points
+ * in its own cell or the 26 around it.
+ */
+class GRIMOIREPLUGIN_API FSpellSpatialHash
+{
+public:
+    /** Buckets the points given as parallel coordinate arrays. Points within ContactDistance of each other are pairs. */
+    void Build(TConstArrayView<float> X, TConstArrayView<float> Y, TConstArrayView<float> Z, float ContactDistance);
+
+    /** Appends each pair of points within the contact distance once, lower index first */
+    void FindPairs(TArray<TPair<int32, int32>>& OutPairs) const;
+
+    int32 Num() const { return Points.Num(); }
+
+private:
+    uint32 GetBucket(const FIntVector& Cell) const
+    {
+        return (static_cast<uint32>(Cell.X) * 73856093u ^ static_cast<uint32>(Cell.Y) * 19349663u ^ static_cast<uint32>(Cell.Z) * 83492791u) & BucketMask;
+    }
+
+    TArray<FVector3f> Points;
+    TArray<FIntVector> Cells;
+
+    // Point indices grouped by bucket; bucket B holds SortedPoints[BucketStart[B]] up to BucketStart[B + 1]
+    TArray<int32> SortedPoints;
+    TArray<int32> BucketStart;
+
+    uint32 BucketMask = 0;
+    float CellSize = 1.0f;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "GrimoireTypes.h"
+
+/**
+ * Compact spell variable value: a type tag and a 12-byte payload.
+ * Strings are stored as handles into a process-wide, case-sensitive intern table and
+ * vectors are stored at float precision, so copies never touch the heap and equality
+ * is a tag check plus three word compares.
+ * FGWTVariableValue remains the Blueprint-facing form. Converting to it is lossless;
+ * converting from it narrows double vectors to float, which keeps about seven
+ * significant digits, so world positions beyond roughly 100 km lose centimetre precision.
+ */
+struct GRIMOIREPLUGIN_API FSpellValue
+{
+    FSpellValue()
+    {
+        Payload.Words[0] = Payload.Words[1] = Payload.Words[2] = 0;
+    }
+
+    /** Vectors are narrowed to float precision, see the class comment */
+    explicit FSpellValue(const FGWTVariableValue& Value);
+
+    FGWTVariableValue ToVariableValue() const;
+
+    static FSpellValue FromFloat(float In) { FSpellValue V; V.Type = EGWTVariableType::Float; V.Payload.Float = In; return V; }
+    static FSpellValue FromInt(int32 In) { FSpellValue V; V.Type = EGWTVariableType::Int; V.Payload.Int = In; return V; }
+    static FSpellValue FromBool(bool In) { FSpellValue V; V.Type = EGWTVariableType::Bool; V.Payload.Words[0] = In ? 1 : 0; return V; }
+    static FSpellValue FromVector(const FVector3f& In);
+    static FSpellValue FromVector(const FVector& In) { return FromVector(FVector3f(In)); } // Narrows to float
+    static FSpellValue FromString(const FString& In);
+    static FSpellValue FromObject(const UObject* In);
+    static FSpellValue FromActor(const AActor* In) { return FromObject(In); }
+
+    EGWTVariableType GetType() const { return Type; }
+    bool IsSet() const { return Type != EGWTVariableType::None; }
+
+    // Typed reads return the type's default when the value holds something else
+    float GetFloat() const { return Type == EGWTVariableType::Float ? Payload.Float : 0.0f; }
+    int32 GetInt() const { return Type == EGWTVariableType::Int ? Payload.Int : 0; }
+    bool GetBool() const { return Type == EGWTVariableType::Bool && Payload.Words[0] != 0; }
+    FVector3f GetVector() const;
+    const FString& GetString() const;
+    UObject* GetObject() const;
+
+    /** Human readable payload for logs */
+    FString ToString() const;
+
+    bool operator==(const FSpellValue& Other) const
+    {
+        return Type == Other.Type
+            && Payload.Words[0] == Other.Payload.Words[0]
+            && Payload.Words[1] == Other.Payload.Words[1]
+            && Payload.Words[2] == Other.Payload.Words[2];
+    }
+    bool operator!=(const FSpellValue& Other) const { return !(*this == Other); }
+
+private:
+    union FPayload
+    {
+        float Float;
+        int32 Int;
+        float Vector[3];
+        int32 StringHandle;
+        int32 Object[2];    // FWeakObjectPtr index and serial number
+        uint32 Words[3];
+    };
+
+    FPayload Payload;
+    EGWTVariableType Type = EGWTVariableType::None;
+};
+
+static_assert(sizeof(FSpellValue) == 16, "FSpellValue should stay 16 bytes");
+static_assert(sizeof(FWeakObjectPtr) == 2 * sizeof(int32), "FSpellValue stores FWeakObjectPtr in two words");
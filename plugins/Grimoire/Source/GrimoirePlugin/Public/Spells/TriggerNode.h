@@ -5,16 +5,6 @@
 #include "SpellNode.h"
 #include "TriggerNode.generated.h"
 
-UENUM(BlueprintType)
-enum class ETriggerEventType : uint8
-{
-    OnCast,
-    OnHit,
-    OnEnemyEnter,
-    OnTimer,
-    MAX UMETA(Hidden)
-};
-
 UCLASS(Blueprintable, meta = (DisplayName = "Trigger Node"))
 class GRIMOIREPLUGIN_API UTriggerNode : public USpellNode
 {
@@ -30,12 +20,20 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trigger")
     float TimerInterval = 0.0f; // For OnTimer
 
-    virtual void Execute(UObject* Context) override;
+    // For OnTimer, firings per cast including the first. A later cast of the same spell also ends the chain.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Trigger", meta = (ClampMin = "1"))
+    int32 MaxFirings = 10;
+
+    virtual void OnExecute(USpellExecutionContext* Context) override;
     virtual float GetBasePower() const override;
 
 protected:
-    FTimerHandle TimerHandle;
+    // Called each time an OnTimer trigger fires again
+    void HandleTimerTrigger(USpellExecutionContext* Context);
+
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const override;
 
-    UFUNCTION()
-    void HandleTimerTrigger(UObject* Context);
+private:
+    // OnTimer repetition is driven by the interpreter, which suspends between firings
+    friend class FSpellInterpreter;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "Spells/SpellNode.h"
 #include "GrimoireTypes.h"
+#include "Spells/SpellValue.h"
 #include "VariableNode.generated.h"
 
 UENUM(BlueprintType)
@@ -27,8 +28,8 @@ struct FVariableHistory
 {
     GENERATED_BODY()
 
-    UPROPERTY(EditAnywhere, BlueprintReadWrite)
-    TArray<FGWTVariableValue> PreviousValues;
+    // Compact values; convert with FSpellValue::ToVariableValue for Blueprint
+    TArray<FSpellValue> PreviousValues;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     TArray<float> Timestamps;
@@ -36,7 +37,7 @@ struct FVariableHistory
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     int32 MaxHistorySize = 10;
 
-    void AddValue(const FGWTVariableValue& Value, float Timestamp)
+    void AddValue(const FSpellValue& Value, float Timestamp)
     {
         PreviousValues.Add(Value);
         Timestamps.Add(Timestamp);
@@ -49,9 +50,9 @@ struct FVariableHistory
         }
     }
 
-    FGWTVariableValue GetLastValue() const
+    FSpellValue GetLastValue() const
     {
-        return PreviousValues.Num() > 0 ? PreviousValues.Last() : FGWTVariableValue();
+        return PreviousValues.Num() > 0 ? PreviousValues.Last() : FSpellValue();
     }
 };
 
@@ -110,7 +111,7 @@ public:
     virtual TArray<FHeartGraphPinDesc> GetInputPinDescs() const override;
     virtual TArray<FHeartGraphPinDesc> GetOutputPinDescs() const override;
 
-    // Variable operations
+    // Variable operations, Blueprint-facing wrappers around the FSpellValue versions below
     UFUNCTION(BlueprintCallable, Category = "Variable")
     FGWTVariableValue GetVariableValue(USpellExecutionContext* Context);
 
@@ -122,23 +123,35 @@ public:
 
 protected:
     // Variable management
-    FGWTVariableValue CreateDefaultValue();
+    bool HasVariableValue(USpellExecutionContext* Context) const;
+    FSpellValue ReadVariable(USpellExecutionContext* Context) const;
+    void WriteVariable(USpellExecutionContext* Context, const FSpellValue& Value);
+    FSpellValue CreateDefaultValue() const;
     void InitializeVariable(USpellExecutionContext* Context);
+
+    FSpellValue ApplyMathOperation(const FSpellValue& A, const FSpellValue& B, EVariableNodeOperation Op) const;
     
     // Type conversion
-    FGWTVariableValue ConvertToType(const FGWTVariableValue& Value, EGWTVariableType TargetType);
+    FSpellValue ConvertToType(const FSpellValue& Value, EGWTVariableType TargetType) const;
     
     // History tracking (for Rare+ rarity)
-    void UpdateVariableHistory(USpellExecutionContext* Context, const FGWTVariableValue& OldValue, const FGWTVariableValue& NewValue);
+    void UpdateVariableHistory(USpellExecutionContext* Context, const FSpellValue& OldValue, const FSpellValue& NewValue);
     
     // Persistence (for Legendary rarity)
     void LoadPersistentValue(USpellExecutionContext* Context);
-    void SavePersistentValue(const FGWTVariableValue& Value);
+    void SavePersistentValue(const FSpellValue& Value);
 
     // Rarity effects
     void ApplyRarityEffects(USpellExecutionContext* Context);
 
+    virtual void ResolveRegisters(FSpellRegisterLayout& Layout) override;
+    virtual bool GetRegisterAccess(const FSpellRegisterLayout& Layout, FSpellRegisterAccess& OutAccess) const override;
+    virtual bool IsTaskSafe() const override;
+
 private:
+    // Register slot of VariableName in the owning graph's layout
+    int32 VariableSlot = FSpellRegisterLayout::InvalidSlot;
+
     // History storage
     UPROPERTY()
     TMap<FName, FVariableHistory> VariableHistories;
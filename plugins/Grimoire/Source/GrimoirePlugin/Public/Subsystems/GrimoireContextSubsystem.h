@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Spells/SpellCastArena.h"
+#include "GrimoireContextSubsystem.generated.h"
+
+class USpellExecutionContext;
+class UGrimoireComponent;
+
+/**
+ * Per-world pool of spell execution contexts.
+ * Each cast gets a root context and an arena; child contexts for parallel and
+ * quantum branches come from the same pool. When the cast's last reference is
+ * released its contexts and arena are recycled in O(1), so casting creates no
+ * UObject garbage once the pool is warm.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireContextSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+
+    /** Starts a cast and returns its root context. Call ReleaseCast on it once the cast has run. */
+    USpellExecutionContext* BeginCast();
+
+    UFUNCTION(BlueprintCallable, Category = "Grimoire|Pool")
+    int32 GetNumPooledContexts() const { return Contexts.Num(); }
+
+    UFUNCTION(BlueprintCallable, Category = "Grimoire|Pool")
+    int32 GetNumActiveCasts() const { return NumActiveCasts; }
+
+private:
+    friend class USpellExecutionContext;
+
+    USpellExecutionContext* AcquireContext(FSpellCast& Cast);
+    void RecycleCast(FSpellCast& Cast);
+
+    // Owns every pooled context so none of them become garbage
+    UPROPERTY()
+    TArray<USpellExecutionContext*> Contexts;
+
+    TArray<TUniquePtr<FSpellCast>> Casts;
+
+    // Intrusive free lists
+    USpellExecutionContext* FreeContexts = nullptr;
+    FSpellCast* FreeCasts = nullptr;
+
+    int32 NumActiveCasts = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/DamageEvents.h"
+#include "UObject/ObjectKey.h"
+#include "GrimoireTypes.h"
+#include "GrimoireDamageSubsystem.generated.h"
+
+/** One hit folded into an aggregated spell damage event */
+USTRUCT(BlueprintType)
+struct FSpellDamageHit
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    float Amount = 0.0f;
+
+    // World time the hit landed
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    float Time = 0.0f;
+};
+
+/** Every hit one instigator dealt one target with one element in a frame */
+USTRUCT(BlueprintType)
+struct FSpellDamageSummary
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    TWeakObjectPtr<AActor> Instigator;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    TWeakObjectPtr<AActor> Target;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    bool bHasElement = false;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    ESpellElement Element = ESpellElement::Fire;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    float TotalDamage = 0.0f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Damage")
+    TArray<FSpellDamageHit> Hits;
+};
+
+/** Damage event for aggregated spell hits. Receivers can read the per-hit breakdown from TakeDamage. */
+struct GRIMOIREPLUGIN_API FSpellDamageEvent : public FDamageEvent
+{
+    static const int32 ClassID = 0x47524D44;
+
+    const FSpellDamageSummary* Summary = nullptr;
+
+    FSpellDamageEvent() = default;
+    explicit FSpellDamageEvent(const FSpellDamageSummary& InSummary)
+        : FDamageEvent(UDamageType::StaticClass())
+        , Summary(&InSummary)
+    {
+    }
+
+    virtual int32 GetTypeID() const override { return ClassID; }
+    virtual bool IsOfType(int32 InID) const override { return InID == ClassID || FDamageEvent::IsOfType(InID); }
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSpellDamageApplied, const FSpellDamageSummary&, Summary);
+
+/**
+ * Collects spell damage for a frame and applies it once per (instigator, target, element).
+ * A spell hitting 40 enemies 10 times a frame sends 40 TakeDamage calls instead of 400,
+ * each with an FSpellDamageEvent listing the hits it folds together.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireDamageSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Queues a hit for this frame's batch. Element MAX is untyped damage. */
+    void AddHit(AActor* Target, float Amount, AActor* Instigator, ESpellElement Element);
+
+    /** Applies every queued hit now */
+    void Flush();
+
+    /** Broadcast after each aggregated event is applied, for UI and analytics */
+    UPROPERTY(BlueprintAssignable, Category = "Grimoire")
+    FOnSpellDamageApplied OnDamageApplied;
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    int32 GetNumPendingHits() const { return NumPendingHits; }
+
+    /** Damage queued for this frame's batch, one summary per instigator, target and element */
+    TConstArrayView<FSpellDamageSummary> GetPendingDamage() const { return Pending; }
+
+private:
+    TArray<FSpellDamageSummary> Pending;
+    TMap<TTuple<FObjectKey, FObjectKey, ESpellElement>, int32> PendingIndex;
+    int32 NumPendingHits = 0;
+
+    // Swapped with Pending while applying, so damage handlers can queue hits for the next batch
+    TArray<FSpellDamageSummary> Applying;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "GrimoireElementSubsystem.generated.h"
+
+class UDataTable;
+
+/**
+ * Compiles the element interaction table from UGrimoireSettings into an
+ * FElementInteractionMatrix when the engine starts, so no collision ever loads or
+ * searches the table. In the editor the matrix is rebuilt and swapped in whole
+ * whenever the table is reimported or edited, or the setting points elsewhere.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireElementSubsystem : public UEngineSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    /** Recompiles the configured table and publishes the result. A table that fails validation is logged and the previous matrix stays. */
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    void Rebuild();
+
+private:
+#if WITH_EDITOR
+    void HandleSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent);
+#endif
+
+    // Kept loaded and watched for edits
+    UPROPERTY()
+    UDataTable* InteractionTable = nullptr;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrimoireExecutorSubsystem.generated.h"
+
+class FSpellInterpreter;
+
+/** Order in which queued spell work runs. Lower values go first. */
+UENUM(BlueprintType)
+enum class EGrimoireSpellPriority : uint8
+{
+    Player,
+    NearCamera,
+    Background,
+    MAX UMETA(Hidden)
+};
+
+/**
+ * Caps how much time spell interpreters spend per frame.
+ * Interpreters check the budget between steps and yield once it is spent; a yielded
+ * interpreter keeps its frames and is queued here by the priority of its caster.
+ * Each tick opens a new budget, which queued work gets first claim on: player casts,
+ * then casters near a player's view, then everything else, oldest first within a priority.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireExecutorSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Returns the time at which an interpreter that starts running at StartTime must yield. Pair with EndSlice. */
+    double BeginSlice(double StartTime);
+    void EndSlice(double StartTime);
+
+    /** Queues a yielded interpreter to resume when budget is available */
+    void Enqueue(const TSharedRef<FSpellInterpreter>& Interpreter, const AActor* Caster);
+
+    EGrimoireSpellPriority GetPriority(const AActor* Caster) const;
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    int32 GetQueueDepth() const;
+
+    /** Milliseconds spent running spells in the last completed budget window */
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    float GetLastFrameTimeMs() const { return static_cast<float>(LastFrameSeconds * 1000.0); }
+
+private:
+    double GetBudgetSeconds() const;
+
+    // FIFO that dequeues by advancing Head; the consumed prefix is dropped once per tick
+    struct FSpellQueue
+    {
+        TArray<TSharedPtr<FSpellInterpreter>> Items;
+        int32 Head = 0;
+
+        int32 Num() const { return Items.Num() - Head; }
+    };
+
+    FSpellQueue Queues[static_cast<int32>(EGrimoireSpellPriority::MAX)];
+
+    // Spell time spent in the current budget window
+    double UsedSeconds = 0.0;
+    double LastFrameSeconds = 0.0;
+
+    // Slices nest when a node starts another spell synchronously; only the outermost one is timed
+    int32 SliceDepth = 0;
+};
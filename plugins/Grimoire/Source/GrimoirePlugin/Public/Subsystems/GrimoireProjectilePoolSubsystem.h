@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GrimoireProjectilePoolSubsystem.generated.h"
+
+class UActorComponent;
+
+/** Occupancy and hit rate of one projectile class's pool */
+USTRUCT(BlueprintType)
+struct FGrimoireProjectilePoolStats
+{
+    GENERATED_BODY()
+
+    // Projectiles handed out and not yet released
+    UPROPERTY(BlueprintReadOnly, Category = "Projectiles")
+    int32 Active = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Projectiles")
+    int32 Idle = 0;
+
+    // Acquires served from the pool
+    UPROPERTY(BlueprintReadOnly, Category = "Projectiles")
+    int32 Reused = 0;
+
+    // Acquires that had to spawn a new actor
+    UPROPERTY(BlueprintReadOnly, Category = "Projectiles")
+    int32 Misses = 0;
+};
+
+/** What a projectile had switched on when it was pooled, so reuse restores exactly that */
+struct FGrimoirePooledProjectileState
+{
+    struct FComponentState
+    {
+        TWeakObjectPtr<UActorComponent> Component;
+        bool bActive = false;
+        bool bTickEnabled = false;
+    };
+
+    TArray<FComponentState> Components;
+    bool bHidden = false;
+    bool bCollisionEnabled = false;
+    bool bTickEnabled = false;
+};
+
+USTRUCT()
+struct FGrimoireProjectilePool
+{
+    GENERATED_BODY()
+
+    // Deactivated projectiles ready for reuse
+    UPROPERTY()
+    TArray<AActor*> Idle;
+
+    // Parallel to Idle
+    TArray<FGrimoirePooledProjectileState> IdleStates;
+
+    UPROPERTY()
+    FGrimoireProjectilePoolStats Stats;
+};
+
+/**
+ * Reuses spell projectile actors instead of spawning and destroying one per cast.
+ * Pools are keyed by class and pre-warmed from UGrimoireSettings when the map begins play.
+ * Released projectiles are hidden, lose collision and tick, and have their components
+ * deactivated; acquiring one moves it into place and restores the visibility, collision,
+ * tick and component activation it had when it was pooled. Life spans run on
+ * the world scheduler rather than SetLifeSpan, so an expired projectile returns to the pool.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireProjectilePoolSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+    /**
+     * Places a projectile of ActorClass, reusing an idle one if there is one. Released after LifeSpan seconds if positive.
+     * Without a world scheduler a projectile with a life span is destroyed instead, and is never active in the pool.
+     */
+    AActor* Acquire(TSubclassOf<AActor> ActorClass, const FVector& Location, const FRotator& Rotation, float LifeSpan);
+
+    /** Returns a projectile from Acquire to its pool. Returns false if it is not an active pooled projectile. */
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    bool Release(AActor* Projectile);
+
+    /** Spawns idle projectiles until ActorClass has at least Count */
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    FGrimoireProjectilePoolStats GetPoolStats(TSubclassOf<AActor> ActorClass) const;
+
+private:
+    AActor* SpawnProjectile(UClass* ActorClass, const FVector& Location, const FRotator& Rotation) const;
+    static void Activate(AActor* Projectile, const FGrimoirePooledProjectileState& State);
+    static FGrimoirePooledProjectileState Deactivate(AActor* Projectile);
+
+    void AddIdle(FGrimoireProjectilePool& Pool, AActor* Projectile);
+
+    // Takes the key rather than a weak pointer so a projectile destroyed while active still leaves the counts
+    void HandleExpired(TObjectKey<AActor> ProjectileKey, UClass* ActorClass);
+
+    UPROPERTY()
+    TMap<UClass*, FGrimoireProjectilePool> Pools;
+
+    // Pending expiry of each active projectile, invalid if it has no life span
+    TMap<TObjectKey<AActor>, FGrimoireScheduleHandle> ActiveProjectiles;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "GrimoireTypes.h"
+#include "Spells/SpellSpatialHash.h"
+#include "GrimoireProjectileSubsystem.generated.h"
+
+class UGrimoireComponent;
+
+/** Two projectiles whose elements cancel that met and destroyed each other */
+USTRUCT(BlueprintType)
+struct FGrimoireElementalCollision
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Projectile")
+    FVector Location = FVector::ZeroVector;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Projectile")
+    FElementInteraction Interaction;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnElementalCollision, const FGrimoireElementalCollision&, Collision);
+
+/**
+ * Simulates spell projectiles as data instead of actors.
+ * Projectiles are stored as parallel arrays and moved in one vectorized pass per tick,
+ * then swept against the world in one batch of async traces whose results are read
+ * on the next tick. A hit removes the projectile and runs its spell's OnHit triggers.
+ * Projectiles of elements whose interaction cancels projectiles destroy each other when
+ * they meet; a spatial hash finds the candidate pairs in one pass.
+ * Nothing here renders; draw from GetLocations with instanced meshes or Niagara, or
+ * not at all on a server.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireProjectileSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Starts a projectile that flies until it hits something or has travelled Range */
+    void Launch(const FVector& Location, const FVector& Velocity, ESpellElement Element, float Range, AActor* Owner, UGrimoireComponent* Grimoire, FName SpellName);
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    int32 GetNumProjectiles() const { return Elements.Num(); }
+
+    /** Current location of every projectile, for rendering */
+    void GetLocations(TArray<FVector>& OutLocations) const;
+
+    FVector GetLocation(int32 Index) const { return FVector(PositionX[Index], PositionY[Index], PositionZ[Index]); }
+    FVector GetVelocity(int32 Index) const { return FVector(VelocityX[Index], VelocityY[Index], VelocityZ[Index]); }
+    ESpellElement GetElement(int32 Index) const { return Elements[Index]; }
+
+    /** Broadcast for each pair of projectiles that cancelled each other */
+    UPROPERTY(BlueprintAssignable, Category = "Grimoire")
+    FOnElementalCollision OnElementalCollision;
+
+private:
+    struct FProjectileHit
+    {
+        TWeakObjectPtr<UGrimoireComponent> Grimoire;
+        FName SpellName;
+        TWeakObjectPtr<AActor> HitActor;
+    };
+
+    // Reads last tick's sweeps and removes projectiles that hit something or ran out of range
+    void ResolveHits(TArray<FProjectileHit>& OutHits);
+
+    // Advances every projectile by DeltaTime
+    void Integrate(float DeltaTime);
+
+    // Removes projectiles that met one of an element that cancels theirs
+    void ResolveElementalCollisions(TArray<FGrimoireElementalCollision>& OutCollisions);
+
+    // Sweeps each projectile over the segment it just moved
+    void SweepMoved(float DeltaTime);
+
+    void RemoveAtSwap(int32 Index);
+
+    // Structure of arrays, kept dense by swap removal. Floats, so the integrator can work four lanes at a time.
+    TArray<float> PositionX;
+    TArray<float> PositionY;
+    TArray<float> PositionZ;
+    TArray<float> VelocityX;
+    TArray<float> VelocityY;
+    TArray<float> VelocityZ;
+    TArray<float> Speeds;
+    TArray<float> RangeRemaining;
+    TArray<ESpellElement> Elements;
+    TArray<TWeakObjectPtr<AActor>> Owners;
+    TArray<TWeakObjectPtr<UGrimoireComponent>> Grimoires;
+    TArray<FName> SpellNames;
+
+    FSpellSpatialHash Broadphase;
+    TArray<TPair<int32, int32>> CandidatePairs;
+
+    // Sweeps issued last tick. Each carries the index its projectile had then; projectiles are only removed before sweeping.
+    TArray<FTraceHandle> PendingSweeps;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrimoireSchedulerSubsystem.generated.h"
+
+/** Identifies a scheduled continuation. Stale handles are ignored by Cancel. */
+struct FGrimoireScheduleHandle
+{
+    int32 Index = INDEX_NONE;
+    uint32 Serial = 0;
+
+    bool IsValid() const { return Index != INDEX_NONE; }
+    void Invalidate() { Index = INDEX_NONE; }
+};
+
+/**
+ * Runs spell continuations (resumed casts, delayed flow outputs) after a delay in world time.
+ * Continuations live in a hierarchical timing wheel: four levels of 64 slots at
+ * 1/64 s resolution. Scheduling and cancelling are O(1) list operations, and
+ * everything that falls due in a frame is run as one batch from Tick.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireSchedulerSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static constexpr double TickSeconds = 1.0 / 64.0;
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Runs Continuation once Delay seconds of world time have passed, at the earliest on the next tick */
+    FGrimoireScheduleHandle Schedule(float Delay, FSimpleDelegate&& Continuation);
+
+    /** Removes a pending continuation. Returns false if it already ran or was cancelled. */
+    bool Cancel(FGrimoireScheduleHandle& Handle);
+
+    int32 GetNumPending() const { return NumPending; }
+
+private:
+    static constexpr int32 SlotBits = 6;
+    static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+    static constexpr int32 NumLevels = 4;
+
+    // Entries that are free or already taken out of the wheel for running
+    static constexpr int32 NoSlot = INDEX_NONE;
+
+    struct FEntry
+    {
+        FSimpleDelegate Continuation;
+        uint64 DueTick = 0;
+        int32 Prev = INDEX_NONE;
+        int32 Next = INDEX_NONE;
+        int32 Slot = NoSlot;
+        uint32 Serial = 0;
+    };
+
+    uint64 GetCurrentWorldTick() const;
+
+    void Link(int32 EntryIndex);
+    void Unlink(int32 EntryIndex);
+    void Release(int32 EntryIndex);
+
+    /** Moves the wheel forward to TargetTick, collecting due entries into DueBatch */
+    void Advance(uint64 TargetTick);
+
+    TArray<FEntry> Entries;
+    int32 FirstFree = INDEX_NONE;
+
+    // Head entry of each slot, level-major
+    int32 SlotHeads[NumLevels * SlotsPerLevel];
+
+    uint64 CurrentTick = 0;
+    int32 NumPending = 0;
+
+    // Entries due this frame with the serial they had when collected
+    TArray<TPair<int32, uint32>> DueBatch;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Subsystems/GrimoireSchedulerSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Spells/EffectNode.h"
+#include "GrimoireStatusSubsystem.generated.h"
+
+class UGrimoireDamageSubsystem;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnStatusChanged, AActor*, Target, EStatusEffectType, Status, bool, bActive);
+
+/**
+ * Every active status effect in the world, one per target and type, kept in packed arrays.
+ * Damage over time for all of them is worked out in one vectorized pass every
+ * StatusDamageInterval and sent through UGrimoireDamageSubsystem. Each status is charged
+ * for the time it was active since it was last charged, and once more when it ends, so
+ * statuses starting or ending between passes deal exactly their duration's damage. Expiry runs on the
+ * world scheduler's timing wheel, and each target's statuses are mirrored in a bitmask
+ * so HasStatus is a single lookup. Slows and stuns are left to gameplay code, which
+ * hears about every status starting and ending through OnStatusChanged.
+ * Statuses only change on the game thread, from applied spell commands and expiry, so
+ * spell branches on worker threads may read them while the game thread waits.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireStatusSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Starts Status on Target, or refreshes it to whichever of its remaining and the new duration is longer */
+    void ApplyStatus(AActor* Target, EStatusEffectType Status, float Duration, AActor* Instigator);
+
+    /** Ends Status on Target early. Returns false if it did not have it. */
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    bool RemoveStatus(AActor* Target, EStatusEffectType Status);
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    bool HasStatus(const AActor* Target, EStatusEffectType Status) const
+    {
+        return (GetStatusMask(Target) & (1 << static_cast<uint8>(Status))) != 0;
+    }
+
+    /** Bit per EStatusEffectType the target has */
+    uint8 GetStatusMask(const AActor* Target) const
+    {
+        const uint8* Mask = StatusMasks.Find(TObjectKey<AActor>(Target));
+        return Mask ? *Mask : 0;
+    }
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    int32 GetNumActiveStatuses() const { return Statuses.Num(); }
+
+    UPROPERTY(BlueprintAssignable, Category = "Grimoire")
+    FOnStatusChanged OnStatusChanged;
+
+private:
+    static_assert(static_cast<uint8>(EStatusEffectType::MAX) <= 8, "Status masks are one byte");
+
+    using FStatusKey = TTuple<TObjectKey<AActor>, EStatusEffectType>;
+
+    void HandleExpired(TObjectKey<AActor> TargetKey, EStatusEffectType Status);
+    void RemoveAt(int32 Index);
+
+    // Sends the damage every status has dealt since it was last charged, up to Now or its expiry
+    void ApplyDamageOverTime(double Now);
+
+    // Charges a single status that is about to end
+    void ChargeFinal(int32 Index, double Now);
+
+    void SendDamage(UGrimoireDamageSubsystem* DamageSubsystem, int32 Index, float Damage);
+
+    // Packed, parallel arrays. Removal swaps the last status into the hole.
+    TArray<TObjectKey<AActor>> Targets;
+    TArray<EStatusEffectType> Statuses;
+    TArray<TWeakObjectPtr<AActor>> Instigators;
+    TArray<float> DamagePerSecond;
+    TArray<double> ExpiresAt;
+    TArray<double> LastCharged;
+    TArray<FGrimoireScheduleHandle> ExpiryHandles;
+
+    TMap<FStatusKey, int32> StatusIndex;
+    TMap<TObjectKey<AActor>, uint8> StatusMasks;
+
+    // Scratch: seconds to charge each status, multiplied in place by its damage per second
+    TArray<float> DamageThisTick;
+
+    // Only paces the passes; what each status is charged comes from LastCharged
+    float TimeSinceDamage = 0.0f;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GrimoireVFXSubsystem.generated.h"
+
+class UNiagaraSystem;
+
+/** Which cosmetic effects survive when a frame asks for more than its budget */
+UENUM(BlueprintType)
+enum class EGrimoireVFXPriority : uint8
+{
+    Low,
+    Normal,
+    High
+};
+
+/**
+ * Queue every cosmetic spell effect goes through instead of spawning it inline.
+ * Requests for the same system within the same merge cell of a frame become one
+ * spawn at their average location. Each tick spawns at most the per-frame budget,
+ * highest priority first, and drops the rest, since a late cosmetic is worse than none.
+ * The subsystem is never created on dedicated servers or without rendering, so
+ * callers that find no subsystem simply skip the effect.
+ */
+UCLASS()
+class GRIMOIREPLUGIN_API UGrimoireVFXSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Queues System to spawn at Location this frame, merged with matching requests nearby */
+    UFUNCTION(BlueprintCallable, Category = "Grimoire")
+    void RequestEffect(UNiagaraSystem* System, const FVector& Location, EGrimoireVFXPriority Priority = EGrimoireVFXPriority::Normal);
+
+    /** Effect for elemental reactions that leave a sustained effect, loaded with the subsystem */
+    UNiagaraSystem* GetElementalCollisionEffect() const { return ElementalCollisionEffect; }
+
+    UFUNCTION(BlueprintPure, Category = "Grimoire")
+    int32 GetNumPendingEffects() const { return Pending.Num(); }
+
+private:
+    struct FVFXRequest
+    {
+        TWeakObjectPtr<UNiagaraSystem> System;
+        FVector LocationSum = FVector::ZeroVector;
+        int32 Count = 0;
+        EGrimoireVFXPriority Priority = EGrimoireVFXPriority::Low;
+    };
+
+    // In request order, so equal priorities spawn first come first served
+    TArray<FVFXRequest> Pending;
+    TMap<TTuple<FObjectKey, FIntVector>, int32> PendingIndex;
+
+    UPROPERTY()
+    UNiagaraSystem* ElementalCollisionEffect = nullptr;
+};